@@ -88,14 +88,14 @@ namespace mousetrap
             /// @param image
             void set_image(const Image& image);
 
-            /// @brief concurrently read the data in the clipboard. Once reading is done, <tt>on_string_read</tt>> will be called with the returned image
+            /// @brief concurrently read the data in the clipboard. The image is converted on a background thread, once it is ready, <tt>on_image_read</tt> will be called on the main thread with the returned image
             /// @param on_image_read lamdba with signature <tt>(Clipboard*, const Image&, Data_t) -> void</tt>
             /// @param data arbitrary data
             /// @return true if data can be serialized into an image, false otherwise
             template<typename Function_t, typename Data_t>
             bool get_image(Function_t on_image_read, Data_t data);
 
-            /// @brief concurrently read the data in the clipboard. Once reading is done, <tt>on_string_read</tt>> will be called with the returned image
+            /// @brief concurrently read the data in the clipboard. The image is converted on a background thread, once it is ready, <tt>on_image_read</tt> will be called on the main thread with the returned image
             /// @param on_image_read lamdba with signature <tt>(Clipboard*, const Image&) -> void</tt>
             /// @return true if data can be serialized into an image, false otherwise
             template<typename Function_t>
@@ -7,6 +7,7 @@
 
 #include <glm/glm.hpp>
 #include <string>
+#include <vector>
 
 namespace mousetrap
 {
@@ -130,6 +131,28 @@ namespace mousetrap
     /// @return RGBA
     RGBA hsva_to_rgba(HSVA);
 
+    /// @brief convert a buffer of colors from RGBA to HSVA, large buffers are converted in parallel
+    /// @param in pointer to first color
+    /// @param out pointer to first element of a buffer of at least n colors
+    /// @param n number of colors
+    void rgba_to_hsva(const RGBA* in, HSVA* out, uint64_t n);
+
+    /// @brief convert a buffer of colors from RGBA to HSVA, large buffers are converted in parallel
+    /// @param in colors
+    /// @return converted colors
+    std::vector<HSVA> rgba_to_hsva(const std::vector<RGBA>& in);
+
+    /// @brief convert a buffer of colors from HSVA to RGBA, large buffers are converted in parallel. Hue is expected to be in [0, 1]
+    /// @param in pointer to first color
+    /// @param out pointer to first element of a buffer of at least n colors
+    /// @param n number of colors
+    void hsva_to_rgba(const HSVA* in, RGBA* out, uint64_t n);
+
+    /// @brief convert a buffer of colors from HSVA to RGBA, large buffers are converted in parallel. Hue is expected to be in [0, 1]
+    /// @param in colors
+    /// @return converted colors
+    std::vector<RGBA> hsva_to_rgba(const std::vector<HSVA>& in);
+
     /// @brief construct a color form an HTML code of the form #RRGGBB(AA) where AA is optimal, all components in hexadecimal
     /// @param code as string
     /// @return color
@@ -156,6 +179,20 @@ namespace mousetrap
     /// @param n_values_per_component denominator of the fraction
     HSVA quantize(HSVA in, uint64_t n_values_per_component);
 
+    /// @brief round all components of a buffer of colors to the nearest fraction, large buffers are processed in parallel
+    /// @param in pointer to first color
+    /// @param out pointer to first element of a buffer of at least n colors, may be equal to in
+    /// @param n number of colors
+    /// @param n_values_per_component denominator of the fraction
+    void quantize(const RGBA* in, RGBA* out, uint64_t n, uint64_t n_values_per_component);
+
+    /// @brief round all components of a buffer of colors to the nearest fraction, large buffers are processed in parallel
+    /// @param in pointer to first color
+    /// @param out pointer to first element of a buffer of at least n colors, may be equal to in
+    /// @param n number of colors
+    /// @param n_values_per_component denominator of the fraction
+    void quantize(const HSVA* in, HSVA* out, uint64_t n, uint64_t n_values_per_component);
+
     /// @brief invert a color, non-mutating
     /// @param in color in rgba
     /// @return color
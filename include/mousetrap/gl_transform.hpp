@@ -55,6 +55,26 @@ namespace mousetrap
             /// @brief transform data
             glm::mat4x4 transform;
     };
+
+    namespace detail
+    {
+        /// @brief apply transform to a strided array of 3d positions, uses SSE / AVX if available \for_internal_use_only
+        /// @param transform matrix, column-major
+        /// @param in pointer to the first float of the first position
+        /// @param in_stride distance between two positions in `in`, in bytes
+        /// @param out pointer to the first float of the first output position, may be equal to `in`
+        /// @param out_stride distance between two positions in `out`, in bytes
+        /// @param mirror optional second output the result is also written to, may be nullptr
+        /// @param mirror_stride distance between two positions in `mirror`, in bytes
+        /// @param n number of positions
+        void apply_transform_to_positions(
+            const glm::mat4x4& transform,
+            const float* in, uint64_t in_stride,
+            float* out, uint64_t out_stride,
+            float* mirror, uint64_t mirror_stride,
+            uint64_t n
+        );
+    }
 }
 
 #endif // MOUSETRAP_ENABLE_OPENGL_COMPONENT
\ No newline at end of file
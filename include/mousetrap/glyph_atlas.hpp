@@ -0,0 +1,116 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/18/26
+//
+
+#pragma once
+
+#include <mousetrap/gl_common.hpp>
+#if MOUSETRAP_ENABLE_OPENGL_COMPONENT
+
+#include <mousetrap/texture.hpp>
+#include <mousetrap/signal_emitter.hpp>
+
+#include <map>
+#include <set>
+#include <vector>
+#include <string>
+
+namespace mousetrap
+{
+    #ifndef DOXYGEN
+    class GlyphAtlas;
+    namespace detail
+    {
+        /// @brief location of a rasterized glyph in the atlas, in pixels
+        struct GlyphInfo
+        {
+            Vector2i atlas_position;
+            Vector2i size;
+
+            /// @brief offset of the top left of the bitmap relative to the glyph origin on the baseline, y pointing down
+            Vector2i bearing;
+        };
+
+        /// @brief textured quad of a single glyph, in pixels relative to the top left of the laid out text
+        struct GlyphQuad
+        {
+            Vector2f top_left;
+            Vector2f size;
+            Vector2f texture_top_left;
+            Vector2f texture_size;
+        };
+
+        struct _GlyphAtlasInternal
+        {
+            GObject parent;
+
+            PangoContext* context;
+            PangoFontDescription* font;
+            std::set<PangoFont*>* fonts;
+
+            std::map<std::pair<PangoFont*, PangoGlyph>, GlyphInfo>* glyphs;
+
+            Texture* texture;
+            Vector2i size;
+
+            // shelf packing state, glyphs are placed left to right in rows of varying height
+            int shelf_x = 0;
+            int shelf_y = 0;
+            int shelf_height = 0;
+            bool is_full = false;
+        };
+        using GlyphAtlasInternal = _GlyphAtlasInternal;
+        DEFINE_INTERNAL_MAPPING(GlyphAtlas);
+
+        /// @brief lay out text, rasterizing all glyphs not yet present in the atlas
+        /// @param out quads of all visible glyphs, cleared before use
+        void glyph_atlas_layout(GlyphAtlasInternal*, const std::string& text, std::vector<GlyphQuad>& out);
+    }
+    #endif
+
+    /// @brief texture holding rasterized glyphs of one font, shared by any number of mousetrap::TextShape. Each glyph is rasterized exactly once, on first use
+    class GlyphAtlas : public SignalEmitter
+    {
+        public:
+            /// @brief construct
+            /// @param font_description pango font description, for example <tt>"Sans 12"</tt> or <tt>"Monospace Bold 9"</tt>
+            /// @param atlas_size width and height of the atlas texture, in pixels. Glyphs that do not fit are not rendered
+            GlyphAtlas(const std::string& font_description = "Sans 12", Vector2i atlas_size = {1024, 1024});
+
+            /// @brief construct from internal, \for_internal_use_only
+            GlyphAtlas(detail::GlyphAtlasInternal*);
+
+            /// @brief destructor
+            ~GlyphAtlas();
+
+            /// @brief copy ctor deleted
+            GlyphAtlas(const GlyphAtlas&) = delete;
+
+            /// @brief copy assignment deleted
+            GlyphAtlas& operator=(const GlyphAtlas&) = delete;
+
+            /// @brief get atlas texture, glyphs are white with coverage as alpha
+            /// @return texture
+            const Texture& get_texture() const;
+
+            /// @brief get number of glyphs rasterized so far
+            /// @return number of glyphs
+            uint64_t get_n_glyphs() const;
+
+            /// @brief measure text without creating any geometry
+            /// @param text utf8 text
+            /// @return width and height of the laid out text, in pixels
+            Vector2f get_text_size(const std::string& text) const;
+
+            /// @brief expose internal
+            NativeObject get_internal() const override;
+
+            /// @brief expose as GObject
+            operator NativeObject() const override;
+
+        private:
+            detail::GlyphAtlasInternal* _internal = nullptr;
+    };
+}
+
+#endif // MOUSETRAP_ENABLE_OPENGL_COMPONENT
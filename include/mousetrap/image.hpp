@@ -11,6 +11,7 @@
 #include <mousetrap/texture_scale_mode.hpp>
 
 #include <vector>
+#include <functional>
 
 namespace mousetrap
 {
@@ -28,9 +29,131 @@ namespace mousetrap
         BILINEAR = GDK_INTERP_BILINEAR,
 
         /// @brief hyperbolic interpolation, slowest
-        HYPERBOLIC = GDK_INTERP_HYPER
+        HYPERBOLIC = GDK_INTERP_HYPER,
+
+        /// @brief box filter, averages all pixels covered by an output pixel. Downscaling by an integer factor uses integer arithmetic only
+        BOX = GDK_INTERP_HYPER + 1,
+
+        /// @brief separable bicubic filter, multi-threaded
+        BICUBIC = GDK_INTERP_HYPER + 2,
+
+        /// @brief separable Lanczos filter with a radius of 3 pixels, multi-threaded. Sharpest, recommended for thumbnails
+        LANCZOS = GDK_INTERP_HYPER + 3
+    };
+
+    /// @brief storage format of a mousetrap::Image, also used for tightly packed pixel data handed to or returned from it
+    enum class ImageFormat
+    {
+        /// @brief 4 channels of 8-bit unsigned integers, in [0, 255]. Images of this format are stored as a GdkPixbuf, which may have only 3 channels if it was loaded from a file without alpha
+        RGBA8,
+
+        /// @brief 4 channels of 32-bit floats, not clamped
+        RGBA32F,
+
+        /// @brief 1 channel of 8-bit unsigned integers, in [0, 255]. Read as RGBA(v, v, v, 1), written from the red component
+        R8,
+
+        /// @brief 1 channel of 32-bit floats, not clamped. Read as RGBA(v, v, v, 1), written from the red component
+        R32F
+    };
+
+    /// @brief file format used when encoding an image, see mousetrap::Image::save_to_file and mousetrap::Image::encode_to_bytes
+    enum class ImageFileFormat
+    {
+        /// @brief lossless, supports alpha
+        PNG,
+
+        /// @brief lossy, alpha is dropped
+        JPEG,
+
+        /// @brief lossy, supports alpha. Only available if the WebP GdkPixbuf loader is installed, see mousetrap::Image::is_file_format_supported
+        WEBP,
+
+        /// @brief uncompressed pixels in the format of the image, optionally with mipmaps. Files are memory-mapped when loaded, such that they open without decoding. Always available, but only readable by mousetrap
+        RAW
+    };
+
+    /// @brief encoder settings, each only applies to the formats named in its description
+    struct ImageEncodeOptions
+    {
+        /// @brief PNG zlib compression level in [0, 9], 0 is fastest and produces the largest files
+        uint64_t png_compression_level = 6;
+
+        /// @brief JPEG and WebP quality in [0, 100]
+        uint64_t quality = 90;
+
+        /// @brief RAW only, if true, all levels of detail down to 1x1 are stored, which mousetrap::Texture::create_from_file uploads as mipmaps
+        bool generate_mipmaps = false;
+    };
+
+    /// @brief non-owning view of one row of pixels, valid until the image is modified or destroyed
+    template<typename Value_t>
+    struct ImageRowSpan
+    {
+        /// @brief pointer to first channel of first pixel
+        Value_t* data = nullptr;
+
+        /// @brief number of pixels in the row
+        uint64_t n_pixels = 0;
+
+        /// @brief number of channels per pixel, 3 for RGB, 4 for RGBA
+        uint64_t n_channels = 0;
+
+        /// @brief get number of values in the row
+        /// @return n_pixels * n_channels
+        uint64_t size() const { return n_pixels * n_channels; }
+
+        /// @brief pointer to first value
+        Value_t* begin() const { return data; }
+
+        /// @brief pointer past the last value
+        Value_t* end() const { return data + size(); }
     };
 
+    #ifndef DOXYGEN
+    class Image;
+    namespace detail
+    {
+        /// @brief construct an image that takes a reference to pixbuf instead of copying it \for_internal_use_only
+        /// @param pixbuf 8-bit RGB or RGBA pixbuf, not modified elsewhere afterwards
+        Image image_new_from_pixbuf(GdkPixbuf* pixbuf);
+
+        /// @brief convert 8-bit values to floats in [0, 1]
+        void convert_u8_to_f32(const uint8_t* in, float* out, uint64_t n_values);
+
+        /// @brief convert floats to 8-bit values, clamped to [0, 1] and rounded to nearest
+        void convert_f32_to_u8(const float* in, uint8_t* out, uint64_t n_values);
+
+        /// @brief convert one row of 8-bit RGB or RGBA pixels to RGBA floats, alpha is set to 1 for RGB
+        void convert_row_to_rgba32f(const uint8_t* in, uint64_t n_channels, float* out, uint64_t n_pixels);
+
+        /// @brief convert one row of RGBA floats to 8-bit RGB or RGBA pixels, alpha is dropped for RGB
+        void convert_row_from_rgba32f(const float* in, uint8_t* out, uint64_t n_channels, uint64_t n_pixels);
+
+        /// @brief convert one row of cairo ARGB32 pixels, which have premultiplied alpha, to 8-bit RGBA with straight alpha. in and out may be the same buffer
+        void convert_row_from_argb32_premultiplied(const uint8_t* in, uint8_t* out, uint64_t n_pixels);
+
+        /// @brief get number of channels of a format
+        uint64_t image_format_get_n_channels(ImageFormat);
+
+        /// @brief get size of one channel of a format, in bytes
+        uint64_t image_format_get_value_size(ImageFormat);
+
+        /// @brief convert one row of pixels in any format to RGBA floats, n_channels may be 3 for RGBA8
+        void convert_row_to_rgba32f(const uint8_t* in, ImageFormat format, uint64_t n_channels, float* out, uint64_t n_pixels);
+
+        /// @brief convert one row of RGBA floats to pixels in any format, n_channels may be 3 for RGBA8
+        void convert_row_from_rgba32f(const float* in, ImageFormat format, uint64_t n_channels, uint8_t* out, uint64_t n_pixels);
+
+        /// @brief invoke f(y) for all rows of an image, distributed across the thread pool
+        void image_parallel_for_rows(uint64_t n_rows, uint64_t row_size, const std::function<void(uint64_t, uint64_t)>& f);
+
+        /// @brief wrap the pixels of a pixbuf as bytes without copying them, the bytes hold a reference to the pixbuf. Unlike gdk_pixbuf_read_pixel_bytes, which copies pixbufs allocated by gdk_pixbuf_new
+        /// @return new reference that has to be unref'd by the caller
+        GBytes* pixbuf_get_pixel_bytes(GdkPixbuf*);
+    }
+    #endif
+
     /// @brief a 2d buffer container RGBA pixels
     class Image
     {
@@ -69,7 +192,7 @@ namespace mousetrap
             /// @return self after assignment
             Image& operator=(Image&& other) noexcept;
 
-            /// @brief expose as GdkPixbuf, for interal use only
+            /// @brief expose as GdkPixbuf, for interal use only. nullptr for all formats except mousetrap::ImageFormat::RGBA8
             operator GdkPixbuf*() const;
 
             /// @brief create image of given size and identical color
@@ -78,7 +201,17 @@ namespace mousetrap
             /// @param default_color color of all pixels after initialization
             void create(uint64_t width, uint64_t height, RGBA default_color = RGBA(0, 0, 0, 1));
 
-            /// @brief create an image by reading a file
+            /// @brief create image of given size and storage format, all values are initialized to 0
+            /// @param width new x-dimension
+            /// @param height new y-dimension
+            /// @param format storage format. Formats other than mousetrap::ImageFormat::RGBA8 are kept in a tightly packed buffer, such that, for example, a float field can be uploaded into a mousetrap::Texture of the matching format without conversion
+            void create(uint64_t width, uint64_t height, ImageFormat format);
+
+            /// @brief get storage format
+            /// @return format, mousetrap::ImageFormat::RGBA8 unless the image was created with a different format
+            ImageFormat get_format() const;
+
+            /// @brief create an image by reading a file, the file is only decoded if it is not in mousetrap::image_cache. Files written as mousetrap::ImageFileFormat::RAW are memory-mapped and keep their format
             /// @param path
             /// @return true if successfull, false otherwise
             bool create_from_file(const std::string& path);
@@ -88,15 +221,106 @@ namespace mousetrap
             /// @return true if successfull, false otherwise
             bool save_to_file(const std::string& path) const;
 
+            /// @brief save to file in a specific format, blocks until the file was written
+            /// @param path
+            /// @param format file format, independent of the file extension
+            /// @param options encoder settings
+            /// @return true if successfull, false otherwise
+            bool save_to_file(const std::string& path, ImageFileFormat format, const ImageEncodeOptions& options = ImageEncodeOptions()) const;
+
+            /// @brief save to file without blocking. The pixels are copied, then encoded and written on a worker thread, such that the image may be modified or destroyed right after this call. Multiple calls encode concurrently
+            /// @param path
+            /// @param format file format, independent of the file extension
+            /// @param options encoder settings
+            /// @param on_done function with signature <tt>(bool success, Data_t) -> void</tt>, invoked on the main thread once the file was written
+            /// @param data arbitrary data
+            /// @note the number of pending saves is bounded to twice the number of hardware threads, if it is reached this function blocks until the oldest save finished, such that a batch export cannot exhaust memory
+            template<typename Function_t, typename Data_t>
+            void save_to_file_async(const std::string& path, ImageFileFormat format, const ImageEncodeOptions& options, Function_t on_done, Data_t data) const;
+
+            /// @brief save to file without blocking. The pixels are copied, then encoded and written on a worker thread, such that the image may be modified or destroyed right after this call. Multiple calls encode concurrently
+            /// @param path
+            /// @param format file format, independent of the file extension
+            /// @param options encoder settings
+            /// @param on_done function with signature <tt>(bool success) -> void</tt>, invoked on the main thread once the file was written
+            /// @note the number of pending saves is bounded to twice the number of hardware threads, if it is reached this function blocks until the oldest save finished, such that a batch export cannot exhaust memory
+            template<typename Function_t>
+            void save_to_file_async(const std::string& path, ImageFileFormat format, const ImageEncodeOptions& options, Function_t on_done) const;
+
+            /// @brief encode into memory instead of a file, for example to stream the image without creating a temporary file
+            /// @param format file format
+            /// @param out buffer the encoded file is written into, its previous content is replaced
+            /// @param options encoder settings
+            /// @return true if successfull, false otherwise
+            bool encode_to_bytes(ImageFileFormat format, std::vector<uint8_t>& out, const ImageEncodeOptions& options = ImageEncodeOptions()) const;
+
+            /// @brief get whether a format can be written, this depends on the GdkPixbuf loaders installed
+            /// @param format
+            /// @return true if the format can be written, PNG and JPEG are always available
+            static bool is_file_format_supported(ImageFileFormat format);
+
             /// @brief expose pixel data, linear array of RGBA values. For internal use only
             /// @return void pointer to data
             /// \not_available_in_julia_binding
             void* data() const;
 
-            /// @brief get length of linear data
+            /// @brief get length of linear data, in bytes, including padding at the end of each row
             /// @return n
             uint64_t get_data_size() const;
 
+            /// @brief get number of bytes between the start of two consecutive rows, this may be larger than width * n_channels
+            /// @return rowstride, in bytes
+            uint64_t get_rowstride() const;
+
+            /// @brief get number of channels per pixel
+            /// @return 4 for RGBA, 3 for RGB images, which are created when loading files without an alpha channel, 1 for single-channel formats
+            uint64_t get_n_channels() const;
+
+            /// @brief access one row of pixels
+            /// @param y row index
+            /// @return span, empty if y is out of bounds
+            ImageRowSpan<uint8_t> get_row(uint64_t y);
+
+            /// @brief access one row of pixels
+            /// @param y row index
+            /// @return span, empty if y is out of bounds
+            ImageRowSpan<const uint8_t> get_row(uint64_t y) const;
+
+            /// @brief access one row of pixels of an image of format mousetrap::ImageFormat::RGBA32F or mousetrap::ImageFormat::R32F
+            /// @param y row index
+            /// @return span, empty if y is out of bounds or the image is not stored as floats
+            ImageRowSpan<float> get_row_f32(uint64_t y);
+
+            /// @brief access one row of pixels of an image of format mousetrap::ImageFormat::RGBA32F or mousetrap::ImageFormat::R32F
+            /// @param y row index
+            /// @return span, empty if y is out of bounds or the image is not stored as floats
+            ImageRowSpan<const float> get_row_f32(uint64_t y) const;
+
+            /// @brief set all pixels to the same color
+            /// @param color
+            void fill(RGBA color);
+
+            /// @brief write all pixels into a tightly packed buffer, rows are top to bottom
+            /// @param format format of the buffer
+            /// @param destination buffer holding at least width * height * n values of the given format, where n is the number of channels of the format
+            void convert_to(ImageFormat format, void* destination) const;
+
+            /// @brief overwrite all pixels from a tightly packed buffer of the same size as the image, rows are top to bottom
+            /// @param format format of the buffer
+            /// @param source buffer holding width * height * n values of the given format, where n is the number of channels of the format
+            void convert_from(ImageFormat format, const void* source);
+
+            /// @brief invoke a function on every pixel, rows are distributed across multiple threads. Pixels are converted to floats in bulk before and written back after the function was invoked on a row
+            /// @param f function with signature <tt>(RGBA& pixel, uint64_t x, uint64_t y, Data_t) -> void</tt>, modifications to pixel are written back into the image
+            /// @param data arbitrary data
+            template<typename Function_t, typename Data_t>
+            void for_each_pixel_parallel(Function_t f, Data_t data);
+
+            /// @brief invoke a function on every pixel, rows are distributed across multiple threads. Pixels are converted to floats in bulk before and written back after the function was invoked on a row
+            /// @param f function with signature <tt>(RGBA& pixel, uint64_t x, uint64_t y) -> void</tt>, modifications to pixel are written back into the image
+            template<typename Function_t>
+            void for_each_pixel_parallel(Function_t f);
+
             /// @brief get number of pixels
             /// @return n, equal to width * height
             uint64_t get_n_pixels() const;
@@ -105,10 +329,16 @@ namespace mousetrap
             /// @return size
             Vector2ui get_size() const;
 
+            /// @brief create a copy of the image in a different storage format
+            /// @param format
+            /// @return newly allocated image
+            /// @note scaling, flipping and rotating produce an image of format mousetrap::ImageFormat::RGBA8, cropping preserves the format
+            [[nodiscard]] Image as_format(ImageFormat format) const;
+
             /// @brief create a new image, scaled according to the scale mode
             /// @param size_x new width
             /// @param size_y new height
-            /// @param interpolation_type interpolation algorithm to use
+            /// @param interpolation_type interpolation algorithm to use. mousetrap::InterpolationType::BOX, mousetrap::InterpolationType::BICUBIC and mousetrap::InterpolationType::LANCZOS are resampled by mousetrap on all threads, in premultiplied alpha, the others by GdkPixbuf
             /// @return newly allocated image
             [[nodiscard]] Image as_scaled(uint64_t size_x, uint64_t size_y, InterpolationType interpolation_type = InterpolationType::TILES) const;
 
@@ -127,6 +357,18 @@ namespace mousetrap
             /// @returns newly allocated image, same size as original image
             [[nodiscard]] Image as_flipped(bool flip_horizontally, bool flip_vertically) const;
 
+            /// @brief create a new image, rotated by 90° clockwise
+            /// @returns newly allocated image, width and height are swapped
+            [[nodiscard]] Image as_rotated_90() const;
+
+            /// @brief create a new image, rotated by 180°, equivalent to flipping along both axes
+            /// @returns newly allocated image, same size as original image
+            [[nodiscard]] Image as_rotated_180() const;
+
+            /// @brief create a new image, rotated by 270° clockwise, which is 90° counter-clockwise
+            /// @returns newly allocated image, width and height are swapped
+            [[nodiscard]] Image as_rotated_270() const;
+
             /// @brief set value of individual pixel, prints soft warning if indices out of bounds
             /// @param x row-index
             /// @param y column-index
@@ -165,10 +407,20 @@ namespace mousetrap
 
         private:
             Image(GdkPixbuf* pixbuf);
+            friend Image detail::image_new_from_pixbuf(GdkPixbuf*);
+
+            void save_to_file_async_impl(const std::string& path, ImageFileFormat format, const ImageEncodeOptions& options, std::function<void(bool)> on_done) const;
 
             Vector2i _size = {0, 0};
             GdkPixbuf* _data = nullptr;
 
+            // pixels of all formats except RGBA8, tightly packed
+            ImageFormat _format = ImageFormat::RGBA8;
+            std::vector<uint8_t> _buffer;
+
+            bool is_allocated() const;
             uint64_t to_linear_index(uint64_t, uint64_t) const;
     };
 }
+
+#include "inline/image.hpp"
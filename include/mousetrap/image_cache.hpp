@@ -0,0 +1,107 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/18/26
+//
+
+#pragma once
+
+#include <mousetrap/gtk_common.hpp>
+#include <mousetrap/gl_common.hpp>
+
+#if MOUSETRAP_ENABLE_OPENGL_COMPONENT
+#include <mousetrap/texture.hpp>
+#endif
+
+#include <string>
+#include <cstdint>
+
+namespace mousetrap
+{
+    #ifndef DOXYGEN
+    namespace detail
+    {
+        /// @brief get decoded file from the cache, decodes and inserts it on a miss \for_internal_use_only
+        /// @param path
+        /// @param error set if the file could not be decoded
+        /// @return new reference that has to be unref'd by the caller, nullptr if the file could not be decoded. The pixbuf is shared with other callers and must not be modified
+        GdkPixbuf* image_cache_get_pixbuf(const std::string& path, GError** error);
+
+        /// @brief get gdk texture of a cached file, the texture references the pixels of the cached pixbuf \for_internal_use_only
+        /// @param path
+        /// @param error set if the file could not be decoded
+        /// @return new reference that has to be unref'd by the caller, nullptr if the file could not be decoded
+        GdkTexture* image_cache_get_gdk_texture(const std::string& path, GError** error);
+    }
+    #endif
+
+    /// @brief statistics of mousetrap::image_cache
+    struct ImageCacheStatistics
+    {
+        /// @brief number of lookups that were served without decoding
+        uint64_t n_hits = 0;
+
+        /// @brief number of lookups that had to decode the file
+        uint64_t n_misses = 0;
+
+        /// @brief n_hits / (n_hits + n_misses), 0 if there were no lookups yet
+        float hit_rate = 0;
+
+        /// @brief number of entries evicted because the memory budget was exceeded
+        uint64_t n_evictions = 0;
+
+        /// @brief number of files currently cached
+        uint64_t n_entries = 0;
+
+        /// @brief number of bytes of decoded pixels currently cached
+        uint64_t memory_usage = 0;
+
+        /// @brief number of bytes of video memory used by cached textures
+        uint64_t gpu_memory_usage = 0;
+    };
+
+    /// @brief process-wide cache of decoded image files, used by mousetrap::Image::create_from_file, mousetrap::Texture::create_from_file and mousetrap::ImageDisplay::create_from_file. Entries are identified by the files path, and invalidated once the files modification time or size changed. Least recently used entries are evicted once the memory budget is exceeded
+    struct image_cache
+    {
+        /// @brief uninstantiatable singleton instance
+        image_cache() = delete;
+
+        /// @brief enable or disable the cache, disabling it clears all entries
+        /// @param b true by default
+        static void set_enabled(bool b);
+
+        /// @brief get whether the cache is enabled
+        /// @return true by default
+        static bool get_enabled();
+
+        /// @brief set maximum number of bytes of decoded pixels and texture memory kept, least recently used entries are evicted once it is exceeded. Files larger than the budget are not cached
+        /// @param n_bytes
+        static void set_memory_budget(uint64_t n_bytes);
+
+        /// @brief get maximum number of bytes kept
+        /// @return number of bytes, 256 MiB by default
+        static uint64_t get_memory_budget();
+
+        /// @brief remove a file from the cache, objects already sharing its pixels stay valid
+        /// @param path
+        static void invalidate(const std::string& path);
+
+        /// @brief remove all entries, objects already sharing their pixels stay valid
+        static void clear();
+
+        /// @brief get hit rate, memory usage and number of evictions
+        /// @return statistics since the start of the process or the last call to mousetrap::image_cache::reset_statistics
+        static ImageCacheStatistics get_statistics();
+
+        /// @brief reset number of hits, misses and evictions to 0
+        static void reset_statistics();
+
+        #if MOUSETRAP_ENABLE_OPENGL_COMPONENT
+
+        /// @brief get a texture of a file, all calls for the same file share one texture as long as it is cached. Unlike mousetrap::Texture::create_from_file, which uploads a new copy every time, this only uploads once
+        /// @param path
+        /// @return texture, has to be treated as read-only since it is shared. Of size 0x0 if the file could not be decoded
+        /// @note has to be called from the main thread
+        static Texture get_texture(const std::string& path);
+
+        #endif
+    };
+}
@@ -66,15 +66,19 @@ namespace mousetrap
             /// @return resolution
             Vector2ui get_size() const;
 
-            /// @brief load from image on disk
+            /// @brief load from image on disk, displays of the same file share the decoded pixels through mousetrap::image_cache
             /// @param path
             /// @return true if succesfull, false otherwise
             bool create_from_file(const std::string& path);
 
-            /// @brief load from image
+            /// @brief load from image. The displayed texture shares the images pixel buffer instead of copying it, so the image should not be modified while it is displayed, use mousetrap::ImageDisplay::update for images that change
             /// @param image
             void create_from_image(const Image& image);
 
+            /// @brief display a new frame, for example of a live preview. The pixels are copied into a buffer taken from a small per-widget pool, which is returned to the pool once the frame was replaced and gtk released its texture, such that updating at a steady rate does not allocate pixel memory
+            /// @param frame image, may be modified or destroyed after this call
+            void update(const Image& frame);
+
             /// @brief load from icon
             /// @param icon
             void create_from_icon(const Icon& icon);
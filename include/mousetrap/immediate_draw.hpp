@@ -0,0 +1,132 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/18/26
+//
+
+#pragma once
+
+#include <mousetrap/gl_common.hpp>
+#if MOUSETRAP_ENABLE_OPENGL_COMPONENT
+
+#include <mousetrap/shape.hpp>
+#include <mousetrap/shader.hpp>
+#include <mousetrap/color.hpp>
+#include <mousetrap/signal_emitter.hpp>
+
+#include <vector>
+
+namespace mousetrap
+{
+    #ifndef DOXYGEN
+    class ImmediateDraw;
+    namespace detail
+    {
+        /// @brief vertex buffer split into a ring of regions, each region is written by the cpu once per frame. Regions are guarded by fences so vertices the gpu is still reading are never overwritten
+        struct StreamingVertexBuffer
+        {
+            static constexpr uint64_t n_regions = 3;
+
+            GLNativeHandle vertex_array_id = 0;
+            GLNativeHandle buffer_id = 0;
+
+            uint64_t region_size = 0;
+            uint64_t current_region = 0;
+            uint64_t n_written = 0;
+
+            VertexInfo* mapped = nullptr;
+            GLsync fences[n_regions] = {nullptr, nullptr, nullptr};
+        };
+
+        /// @brief allocate buffer, persistently mapped if GL_ARB_buffer_storage is available
+        /// @param region_size number of vertices per region
+        StreamingVertexBuffer* streaming_vertex_buffer_new(uint64_t region_size);
+
+        /// @brief free buffer and all fences
+        void streaming_vertex_buffer_free(StreamingVertexBuffer*);
+
+        /// @brief advance to the next region the gpu is done reading from, skipping regions that are still in use. If every region is in use after a wait of at most 1ms, the storage is replaced. Grows the buffer if n_vertices do not fit into one region
+        void streaming_vertex_buffer_begin_frame(StreamingVertexBuffer*, uint64_t n_vertices);
+
+        /// @brief append vertices to the current region
+        /// @return index of the first written vertex, for use with glDrawArrays
+        uint64_t streaming_vertex_buffer_write(StreamingVertexBuffer*, const VertexInfo* data, uint64_t n_vertices);
+
+        /// @brief insert a fence for the current region after all draw calls reading from it were issued
+        void streaming_vertex_buffer_end_frame(StreamingVertexBuffer*);
+
+        struct _ImmediateDrawInternal
+        {
+            GObject parent;
+
+            std::vector<VertexInfo>* triangles;
+            std::vector<VertexInfo>* lines;
+            std::vector<VertexInfo>* points;
+
+            // nullptr until the first flush with queued primitives
+            StreamingVertexBuffer* buffer;
+            Shader* shader;
+        };
+        using ImmediateDrawInternal = _ImmediateDrawInternal;
+        DEFINE_INTERNAL_MAPPING(ImmediateDraw);
+
+        /// @brief allocate internal, \for_internal_use_only
+        ImmediateDrawInternal* immediate_draw_internal_new();
+
+        /// @brief stream all queued primitives into the vertex buffer ring, render them to the currently bound framebuffer, then clear the queue
+        void immediate_draw_flush(ImmediateDrawInternal*);
+    }
+    #endif
+
+    /// @brief transient geometry for the next frame of a mousetrap::RenderArea, useful for debug overlays, cursors or selection rectangles. Primitives are rendered once after all render tasks, then discarded. No OpenGL objects are created, all vertices are streamed into a buffer owned by the render area
+    class ImmediateDraw : public SignalEmitter
+    {
+        public:
+            /// @brief construct from internal, \for_internal_use_only. Use mousetrap::RenderArea::get_immediate_draw to obtain an instance
+            /// @param internal
+            ImmediateDraw(detail::ImmediateDrawInternal*);
+
+            /// @brief destructor
+            ~ImmediateDraw();
+
+            /// @brief add filled triangle
+            /// @param a point in gl coordinates
+            /// @param b point in gl coordinates
+            /// @param c point in gl coordinates
+            /// @param color
+            void add_triangle(Vector2f a, Vector2f b, Vector2f c, RGBA color);
+
+            /// @brief add filled rectangle
+            /// @param top_left point in gl coordinates
+            /// @param size width and height in gl coordinates
+            /// @param color
+            void add_rectangle(Vector2f top_left, Vector2f size, RGBA color);
+
+            /// @brief add line, has a width of exactly 1 fragment
+            /// @param a point in gl coordinates
+            /// @param b point in gl coordinates
+            /// @param color
+            void add_line(Vector2f a, Vector2f b, RGBA color);
+
+            /// @brief add point, rendered as exactly 1 fragment
+            /// @param position point in gl coordinates
+            /// @param color
+            void add_point(Vector2f position, RGBA color);
+
+            /// @brief discard all primitives queued for the next frame
+            void clear();
+
+            /// @brief get number of vertices queued for the next frame
+            /// @return number of vertices
+            uint64_t get_n_vertices() const;
+
+            /// @brief expose internal
+            NativeObject get_internal() const override;
+
+            /// @brief expose as GObject
+            operator NativeObject() const override;
+
+        private:
+            detail::ImmediateDrawInternal* _internal = nullptr;
+    };
+}
+
+#endif // MOUSETRAP_ENABLE_OPENGL_COMPONENT
@@ -0,0 +1,57 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/18/26
+//
+
+namespace mousetrap
+{
+    template<typename Function_t>
+    void Image::for_each_pixel_parallel(Function_t f)
+    {
+        if (not is_allocated())
+            return;
+
+        auto* pixels = static_cast<uint8_t*>(data());
+        const uint64_t width = _size.x;
+        const uint64_t rowstride = get_rowstride();
+        const uint64_t n_channels = get_n_channels();
+
+        detail::image_parallel_for_rows(_size.y, get_rowstride(), [&](uint64_t y, uint64_t){
+            // RGBA is 4 consecutive floats, so a row can be converted into it in bulk
+            static_assert(sizeof(RGBA) == 4 * sizeof(float));
+            thread_local std::vector<RGBA> row;
+            row.resize(width);
+
+            uint8_t* row_data = pixels + y * rowstride;
+            detail::convert_row_to_rgba32f(row_data, _format, n_channels, reinterpret_cast<float*>(row.data()), width);
+
+            for (uint64_t x = 0; x < width; ++x)
+                f(row[x], x, y);
+
+            detail::convert_row_from_rgba32f(reinterpret_cast<const float*>(row.data()), _format, n_channels, row_data, width);
+        });
+    }
+
+    template<typename Function_t, typename Data_t>
+    void Image::for_each_pixel_parallel(Function_t f, Data_t data)
+    {
+        for_each_pixel_parallel([&](RGBA& pixel, uint64_t x, uint64_t y){
+            f(pixel, x, y, data);
+        });
+    }
+
+    template<typename Function_t, typename Data_t>
+    void Image::save_to_file_async(const std::string& path, ImageFileFormat format, const ImageEncodeOptions& options, Function_t f_in, Data_t data_in) const
+    {
+        save_to_file_async_impl(path, format, options, [f = f_in, data = data_in](bool success){
+            f(success, data);
+        });
+    }
+
+    template<typename Function_t>
+    void Image::save_to_file_async(const std::string& path, ImageFileFormat format, const ImageEncodeOptions& options, Function_t f_in) const
+    {
+        save_to_file_async_impl(path, format, options, [f = f_in](bool success){
+            f(success);
+        });
+    }
+}
@@ -0,0 +1,38 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/18/26
+//
+
+namespace mousetrap
+{
+    template<typename Function_t, typename Data_t>
+    void RenderArea::set_render_preparation(uint64_t n_jobs, Function_t f_in, Data_t data_in)
+    {
+        set_render_preparation_impl(n_jobs, [f = f_in, data = data_in](RenderCommandList& list, uint64_t job_index){
+            f(list, job_index, data);
+        });
+    }
+
+    template<typename Function_t>
+    void RenderArea::set_render_preparation(uint64_t n_jobs, Function_t f_in)
+    {
+        set_render_preparation_impl(n_jobs, [f = f_in](RenderCommandList& list, uint64_t job_index){
+            f(list, job_index);
+        });
+    }
+
+    template<typename Function_t, typename Data_t>
+    void RenderArea::set_adaptive_quality_callback(uint64_t n_levels, Function_t f_in, Data_t data_in)
+    {
+        set_adaptive_quality_callback_impl(n_levels, [f = f_in, data = data_in](uint64_t quality_level){
+            f(quality_level, data);
+        });
+    }
+
+    template<typename Function_t>
+    void RenderArea::set_adaptive_quality_callback(uint64_t n_levels, Function_t f_in)
+    {
+        set_adaptive_quality_callback_impl(n_levels, [f = f_in](uint64_t quality_level){
+            f(quality_level);
+        });
+    }
+}
@@ -0,0 +1,22 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/18/26
+//
+
+namespace mousetrap
+{
+    template<typename Function_t, typename Data_t>
+    uint64_t RenderGraph::add_pass(const std::string& name, const std::vector<ResourceID>& inputs, ResourceID output, Function_t f_in, Data_t data_in)
+    {
+        return add_pass_impl(name, inputs, output, [f = f_in, data = data_in](const RenderGraphPassContext& context){
+            f(context, data);
+        });
+    }
+
+    template<typename Function_t>
+    uint64_t RenderGraph::add_pass(const std::string& name, const std::vector<ResourceID>& inputs, ResourceID output, Function_t f_in)
+    {
+        return add_pass_impl(name, inputs, output, [f = f_in](const RenderGraphPassContext& context){
+            f(context);
+        });
+    }
+}
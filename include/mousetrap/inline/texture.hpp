@@ -0,0 +1,22 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/18/26
+//
+
+namespace mousetrap
+{
+    template<typename Function_t, typename Data_t>
+    void Texture::create_from_file_async(const std::string& path, Function_t f_in, Data_t data_in)
+    {
+        create_from_file_async_impl(path, [f = f_in, data = data_in](Texture& texture, bool success){
+            f(texture, success, data);
+        });
+    }
+
+    template<typename Function_t>
+    void Texture::create_from_file_async(const std::string& path, Function_t f_in)
+    {
+        create_from_file_async_impl(path, [f = f_in](Texture& texture, bool success){
+            f(texture, success);
+        });
+    }
+}
@@ -0,0 +1,22 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/18/26
+//
+
+namespace mousetrap
+{
+    template<typename Function_t, typename Data_t>
+    void TiledImage::create(uint64_t width, uint64_t height, Function_t f_in, Data_t data_in)
+    {
+        create_impl(width, height, [f = f_in, data = data_in](uint64_t level, uint64_t x, uint64_t y, Image& out) -> bool {
+            return f(level, x, y, out, data);
+        });
+    }
+
+    template<typename Function_t>
+    void TiledImage::create(uint64_t width, uint64_t height, Function_t f_in)
+    {
+        create_impl(width, height, [f = f_in](uint64_t level, uint64_t x, uint64_t y, Image& out) -> bool {
+            return f(level, x, y, out);
+        });
+    }
+}
@@ -29,6 +29,7 @@ namespace mousetrap
 
             GLNativeHandle buffer = 0;
             GLNativeHandle msaa_color_buffer_texture = 0;
+            GLNativeHandle msaa_depth_buffer = 0;
             GLNativeHandle intermediate_buffer = 0;
             GLNativeHandle screen_texture = 0;
         };
@@ -0,0 +1,125 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/18/26
+//
+
+#pragma once
+
+#include <mousetrap/gl_common.hpp>
+#if MOUSETRAP_ENABLE_OPENGL_COMPONENT
+
+#include <mousetrap/render_texture.hpp>
+#include <mousetrap/render_task.hpp>
+#include <mousetrap/shader.hpp>
+#include <mousetrap/shape.hpp>
+#include <mousetrap/signal_emitter.hpp>
+
+#include <vector>
+
+namespace mousetrap
+{
+    #ifndef DOXYGEN
+    class PostProcessChain;
+    namespace detail
+    {
+        struct PostProcessPass
+        {
+            RenderTaskInternal* task;
+            bool half_resolution;
+        };
+
+        struct _PostProcessChainInternal
+        {
+            GObject parent;
+
+            std::vector<PostProcessPass>* passes;
+            std::vector<Shader*>* owned_shaders;
+
+            // fullscreen quad, texture coordinates are flipped vertically because render textures are stored bottom-up
+            Shape* shape;
+
+            // ping-pong targets, full_resolution[0] also receives the scene. Allocated once the chain has a pass, reallocated only when the size changes
+            RenderTexture* full_resolution[2];
+            RenderTexture* half_resolution[2];
+            bool half_resolution_allocated;
+            Vector2i size;
+            Vector2i allocated_size;
+
+            // depth attachment of the scene target, for render areas with depth testing enabled
+            GLNativeHandle scene_depth_buffer;
+        };
+        using PostProcessChainInternal = _PostProcessChainInternal;
+        DEFINE_INTERNAL_MAPPING(PostProcessChain);
+
+        /// @brief allocate internal, \for_internal_use_only
+        PostProcessChainInternal* post_process_chain_internal_new();
+
+        /// @brief set size of the render targets, they are only reallocated if the chain has at least one pass
+        void post_process_chain_resize(PostProcessChainInternal*, Vector2i size);
+
+        /// @brief if the chain has at least one pass, bind the scene target as render target
+        /// @return true if the scene target was bound, false if the chain is empty and the scene should be rendered directly
+        bool post_process_chain_begin(PostProcessChainInternal*);
+
+        /// @brief unbind the scene target, then run all passes, the last pass renders into the framebuffer that was bound before mousetrap::detail::post_process_chain_begin
+        void post_process_chain_end(PostProcessChainInternal*);
+    }
+    #endif
+
+    /// @brief ordered list of fullscreen fragment shader passes applied to the output of a mousetrap::RenderArea. Each pass samples the previous passes output through <tt>uniform sampler2D _texture</tt>, and receives the size of one texel of its input as <tt>uniform vec2 _texel_size</tt>. Render targets are allocated once per size of the render area, and only once the first pass was added, rendering does not allocate
+    class PostProcessChain : public SignalEmitter
+    {
+        public:
+            /// @brief construct from internal, \for_internal_use_only. Use mousetrap::RenderArea::get_post_process_chain to obtain an instance
+            /// @param internal
+            PostProcessChain(detail::PostProcessChainInternal*);
+
+            /// @brief destructor
+            ~PostProcessChain();
+
+            /// @brief append a pass
+            /// @param fragment_shader shader, its fragment shader is run once per pixel of the output. The chain keeps a reference to the shader
+            /// @param half_resolution if true, the pass renders at half the width and height of the render area, which is sufficient for low-frequency effects such as blur or bloom. Ignored for the last pass, which always renders at full resolution
+            /// @return index of the pass
+            uint64_t add_pass(const Shader& fragment_shader, bool half_resolution = false);
+
+            /// @brief append two passes convolving the image with a separable, symmetric kernel, first horizontally, then vertically
+            /// @param kernel weights from the center outwards, <tt>kernel[0]</tt> is the center weight, <tt>kernel[i]</tt> is applied to both the pixel <tt>i</tt> to the left and the pixel <tt>i</tt> to the right
+            /// @param half_resolution see mousetrap::PostProcessChain::add_pass
+            /// @return index of the horizontal pass, the vertical pass is at index + 1
+            uint64_t add_separable_pass(const std::vector<float>& kernel, bool half_resolution = false);
+
+            /// @brief append a gaussian blur as two separable passes
+            /// @param sigma standard deviation, in pixels of the passes resolution
+            /// @param half_resolution see mousetrap::PostProcessChain::add_pass
+            /// @return index of the horizontal pass, the vertical pass is at index + 1
+            uint64_t add_gaussian_blur(float sigma, bool half_resolution = true);
+
+            /// @brief access the render task of a pass, used to set additional uniforms
+            /// @param index index of the pass
+            /// @return render task, refers to the same pass for all calls
+            RenderTask get_pass(uint64_t index) const;
+
+            /// @brief get number of passes
+            /// @return number of passes
+            uint64_t get_n_passes() const;
+
+            /// @brief remove all passes, the render area renders directly into its framebuffer again
+            void clear();
+
+            /// @brief generate weights of a normalized, one-sided gaussian kernel, for use with mousetrap::PostProcessChain::add_separable_pass
+            /// @param sigma standard deviation, in pixels
+            /// @return weights from the center outwards, radius is <tt>ceil(3 * sigma)</tt>
+            static std::vector<float> gaussian_kernel(float sigma);
+
+            /// @brief expose internal
+            NativeObject get_internal() const override;
+
+            /// @brief expose as GObject
+            operator NativeObject() const override;
+
+        private:
+            detail::PostProcessChainInternal* _internal = nullptr;
+    };
+}
+
+#endif // MOUSETRAP_ENABLE_OPENGL_COMPONENT
@@ -0,0 +1,65 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/18/26
+//
+
+#pragma once
+
+#include <mousetrap/gtk_common.hpp>
+#include <mousetrap/image.hpp>
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace mousetrap
+{
+    #ifndef DOXYGEN
+    namespace detail
+    {
+        /// @brief header of a file written with mousetrap::ImageFileFormat::RAW. It is followed by the pixels of each level, rows are tightly packed and each level starts at a multiple of raw_image_alignment
+        struct RawImageHeader
+        {
+            char magic[8];
+            uint32_t byte_order;
+            uint32_t version;
+            uint32_t format;
+            uint32_t n_levels;
+            uint64_t width;
+            uint64_t height;
+            uint64_t reserved[3];
+        };
+        static_assert(sizeof(RawImageHeader) == 64);
+
+        /// @brief alignment of the start of each level, in bytes
+        constexpr uint64_t raw_image_alignment = 64;
+
+        /// @brief memory-mapped file, pixels are read from the page cache without copying or decoding
+        struct RawImageFile
+        {
+            GMappedFile* mapped = nullptr;
+            const RawImageHeader* header = nullptr;
+        };
+
+        /// @brief check whether a file starts with the magic of a raw image, reading only its first 64 bytes instead of mapping it. This is the only place a file is sniffed for being a raw image, call it once per load before mousetrap::detail::raw_image_open
+        /// @return true if the file exists and starts with the magic, false otherwise
+        bool raw_image_has_magic(const std::string& path);
+
+        /// @brief map a file and validate its header, files whose width or height exceeds 2^24 are rejected
+        /// @return true if the file is a valid raw image, false otherwise, in which case nothing stays mapped
+        bool raw_image_open(const std::string& path, RawImageFile& out);
+
+        /// @brief unmap a file opened with raw_image_open
+        void raw_image_close(RawImageFile&);
+
+        /// @brief get pixels of a level
+        /// @param width set to the width of the level
+        /// @param height set to the height of the level
+        /// @return pointer into the mapped file, valid until raw_image_close
+        const uint8_t* raw_image_get_level(const RawImageFile&, uint64_t level, uint64_t& width, uint64_t& height);
+
+        /// @brief encode an image, keeping its format
+        /// @param generate_mipmaps if true, all levels down to 1x1 are computed by averaging 2x2 blocks of the previous level, for odd sizes the last row or column is folded into the last block
+        void raw_image_encode(const Image&, bool generate_mipmaps, std::vector<uint8_t>& out);
+    }
+    #endif
+}
@@ -10,6 +10,11 @@
 #include <mousetrap/widget.hpp>
 #include <mousetrap/shape.hpp>
 #include <mousetrap/render_task.hpp>
+#include <mousetrap/immediate_draw.hpp>
+#include <mousetrap/post_process_chain.hpp>
+#include <mousetrap/render_graph.hpp>
+#include <mousetrap/render_command_list.hpp>
+#include <mousetrap/time.hpp>
 
 #ifdef DOXYGEN
     #include "../../docs/doxygen.inl"
@@ -22,9 +27,20 @@ namespace mousetrap
         /// @brief global OpenGL context
         inline GdkGLContext* GL_CONTEXT = nullptr;
 
-        /// @brief initialize the global OpenGL context
+        /// @brief whether the global OpenGL context is a surfaceless EGL context instead of a GdkGLContext
+        inline bool GL_IS_HEADLESS = false;
+
+        /// @brief initialize the global OpenGL context. If no display is available, or the environment variable `MOUSETRAP_OPENGL_HEADLESS` is set to `TRUE`, a headless context is created instead
+        /// @return context, nullptr if the context is headless or initialization failed
         GdkGLContext* initialize_opengl();
 
+        /// @brief initialize the global OpenGL context as a surfaceless EGL context, which does not require a display. Rendering is only possible into a mousetrap::RenderTexture, which can be downloaded into an image
+        /// @return true if successful, false if mousetrap was built without EGL or no surfaceless context could be created
+        bool initialize_opengl_headless();
+
+        /// @brief make the global OpenGL context current on the calling thread
+        void make_opengl_context_current();
+
         /// @brief free the global OpenGL context
         void shutdown_opengl();
 
@@ -32,22 +48,92 @@ namespace mousetrap
         bool is_opengl_disabled();
     }
 
+    /// @brief per-frame statistics of a mousetrap::RenderArea, only collected while profiling is enabled, see mousetrap::RenderArea::set_render_statistics_enabled
+    struct RenderStatistics
+    {
+        /// @brief number of draw calls issued by render tasks, submitted command lists, immediate draw and msaa resolve during the last frame. Draw calls inside render graph passes are not included, see mousetrap::RenderStatistics::n_render_graph_passes
+        uint64_t n_draw_calls = 0;
+
+        /// @brief number of render graph passes run during the last frame
+        uint64_t n_render_graph_passes = 0;
+
+        /// @brief number of vertices submitted during the last frame
+        uint64_t n_vertices = 0;
+
+        /// @brief number of shader program, texture or blend mode changes between consecutive render tasks during the last frame. A task that uses the default state, no program, no texture and mousetrap::BlendMode::NORMAL, causes no change
+        uint64_t n_state_changes = 0;
+
+        /// @brief time the gpu spent rendering a recent frame, including render graph passes and submitted command lists, in milliseconds. Timer queries are read back without stalling, so this lags a few frames behind the cpu statistics
+        float gpu_time_ms = 0;
+
+        /// @brief time the cpu spent submitting the last frame, in milliseconds
+        float cpu_time_ms = 0;
+
+        /// @brief gpu time of each render task, in the order they were rendered, in milliseconds
+        std::vector<float> task_gpu_time_ms;
+
+        /// @brief cpu submission time of each render task, in the order they were rendered, in milliseconds
+        std::vector<float> task_cpu_time_ms;
+    };
+
+    /// @brief frame pacing statistics of a mousetrap::RenderArea, only collected while frame pacing is enabled, see mousetrap::RenderArea::set_frame_pacing_enabled
+    struct FramePacingStatistics
+    {
+        /// @brief time available per frame, either set via mousetrap::RenderArea::set_frame_budget or the refresh interval of the monitor
+        Time frame_budget = microseconds(0);
+
+        /// @brief moving average of the time between a render starting and the gpu finishing it
+        Time average_frame_time = microseconds(0);
+
+        /// @brief number of render requests that were merged into an already pending render because the gpu was still busy
+        uint64_t n_merged_renders = 0;
+
+        /// @brief number of display frames during which a pending render was held back because the gpu had not finished the previous frame
+        uint64_t n_skipped_frames = 0;
+
+        /// @brief current quality level, see mousetrap::RenderArea::set_adaptive_quality_callback
+        uint64_t quality_level = 0;
+    };
+
     #ifndef DOXYGEN
     class RenderArea;
     class MultisampledRenderTexture;
     namespace detail
     {
+        struct RenderProfiler;
+        struct FramePacer;
+
         struct _RenderAreaInternal
         {
             GObject parent;
             GtkGLArea* native;
             std::vector<detail::RenderTaskInternal*>* tasks;
 
+            // tasks in render order, stable-sorted by z-index, only updated when a task was added or a z-index changed
+            std::vector<detail::RenderTaskInternal*>* sorted_tasks;
+            bool sorted_tasks_dirty;
+            uint64_t sorted_tasks_generation;
+
+            bool depth_test_enabled;
+
             bool apply_msaa;
             MultisampledRenderTexture* render_texture;
             Shape* render_texture_shape;
             RenderTask* render_texture_shape_task;
             Shader* render_texture_shader;
+
+            detail::ImmediateDrawInternal* immediate_draw;
+            detail::PostProcessChainInternal* post_process_chain;
+            detail::RenderGraphInternal* render_graph;
+            detail::RenderProfiler* profiler;
+            detail::FramePacer* frame_pacer;
+            Vector2i size;
+
+            // preparation jobs run on the thread pool each frame, one command list per pool thread, submitted on the main thread
+            std::function<void(RenderCommandList&, uint64_t)>* preparation;
+            uint64_t n_preparation_jobs;
+            std::vector<RenderCommandList*>* command_lists;
+            detail::RenderCommandSubmitter* submitter;
         };
         using RenderAreaInternal = _RenderAreaInternal;
         DEFINE_INTERNAL_MAPPING(RenderArea);
@@ -114,10 +200,106 @@ namespace mousetrap
             /// @brief unregister all render tasks
             void clear_render_tasks();
 
-            /// @brief trigger the `render` function of all registered render tasks
+            /// @brief trigger the `render` function of all registered render tasks, in order of their z-index
             void render_render_tasks();
 
-            /// @brief notify the area that a re-render should be done as soon as possible
+            /// @brief enable or disable depth testing. If enabled, tasks with mousetrap::BlendMode::NONE are considered opaque and rendered front-to-back first, such that fragments hidden behind opaque tasks with a higher z-index are rejected before the fragment shader runs. All other tasks are rendered back-to-front afterwards. The resulting image is identical to the one with depth testing disabled
+            /// @param b true to enable, false to disable
+            void set_depth_test_enabled(bool b);
+
+            /// @brief get whether depth testing is enabled
+            /// @return true if enabled, false otherwise
+            bool get_depth_test_enabled() const;
+
+            /// @brief access the areas immediate mode geometry, primitives added to it are rendered once during the next frame, after all render tasks
+            /// @return immediate draw, refers to the same geometry queue for all calls
+            ImmediateDraw get_immediate_draw();
+
+            /// @brief access the areas post processing chain, passes added to it are applied to the entire area after all render tasks and immediate mode geometry were rendered
+            /// @return post process chain, refers to the same chain for all calls
+            PostProcessChain get_post_process_chain();
+
+            /// @brief access the areas render graph, its passes are run each frame after the area was cleared, before any render tasks
+            /// @return render graph, refers to the same graph for all calls
+            RenderGraph get_render_graph();
+
+            /// @brief register a function that prepares draw commands each frame. Jobs are distributed across a work-stealing thread pool and record into per-thread command lists, which are then submitted on the main thread in order of their job index, after all render tasks and before immediate mode geometry
+            /// @param n_jobs number of jobs per frame, for example one per chunk of objects that should be culled and transformed
+            /// @param f function with signature <tt>(RenderCommandList&, uint64_t job_index, Data_t) -> void</tt>, invoked concurrently from multiple threads. It may not call into OpenGL, in particular it may not create render tasks, shapes or textures
+            /// @param data arbitrary data
+            template<typename Function_t, typename Data_t>
+            void set_render_preparation(uint64_t n_jobs, Function_t f, Data_t data);
+
+            /// @brief register a function that prepares draw commands each frame. Jobs are distributed across a work-stealing thread pool and record into per-thread command lists, which are then submitted on the main thread in order of their job index, after all render tasks and before immediate mode geometry
+            /// @param n_jobs number of jobs per frame, for example one per chunk of objects that should be culled and transformed
+            /// @param f function with signature <tt>(RenderCommandList&, uint64_t job_index) -> void</tt>, invoked concurrently from multiple threads. It may not call into OpenGL, in particular it may not create render tasks, shapes or textures
+            template<typename Function_t>
+            void set_render_preparation(uint64_t n_jobs, Function_t f);
+
+            /// @brief remove the preparation function, if any
+            void clear_render_preparation();
+
+            /// @brief enable or disable collecting render statistics, this wraps each render task in an OpenGL timer query, which has a small overhead
+            /// @param b true to enable, false to disable
+            void set_render_statistics_enabled(bool b);
+
+            /// @brief get whether render statistics are being collected
+            /// @return true if enabled, false otherwise
+            bool get_render_statistics_enabled() const;
+
+            /// @brief get statistics of the most recently rendered frame
+            /// @return statistics, all zero if collecting render statistics is disabled
+            RenderStatistics get_render_statistics() const;
+
+            /// @brief enable or disable frame pacing. If enabled, a fence is inserted after each frame, and mousetrap::RenderArea::queue_render does not queue a new render while the gpu is still busy with the previous one. Instead, all requests are merged into one render that is issued on the first display frame after the gpu caught up, which keeps input latency bounded when frames overrun
+            /// @param b true to enable, false to disable
+            void set_frame_pacing_enabled(bool b);
+
+            /// @brief get whether frame pacing is enabled
+            /// @return true if enabled, false otherwise
+            bool get_frame_pacing_enabled() const;
+
+            /// @brief set time available per frame, used to decide when to change the quality level. By default, the refresh interval of the areas frame clock is used
+            /// @param budget duration, 0 to use the refresh interval of the frame clock
+            void set_frame_budget(Time budget);
+
+            /// @brief get time available per frame
+            /// @return duration
+            Time get_frame_budget() const;
+
+            /// @brief get frame pacing statistics
+            /// @return statistics, all zero if frame pacing is disabled
+            FramePacingStatistics get_frame_pacing_statistics() const;
+
+            /// @brief register a function that is invoked when the quality level changes. The level starts at `n_levels - 1`, it is lowered while the average frame time exceeds the frame budget, and raised again once frames consistently finish well within it. Requires frame pacing to be enabled
+            /// @param n_levels number of quality levels
+            /// @param f function with signature <tt>(uint64_t quality_level, Data_t) -> void</tt>, for example mapping the level to mousetrap::RenderArea::set_anti_aliasing_quality or a level of detail
+            /// @param data arbitrary data
+            template<typename Function_t, typename Data_t>
+            void set_adaptive_quality_callback(uint64_t n_levels, Function_t f, Data_t data);
+
+            /// @brief register a function that is invoked when the quality level changes. The level starts at `n_levels - 1`, it is lowered while the average frame time exceeds the frame budget, and raised again once frames consistently finish well within it. Requires frame pacing to be enabled
+            /// @param n_levels number of quality levels
+            /// @param f function with signature <tt>(uint64_t quality_level) -> void</tt>, for example mapping the level to mousetrap::RenderArea::set_anti_aliasing_quality or a level of detail
+            template<typename Function_t>
+            void set_adaptive_quality_callback(uint64_t n_levels, Function_t f);
+
+            /// @brief remove the adaptive quality callback, if any
+            void clear_adaptive_quality_callback();
+
+            /// @brief get current quality level
+            /// @return level in [0, n_levels), 0 if no adaptive quality callback is registered
+            uint64_t get_quality_level() const;
+
+            /// @brief change the number of MSAA samples, this reallocates the multisampled buffer
+            /// @param quality anti aliasing quality
+            void set_anti_aliasing_quality(AntiAliasingQuality quality);
+
+            /// @brief get number of MSAA samples
+            /// @return anti aliasing quality
+            AntiAliasingQuality get_anti_aliasing_quality() const;
+
+            /// @brief notify the area that a re-render should be done as soon as possible. If frame pacing is enabled and the gpu is behind, the render is delayed instead
             void queue_render();
 
             /// @brief make the areas OpenGL context the currently active context, this is usually not necessary to call
@@ -144,9 +326,19 @@ namespace mousetrap
             static void on_resize(GtkGLArea* area, gint width, gint height, detail::RenderAreaInternal*);
             static gboolean on_render(GtkGLArea*, GdkGLContext*, detail::RenderAreaInternal*);
             static GdkGLContext* on_create_context(GtkGLArea*, GdkGLContext*, detail::RenderAreaInternal*);
+            static void render_tasks(detail::RenderAreaInternal*);
+            static void prepare_commands(detail::RenderAreaInternal*);
+            static void submit_commands(detail::RenderAreaInternal*);
+
+            void set_render_preparation_impl(uint64_t n_jobs, std::function<void(RenderCommandList&, uint64_t)>);
+            void set_adaptive_quality_callback_impl(uint64_t n_levels, std::function<void(uint64_t)>);
+
+            static gboolean on_frame_pacing_tick(GtkWidget*, GdkFrameClock*, detail::RenderAreaInternal*);
 
             detail::RenderAreaInternal* _internal = nullptr;
     };
 }
 
+#include "inline/render_area.hpp"
+
 #endif // MOUSETRAP_ENABLE_OPENGL_COMPONENT
\ No newline at end of file
@@ -0,0 +1,118 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/18/26
+//
+
+#pragma once
+
+#include <mousetrap/gl_common.hpp>
+#if MOUSETRAP_ENABLE_OPENGL_COMPONENT
+
+#include <mousetrap/render_task.hpp>
+#include <mousetrap/immediate_draw.hpp>
+
+#include <vector>
+
+namespace mousetrap
+{
+    class RenderCommandList;
+
+    #ifndef DOXYGEN
+    namespace detail
+    {
+        struct RenderCommand
+        {
+            // nullptr for streamed triangles
+            RenderTaskInternal* task;
+            bool override_transform;
+            GLTransform transform;
+
+            uint64_t first_vertex;
+            uint64_t n_vertices;
+        };
+
+        // contiguous range of commands recorded by one preparation job
+        struct RenderCommandSegment
+        {
+            uint64_t job_index;
+            RenderCommandList* list;
+            uint64_t begin;
+            uint64_t end;
+        };
+
+        struct RenderCommandSubmitter
+        {
+            StreamingVertexBuffer* buffer;
+            Shader* shader;
+            std::vector<RenderCommandSegment> segments;
+
+            // draw calls and vertices issued by the last submit, read by the render area profiler
+            uint64_t n_draw_calls = 0;
+            uint64_t n_vertices = 0;
+        };
+
+        /// @brief allocate submitter, \for_internal_use_only
+        RenderCommandSubmitter* render_command_submitter_new();
+
+        /// @brief free submitter and its vertex buffer
+        void render_command_submitter_free(RenderCommandSubmitter*);
+
+        /// @brief merge command lists in order of job index and issue all commands on the calling thread, which has to own the OpenGL context
+        void render_command_submitter_submit(RenderCommandSubmitter*, const std::vector<RenderCommandList*>& lists);
+    }
+    #endif
+
+    /// @brief list of draw commands recorded on a worker thread during mousetrap::RenderArea::set_render_preparation. Recording does not call into OpenGL, all commands are issued later, on the main thread
+    class RenderCommandList
+    {
+        public:
+            /// @brief construct empty
+            RenderCommandList();
+
+            /// @brief destructor
+            ~RenderCommandList();
+
+            /// @brief copy ctor deleted
+            RenderCommandList(const RenderCommandList&) = delete;
+
+            /// @brief copy assignment deleted
+            RenderCommandList& operator=(const RenderCommandList&) = delete;
+
+            /// @brief record rendering a task. Tasks that are culled should simply not be added
+            /// @param task render task, kept alive until the command was issued
+            void add_task(const RenderTask& task);
+
+            /// @brief record rendering a task with a different transform, the task itself is not modified
+            /// @param task render task, kept alive until the command was issued
+            /// @param transform transform handed to the vertex shader instead of the tasks own transform
+            void add_task(const RenderTask& task, const GLTransform& transform);
+
+            /// @brief record filled triangles, rendered with the default shader
+            /// @param vertices pointer to vertices, 3 per triangle, in gl coordinates
+            /// @param n_vertices number of vertices, has to be a multiple of 3
+            void add_triangles(const Vertex* vertices, uint64_t n_vertices);
+
+            /// @brief record filled triangles, rendered with the default shader
+            /// @param vertices vertices, 3 per triangle, in gl coordinates
+            void add_triangles(const std::vector<Vertex>& vertices);
+
+            /// @brief get number of recorded commands
+            /// @return number of commands
+            uint64_t get_n_commands() const;
+
+            /// @brief remove all commands, keeps allocated memory
+            void clear();
+
+        private:
+            friend void detail::render_command_submitter_submit(detail::RenderCommandSubmitter*, const std::vector<RenderCommandList*>&);
+            friend class RenderArea;
+
+            std::vector<detail::RenderCommand> _commands;
+            std::vector<detail::VertexInfo> _vertices;
+            std::vector<detail::RenderCommandSegment> _segments;
+
+            // first command of the segment currently being recorded, commands before it belong to other jobs and are never merged with
+            uint64_t _segment_begin = 0;
+    };
+}
+
+#endif // MOUSETRAP_ENABLE_OPENGL_COMPONENT
@@ -0,0 +1,160 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/18/26
+//
+
+#pragma once
+
+#include <mousetrap/gl_common.hpp>
+#if MOUSETRAP_ENABLE_OPENGL_COMPONENT
+
+#include <mousetrap/render_texture.hpp>
+#include <mousetrap/signal_emitter.hpp>
+
+#include <vector>
+#include <string>
+#include <functional>
+
+namespace mousetrap
+{
+    /// @brief handed to the render function of a render graph pass
+    struct RenderGraphPassContext
+    {
+        /// @brief textures of the passes inputs, in the order given to mousetrap::RenderGraph::add_pass. Render textures are stored bottom-up, sample them with flipped y texture coordinates
+        std::vector<const Texture*> inputs;
+
+        /// @brief size of the output, in pixels
+        Vector2i output_size = {0, 0};
+    };
+
+    #ifndef DOXYGEN
+    class RenderGraph;
+    namespace detail
+    {
+        struct RenderGraphResource
+        {
+            // transient resources are owned by the graph and may share memory with other transient resources
+            bool is_transient;
+            Vector2f relative_size;
+            const RenderTexture* imported;
+
+            // index into the pool of physical targets, only valid for transient resources after compilation
+            int64_t target = -1;
+        };
+
+        struct RenderGraphPass
+        {
+            std::string name;
+            std::vector<uint64_t> inputs;
+            uint64_t output;
+            std::function<void(const RenderGraphPassContext&)> f;
+            RenderGraphPassContext context;
+        };
+
+        struct RenderGraphTarget
+        {
+            RenderTexture* texture;
+            Vector2f relative_size;
+        };
+
+        struct _RenderGraphInternal
+        {
+            GObject parent;
+
+            std::vector<RenderGraphResource>* resources;
+            std::vector<RenderGraphPass>* passes;
+            std::vector<RenderGraphTarget>* targets;
+
+            // indices of passes that contribute to an output, in dependency order. Only recomputed if the graph changed
+            std::vector<uint64_t>* order;
+            bool is_dirty;
+
+            Vector2i size;
+        };
+        using RenderGraphInternal = _RenderGraphInternal;
+        DEFINE_INTERNAL_MAPPING(RenderGraph);
+
+        /// @brief allocate internal, \for_internal_use_only
+        RenderGraphInternal* render_graph_internal_new();
+
+        /// @brief reallocate all physical targets if size differs from the current size
+        void render_graph_resize(RenderGraphInternal*, Vector2i size);
+
+        /// @brief compile graph if necessary, then run all non-culled passes. Passes writing to mousetrap::RenderGraph::BACKBUFFER render into the framebuffer that is bound when this function is called
+        /// @return number of passes that were run
+        uint64_t render_graph_execute(RenderGraphInternal*);
+    }
+    #endif
+
+    /// @brief graph of render passes, each pass reads from any number of input resources and writes to exactly one output resource. Passes are run in dependency order during each frame of the owning mousetrap::RenderArea, before its render tasks. Passes that do not contribute to the backbuffer or to an imported texture are culled, transient targets whose lifetimes do not overlap share the same GPU memory
+    class RenderGraph : public SignalEmitter
+    {
+        public:
+            /// @brief id of a resource in the graph
+            using ResourceID = uint64_t;
+
+            /// @brief resource referring to the framebuffer of the render area, always present
+            static constexpr ResourceID BACKBUFFER = 0;
+
+            /// @brief construct from internal, \for_internal_use_only. Use mousetrap::RenderArea::get_render_graph to obtain an instance
+            /// @param internal
+            RenderGraph(detail::RenderGraphInternal*);
+
+            /// @brief destructor
+            ~RenderGraph();
+
+            /// @brief declare a transient render target. Its contents are undefined at the start of the pass writing to it, the graph clears it before each write
+            /// @param relative_size size relative to the size of the render area, for example <tt>{0.5, 0.5}</tt> for half resolution
+            /// @return resource id
+            ResourceID create_target(Vector2f relative_size = {1, 1});
+
+            /// @brief declare a persistent render target owned by the user. Passes writing to it are never culled, it never shares memory with other resources
+            /// @param texture render texture, the user is responsible for keeping it alive for as long as the graph references it
+            /// @return resource id
+            ResourceID import_render_texture(const RenderTexture& texture);
+
+            /// @brief add pass
+            /// @param name name of the pass, used for diagnostics
+            /// @param inputs resources read by the pass, these are available as textures through mousetrap::RenderGraphPassContext::inputs
+            /// @param output resource written by the pass, it is bound as render target while the render function is invoked. Each resource other than the backbuffer may only be written by one pass
+            /// @param f render function with signature <tt>(const RenderGraphPassContext&, Data_t) -> void</tt>
+            /// @param data arbitrary data
+            /// @return index of the pass
+            template<typename Function_t, typename Data_t>
+            uint64_t add_pass(const std::string& name, const std::vector<ResourceID>& inputs, ResourceID output, Function_t f, Data_t data);
+
+            /// @brief add pass
+            /// @param name name of the pass, used for diagnostics
+            /// @param inputs resources read by the pass, these are available as textures through mousetrap::RenderGraphPassContext::inputs
+            /// @param output resource written by the pass, it is bound as render target while the render function is invoked. Each resource other than the backbuffer may only be written by one pass
+            /// @param f render function with signature <tt>(const RenderGraphPassContext&) -> void</tt>
+            /// @return index of the pass
+            template<typename Function_t>
+            uint64_t add_pass(const std::string& name, const std::vector<ResourceID>& inputs, ResourceID output, Function_t f);
+
+            /// @brief remove all passes and resources
+            void clear();
+
+            /// @brief get number of passes that are run each frame, after culling
+            /// @return number of passes
+            uint64_t get_n_active_passes() const;
+
+            /// @brief get number of GPU-side render targets allocated for all transient resources, after aliasing
+            /// @return number of render targets
+            uint64_t get_n_allocated_targets() const;
+
+            /// @brief expose internal
+            NativeObject get_internal() const override;
+
+            /// @brief expose as GObject
+            operator NativeObject() const override;
+
+        private:
+            uint64_t add_pass_impl(const std::string& name, const std::vector<ResourceID>& inputs, ResourceID output, std::function<void(const RenderGraphPassContext&)> f);
+
+            detail::RenderGraphInternal* _internal = nullptr;
+    };
+}
+
+#include "inline/render_graph.hpp"
+
+#endif // MOUSETRAP_ENABLE_OPENGL_COMPONENT
@@ -27,9 +27,13 @@ namespace mousetrap
             detail::ShaderInternal* _shader = nullptr;
             GLTransform _transform;
             BlendMode _blend_mode;
+            int32_t _z_index = 0;
 
             static inline Shader* noop_shader = nullptr;
 
+            // incremented whenever the z-index of any task changes, render areas only re-sort if it differs from the value at their last sort
+            static inline uint64_t z_index_generation = 0;
+
             std::map<std::string, float>* _floats;
             std::map<std::string, int>* _ints;
             std::map<std::string, glm::uint>* _uints;
@@ -150,6 +154,14 @@ namespace mousetrap
             /// @return HSVA
             HSVA get_uniform_hsva(const std::string& uniform_name) const;
 
+            /// @brief set z-index, tasks with a higher z-index are rendered on top of tasks with a lower z-index. Tasks with the same z-index are rendered in the order they were added to the mousetrap::RenderArea
+            /// @param z_index
+            void set_z_index(int32_t z_index);
+
+            /// @brief get z-index
+            /// @return z-index, 0 by default
+            int32_t get_z_index() const;
+
             /// @brief perform the render step to the currently bound framebuffer
             void render() const;
 
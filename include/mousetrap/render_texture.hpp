@@ -19,7 +19,10 @@ namespace mousetrap
         {
             GObject parent;
             GLNativeHandle framebuffer_handle;
+            GLNativeHandle attached_texture = 0;
+            uint64_t attached_handle_generation = 0;
             GLint before_buffer;
+            GLint before_viewport[4];
         };
         using RenderTextureInternal = _RenderTextureInternal;
         DEFINE_INTERNAL_MAPPING(RenderTexture);
@@ -60,10 +63,10 @@ namespace mousetrap
             /// @returns reference to self after assignment
             RenderTexture& operator=(RenderTexture&&);
 
-            /// @brief bind texture as render target, from this point on all render calls will write to its internal framebuffer instead
+            /// @brief bind texture as render target, from this point on all render calls will write to its internal framebuffer instead. The viewport is set to the size of the texture
             void bind_as_render_target() const;
 
-            /// @brief unbind as render target, restores the framebuffer that was active before mousetrap::RenderTexture::bind_as_rendertarget was called
+            /// @brief unbind as render target, restores the framebuffer and viewport that were active before mousetrap::RenderTexture::bind_as_rendertarget was called
             void unbind_as_render_target() const;
 
             /// @brief expose as gobject
@@ -36,6 +36,11 @@ namespace mousetrap
             GLNativeHandle fragment_shader_id;
             GLNativeHandle vertex_shader_id;
 
+            // locations of the uniforms set by mousetrap::Shape::render, queried once whenever the program is linked
+            GLint transform_location = -1;
+            GLint model_transform_location = -1;
+            GLint texture_set_location = -1;
+
             static inline uint64_t noop_program_id;
             static inline uint64_t noop_fragment_shader_id;
             static inline uint64_t noop_vertex_shader_id;
@@ -162,7 +167,7 @@ namespace mousetrap
                 }
             )";
 
-            /// @brief noop vertex shader behavior, render the shapes vertices after applying the set transform
+            /// @brief noop vertex shader behavior, render the shapes vertices after applying the shapes model transform, then the render tasks transform
             static inline const std::string noop_vertex_shader_code = R"(
                 #version 330
 
@@ -171,6 +176,7 @@ namespace mousetrap
                 layout (location = 2) in vec2 _vertex_texture_coordinates_in;
 
                 uniform mat4 _transform;
+                uniform mat4 _model_transform;
 
                 out vec4 _vertex_color;
                 out vec2 _texture_coordinates;
@@ -178,7 +184,7 @@ namespace mousetrap
 
                 void main()
                 {
-                    gl_Position = _transform * vec4(_vertex_position_in, 1.0);
+                    gl_Position = _transform * _model_transform * vec4(_vertex_position_in, 1.0);
                     _vertex_color = _vertex_color_in;
                     _vertex_position = _vertex_position_in;
                     _texture_coordinates = _vertex_texture_coordinates_in;
@@ -71,16 +71,14 @@ namespace mousetrap
             CIRCULAR_RING,
             ELLIPTICAL_RING,
             WIREFRAME,
-            OUTLINE
+            OUTLINE,
+            QUADS
         };
 
-        struct _ShapeInternal
+        struct _ShapeGeometryInternal
         {
             GObject parent;
 
-            RGBA* color;
-            bool is_visible = true;
-
             std::vector<Vertex>* vertices;
             std::vector<int>* indices;
             GLenum render_type = GL_TRIANGLE_STRIP;
@@ -90,6 +88,22 @@ namespace mousetrap
 
             GLNativeHandle vertex_array_id = 0;
             GLNativeHandle vertex_buffer_id = 0;
+            GLNativeHandle element_buffer_id = 0;
+        };
+        using ShapeGeometryInternal = _ShapeGeometryInternal;
+
+        struct _ShapeInternal
+        {
+            GObject parent;
+
+            RGBA* color;
+            bool is_visible = true;
+
+            // if true, color is used for all vertices instead of the vertex colors, such that shared geometry can be recolored per shape
+            bool has_color_override = false;
+
+            ShapeGeometryInternal* geometry;
+            GLTransform* model_transform;
 
             const TextureObject* texture = nullptr;
         };
@@ -115,20 +129,20 @@ namespace mousetrap
             /// @brief expose internal
             NativeObject get_internal() const override;
 
-            /// @brief copy ctor, allocates new vertex array with identical vertex data
+            /// @brief copy ctor, shares the vertex array of other, no vertex data is uploaded. Geometry is copied on the first modification of either shape, color, texture, visibility and model transform are per-shape
             /// @param other
             Shape(const Shape&);
 
-            /// @brief copy assignment, allocates new vertex array with identical vertex data
+            /// @brief copy assignment, shares the vertex array of other, no vertex data is uploaded. Geometry is copied on the first modification of either shape
             /// @param other
             /// @returns reference to self after assignment
             Shape& operator=(const Shape&);
 
-            /// @brief move ctor
+            /// @brief move ctor, takes over the vertices and GPU-side buffers of other without copying them. Other may only be assigned to or destroyed afterwards
             /// @param other
             Shape(Shape&&) noexcept;
 
-            /// @brief move assignment
+            /// @brief move assignment, takes over the vertices and GPU-side buffers of other without copying them. Other may only be assigned to or destroyed afterwards
             /// @param other
             /// @returns reference to self after assignment
             Shape& operator=(Shape&&) noexcept;
@@ -255,8 +269,15 @@ namespace mousetrap
             /// @copydoc Shape::as_wireframe
             static Shape Wireframe(const std::vector<Vector2f>& points);
 
+            /// @brief construct as set of independent quads, each quad is rendered as two triangles
+            /// @param vertices vertices in groups of 4: top left, top right, bottom right, bottom left. Texture coordinates and colors are used as given
+            void as_quads(const std::vector<Vertex>& vertices);
+
+            /// @copydoc Shape::as_quads
+            static Shape Quads(const std::vector<Vertex>& vertices);
+
             /// @brief construct a wireframe from a shapes outer vertices. Useful for generating frames or outlines
-            /// @param shape another shape, will generate minimum bounding polygon and construct a wireframe from that polygon
+            /// @param shape another shape, will generate minimum bounding polygon and construct a wireframe from that polygon. The model transform of shape is applied to the outlines vertices
             void as_outline(const Shape& shape, RGBA color = RGBA(0, 0, 0, 1));
 
             /// @copydoc Shape::as_outline
@@ -289,20 +310,25 @@ namespace mousetrap
 
             /// @brief set vertex position in 3d space, does nothing if index out of bounds
             /// @param index vertex index
-            /// @param position position in 3d space
+            /// @param position position in 3d space, after the model transform was applied, consistent with mousetrap::Shape::get_vertex_position
             /// @note if multiple vertex positions change at the same time, use mousetrap::Vertex::as_rectangle (or other appropriate shape) to update all of them at once in a more performant manned
             void set_vertex_position(uint64_t index, Vector3f position);
 
+            /// @brief replace a contiguous range of vertices, only this range is uploaded
+            /// @param first index of the first vertex to replace
+            /// @param vertices new vertices, first + vertices.size() has to be smaller or equal to mousetrap::Shape::get_n_vertices
+            void set_vertices(uint64_t first, const std::vector<Vertex>& vertices);
+
             /// @brief get vertex position in 3d space, return Vector3f() if out of bounds
             /// @param index vertex index
-            /// @return position in 3d space
+            /// @return position in 3d space, with the model transform applied
             Vector3f get_vertex_position(uint64_t index) const;
 
             /// @brief get number of vertices, the number depends on the shape and may be larger than intuitive
             /// @return number of vertices
             uint64_t get_n_vertices() const;
 
-            /// @brief set color of all vertices at once
+            /// @brief set color of all vertices at once. If the geometry is shared with other shapes, it is not copied, the color is instead applied to this shape only when rendering
             /// @param rgba color in RGBA
             void set_color(RGBA rgba);
 
@@ -314,35 +340,60 @@ namespace mousetrap
             /// @return true if false, mousetrap::Shape::render will do nothing, true otherwise
             bool get_is_visible() const;
 
-            /// @brief get axis aligned bounding box of all vertices
+            /// @brief get axis aligned bounding box of all vertices, after the model transform is applied
             /// @return rectangle
             struct Rectangle get_bounding_box() const;
 
-            /// @brief get size of axis aligned bounding box
+            /// @brief get size of axis aligned bounding box, after the model transform is applied
             /// @return width, height
             Vector2f get_size() const;
 
-            /// @brief align all vertices such that the centroid, the center of the axis aligned bounding box, is set to the given position
+            /// @brief align all vertices such that the centroid, the center of the axis aligned bounding box, is set to the given position. The model transform is taken into account, such that the transformed shape ends up at the given position
             /// @param new_position
             void set_centroid(Vector2f new_position);
 
-            /// @brief get centroid, center of the axis aligned bounding box
+            /// @brief get centroid, center of the axis aligned bounding box, after the model transform is applied
             /// @return position
             Vector2f get_centroid() const;
 
-            /// @brief align top left of axis aligned bounding box with position
+            /// @brief align top left of axis aligned bounding box with position. The model transform is taken into account, such that the transformed shape ends up at the given position
             /// @param position
             void set_top_left(Vector2f position);
 
-            /// @brief get top left of axis aligned bounding box
+            /// @brief get top left of axis aligned bounding box, after the model transform is applied
             /// @return position
             Vector2f get_top_left() const;
 
-            /// @brief rotate all vertices around origin
+            /// @brief apply transform to all vertices, this happens in a single pass and uploads the vertex data exactly once
+            /// @param transform
+            void apply_transform(GLTransform transform);
+
+            /// @brief rotate the shape by modifying its model transform, vertex data is not modified
             /// @param angle
             /// @param origin point in 2d space
             void rotate(Angle angle, Vector2f origin);
 
+            /// @brief translate the shape by modifying its model transform, vertex data is not modified
+            /// @param offset offset in gl coordinates
+            void translate(Vector2f offset);
+
+            /// @brief scale the shape by modifying its model transform, vertex data is not modified
+            /// @param x_scale horizontal scale
+            /// @param y_scale vertical scale
+            /// @param origin point in 2d space that stays in place
+            void scale(float x_scale, float y_scale, Vector2f origin);
+
+            /// @brief set model transform, it is applied to all vertices in the vertex shader, after which the transform of the render task is applied
+            /// @param transform
+            void set_model_transform(GLTransform transform);
+
+            /// @brief get model transform
+            /// @return transform, identity by default
+            GLTransform get_model_transform() const;
+
+            /// @brief apply the model transform to the vertex data, then reset the model transform to identity. Vertex positions queried afterwards reflect the transformed geometry
+            void bake_transform();
+
             /// @brief set texture of shape, has to be queried in the fragment shader using the <tt>int _texture_set</tt> and <tt>Sampler2D _texture</tt> uniforms, the default fragment shader does this automatically
             /// @param texture texture object, such as mousetrap::Texture, mousetrap::RenderTexture or mousetrap::MultisampledRenderTexture. The user is responsible for making sure the texture stays in memory. May be nullptr
             void set_texture(const TextureObject* texture);
@@ -359,6 +410,7 @@ namespace mousetrap
             void update_color() const;
             void update_texture_coordinate() const;
             void initialize();
+            void make_geometry_unique(bool copy_data = true);
 
             std::vector<Vector2f> sort_by_angle(const std::vector<Vector2f>&);
 
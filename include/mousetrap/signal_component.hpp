@@ -6,12 +6,15 @@
 
 #include <cstddef>
 #include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
 #include <mousetrap/gtk_common.hpp>
 #include <mousetrap/signal_emitter.hpp>
 
 namespace mousetrap
 {
-    /// @brief base class of all signal components
+    /// @brief base class of all signal components. The instance handed to a handler is the object the handler was connected through, as long as that object is alive. A handler must therefore not destroy that object, for example by clearing a container holding it, and then keep using its instance argument, which would dangle
     struct SignalComponent
     {
         SignalComponent() = default;
@@ -21,6 +24,133 @@ namespace mousetrap
         SignalComponent& operator=(const SignalComponent&) = delete;
     };
 
+    #ifndef DOXYGEN
+    namespace detail
+    {
+        template<typename Signature>
+        class SignalHandler;
+
+        /// @brief type-erased callable with inline storage, such that handlers of up to `capacity` bytes do not allocate. Unlike std::function, a zero-initialized instance is a valid empty handler, signal internals are allocated by g_object_new, which does not run constructors
+        template<typename Return_t, typename... Args_t>
+        class SignalHandler<Return_t(Args_t...)>
+        {
+            public:
+                static constexpr size_t capacity = 48;
+
+                SignalHandler() = default;
+                SignalHandler(const SignalHandler&) = delete;
+                SignalHandler& operator=(const SignalHandler&) = delete;
+
+                ~SignalHandler()
+                {
+                    reset();
+                }
+
+                template<typename Function_t>
+                SignalHandler& operator=(Function_t f)
+                {
+                    reset();
+
+                    using Stored_t = std::decay_t<Function_t>;
+                    if constexpr (sizeof(Stored_t) <= capacity and alignof(Stored_t) <= alignof(std::max_align_t) and std::is_nothrow_move_constructible_v<Stored_t>)
+                    {
+                        _callable = new (_storage) Stored_t(std::move(f));
+                        _destroy = [](void* callable) {
+                            static_cast<Stored_t*>(callable)->~Stored_t();
+                        };
+                    }
+                    else
+                    {
+                        _callable = new Stored_t(std::move(f));
+                        _destroy = [](void* callable) {
+                            delete static_cast<Stored_t*>(callable);
+                        };
+                    }
+
+                    _invoke = [](void* callable, Args_t... args) -> Return_t {
+                        return (*static_cast<Stored_t*>(callable))(std::forward<Args_t>(args)...);
+                    };
+
+                    return *this;
+                }
+
+                SignalHandler& operator=(std::nullptr_t)
+                {
+                    reset();
+                    return *this;
+                }
+
+                explicit operator bool() const
+                {
+                    return _invoke != nullptr;
+                }
+
+                Return_t operator()(Args_t... args) const
+                {
+                    return _invoke(_callable, std::forward<Args_t>(args)...);
+                }
+
+                void reset()
+                {
+                    if (_destroy != nullptr)
+                        _destroy(_callable);
+
+                    _callable = nullptr;
+                    _invoke = nullptr;
+                    _destroy = nullptr;
+                }
+
+            private:
+                alignas(std::max_align_t) unsigned char _storage[capacity];
+                void* _callable = nullptr;
+                Return_t (*_invoke)(void*, Args_t...) = nullptr;
+                void (*_destroy)(void*) = nullptr;
+        };
+
+        /// @brief non-owning pointer to the object that connected the handler, handed to the handler instead of constructing a temporary on every emission. Holding a reference would keep the object alive, so the object unregisters itself when it is destroyed. Nothing keeps it alive during dispatch, the dispatch does not touch it after the handler returns, see mousetrap::SignalComponent
+        struct SignalInstanceCache
+        {
+            void* instance;
+            const void* type;
+        };
+
+        /// @brief unique address per type, the same native object may be wrapped by different types, for example mousetrap::Widget and mousetrap::Button
+        template<typename T>
+        const void* signal_instance_type()
+        {
+            static const char id = 0;
+            return &id;
+        }
+
+        template<typename T, typename Internal_t>
+        void signal_instance_cache_register(Internal_t* internal, T* instance)
+        {
+            internal->cache.instance = instance;
+            internal->cache.type = signal_instance_type<T>();
+        }
+
+        template<typename T, typename Internal_t>
+        void signal_instance_cache_unregister(Internal_t* internal, T* instance)
+        {
+            if (internal->cache.instance == instance)
+            {
+                internal->cache.instance = nullptr;
+                internal->cache.type = nullptr;
+            }
+        }
+
+        /// @return registered instance if it is of type T, nullptr otherwise
+        template<typename T, typename Internal_t>
+        T* signal_instance_cache_get(Internal_t* internal)
+        {
+            if (internal->cache.instance != nullptr and internal->cache.type == signal_instance_type<T>())
+                return static_cast<T*>(internal->cache.instance);
+
+            return nullptr;
+        }
+    }
+    #endif
+
     #define SPLAT(...) __VA_ARGS__
 
     #define CTOR_SIGNAL(T, signal_name) \
@@ -40,8 +170,9 @@ namespace mousetrap
         { \
             GObject parent; \
             NativeObject instance; \
-            std::function<return_t(void*)> function; \
+            SignalHandler<return_t(void*)> function; \
             bool is_blocked; \
+            SignalInstanceCache cache; \
         }; \
         using SIGNAL_INTERNAL_CLASS_NAME(CamelCase) = SIGNAL_INTERNAL_PRIVATE_CLASS_NAME(CamelCase); \
         SIGNAL_INTERNAL_CLASS_NAME(CamelCase)* has_signal_##snake_case##_internal_new(NativeObject instance); \
@@ -56,11 +187,15 @@ namespace mousetrap
             \
             static return_t wrapper(void*, detail::SIGNAL_INTERNAL_CLASS_NAME(CamelCase)* internal) \
             { \
+                if (not internal->function or internal->is_blocked) \
+                    return return_t(); \
+                \
+                auto* cached = detail::signal_instance_cache_get<T>(internal); \
+                if (cached != nullptr) \
+                    return internal->function(cached); \
+                \
                 auto temp = T((typename detail::InternalMapping<T>::value*) internal->instance); \
-                if (internal->function and not internal->is_blocked) \
-                    return internal->function((void*) &temp);                       \
-                else                                                                \
-                    return return_t();\
+                return internal->function((void*) &temp); \
             } \
             \
             void initialize() \
@@ -89,7 +224,10 @@ namespace mousetrap
             ~SIGNAL_CLASS_NAME(snake_case)() \
             { \
                 if (_internal != nullptr)\
+                { \
+                    detail::signal_instance_cache_unregister(_internal, _instance); \
                     g_object_unref(_internal);                                   \
+                } \
             } \
         \
         public: \
@@ -105,6 +243,7 @@ namespace mousetrap
                 }; \
             \
                 T((typename detail::InternalMapping<T>::value*) _internal->instance).connect_signal(signal_id, wrapper, _internal); \
+                detail::signal_instance_cache_register(_internal, _instance); \
             } \
             \
             template <typename Function_t> \
@@ -117,6 +256,7 @@ namespace mousetrap
                 }; \
                 \
                 T((typename detail::InternalMapping<T>::value*) _internal->instance).connect_signal(signal_id, wrapper, _internal); \
+                detail::signal_instance_cache_register(_internal, _instance); \
             } \
             \
             void set_signal_##snake_case##_blocked(bool b) \
@@ -135,7 +275,7 @@ namespace mousetrap
             void emit_signal_##snake_case() \
             { \
                 initialize(); \
-                g_signal_emit_by_name(T((typename detail::InternalMapping<T>::value*) _internal->instance).operator GObject*(), signal_id); \
+                g_signal_emit_by_name(_instance->operator GObject*(), signal_id); \
             } \
             \
             void disconnect_signal_##snake_case() \
@@ -151,8 +291,9 @@ namespace mousetrap
         { \
             GObject parent; \
             NativeObject instance; \
-            std::function<return_t(void*, arg_list)> function; \
+            SignalHandler<return_t(void*, arg_list)> function; \
             bool is_blocked; \
+            SignalInstanceCache cache; \
         }; \
         using SIGNAL_INTERNAL_CLASS_NAME(CamelCase) = SIGNAL_INTERNAL_PRIVATE_CLASS_NAME(CamelCase); \
         SIGNAL_INTERNAL_CLASS_NAME(CamelCase)* has_signal_##snake_case##_internal_new(NativeObject instance); \
@@ -167,11 +308,15 @@ namespace mousetrap
             \
             static return_t wrapper(void*, arg_list, detail::SIGNAL_INTERNAL_CLASS_NAME(CamelCase)* internal) \
             { \
-                auto temp = T((typename detail::InternalMapping<T>::value*) internal->instance); \
-                if (internal->function and not internal->is_blocked) \
-                    return internal->function((void*) &temp, arg_name_only_list); \
-                else \
+                if (not internal->function or internal->is_blocked) \
                     return return_t(); \
+                \
+                auto* cached = detail::signal_instance_cache_get<T>(internal); \
+                if (cached != nullptr) \
+                    return internal->function(cached, arg_name_only_list); \
+                \
+                auto temp = T((typename detail::InternalMapping<T>::value*) internal->instance); \
+                return internal->function((void*) &temp, arg_name_only_list); \
             } \
             \
             void initialize() \
@@ -194,7 +339,11 @@ namespace mousetrap
                 : _instance(instance) \
             {} \
             \
-            ~SIGNAL_CLASS_NAME(snake_case)() = default; \
+            ~SIGNAL_CLASS_NAME(snake_case)() \
+            { \
+                if (_internal != nullptr) \
+                    detail::signal_instance_cache_unregister(_internal, _instance); \
+            } \
         \
         public: \
             static inline const char* signal_id = g_signal_id; \
@@ -209,6 +358,7 @@ namespace mousetrap
                 }; \
             \
                 T((typename detail::InternalMapping<T>::value*) _internal->instance).connect_signal(signal_id, wrapper, _internal); \
+                detail::signal_instance_cache_register(_internal, _instance); \
             } \
             \
             template <typename Function_t> \
@@ -221,6 +371,7 @@ namespace mousetrap
                 }; \
                 \
                 T((typename detail::InternalMapping<T>::value*) _internal->instance).connect_signal(signal_id, wrapper, _internal); \
+                detail::signal_instance_cache_register(_internal, _instance); \
             } \
             \
             void set_signal_##snake_case##_blocked(bool b) \
@@ -239,7 +390,7 @@ namespace mousetrap
             void emit_signal_##snake_case(arg_list) \
             { \
                 initialize(); \
-                g_signal_emit_by_name(T((typename detail::InternalMapping<T>::value*) _internal->instance).operator GObject*(), signal_id, arg_name_only_list); \
+                g_signal_emit_by_name(_instance->operator GObject*(), signal_id, arg_name_only_list); \
             } \
             \
             void disconnect_signal_##snake_case() \
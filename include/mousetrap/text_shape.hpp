@@ -0,0 +1,130 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/18/26
+//
+
+#pragma once
+
+#include <mousetrap/gl_common.hpp>
+#if MOUSETRAP_ENABLE_OPENGL_COMPONENT
+
+#include <mousetrap/glyph_atlas.hpp>
+#include <mousetrap/shape.hpp>
+#include <mousetrap/color.hpp>
+#include <mousetrap/signal_emitter.hpp>
+
+#include <map>
+#include <vector>
+#include <string>
+
+namespace mousetrap
+{
+    #ifndef DOXYGEN
+    class TextShape;
+    namespace detail
+    {
+        struct TextLabel
+        {
+            std::string text;
+            Vector2f position;
+            RGBA color;
+
+            // range of quads in the shared vertex buffer reserved for this label, unused quads are degenerate
+            uint64_t first_quad = 0;
+            uint64_t n_quads = 0;
+            uint64_t capacity = 0;
+        };
+
+        struct _TextShapeInternal
+        {
+            GObject parent;
+
+            GlyphAtlasInternal* atlas;
+            Shape* shape;
+            Vector2f viewport_size;
+
+            std::vector<Vertex>* vertices;
+            std::map<uint64_t, TextLabel>* labels;
+            std::vector<GlyphQuad>* quads;
+
+            uint64_t current_id = 0;
+            uint64_t n_quads_used = 0;
+
+            // number of quads in the vertex buffer of shape, grows geometrically such that adding labels one by one does not re-upload the entire buffer each time
+            uint64_t n_quads_allocated = 0;
+        };
+        using TextShapeInternal = _TextShapeInternal;
+        DEFINE_INTERNAL_MAPPING(TextShape);
+    }
+    #endif
+
+    /// @brief any number of text labels rendered in a single draw call, glyphs are sampled from a mousetrap::GlyphAtlas. Changing a label only re-uploads the vertices of that label
+    class TextShape : public SignalEmitter
+    {
+        public:
+            /// @brief construct
+            /// @param atlas glyph atlas, may be shared between multiple text shapes
+            /// @param viewport_size size of the render area in pixels, used to convert glyph sizes to gl coordinates
+            TextShape(GlyphAtlas& atlas, Vector2f viewport_size);
+
+            /// @brief construct from internal, \for_internal_use_only
+            TextShape(detail::TextShapeInternal*);
+
+            /// @brief destructor
+            ~TextShape();
+
+            /// @brief copy ctor deleted
+            TextShape(const TextShape&) = delete;
+
+            /// @brief copy assignment deleted
+            TextShape& operator=(const TextShape&) = delete;
+
+            /// @brief add label. Only the new label is uploaded, unless the vertex buffer is full, in which case its capacity is doubled
+            /// @param text utf8 text, may contain newlines
+            /// @param top_left top left of the labels bounding box, in gl coordinates
+            /// @param color text color
+            /// @return id of the label, used to modify it
+            uint64_t add_label(const std::string& text, Vector2f top_left, RGBA color = RGBA(1, 1, 1, 1));
+
+            /// @brief replace text of a label
+            /// @param id label id, obtained from mousetrap::TextShape::add_label
+            /// @param text utf8 text
+            void set_label_text(uint64_t id, const std::string& text);
+
+            /// @brief move label, the text is not laid out again, only the vertices of its glyphs are re-uploaded
+            /// @param id label id
+            /// @param top_left top left of the labels bounding box, in gl coordinates
+            void set_label_position(uint64_t id, Vector2f top_left);
+
+            /// @brief set label color, the text is not laid out again, only the vertices of its glyphs are re-uploaded
+            /// @param id label id
+            /// @param color text color
+            void set_label_color(uint64_t id, RGBA color);
+
+            /// @brief remove label, its id becomes invalid
+            /// @param id label id
+            void remove_label(uint64_t id);
+
+            /// @brief get number of labels
+            /// @return number of labels
+            uint64_t get_n_labels() const;
+
+            /// @brief set viewport size, regenerates all labels. Should be called from the render areas <tt>resize</tt> signal handler
+            /// @param viewport_size size of the render area in pixels
+            void set_viewport_size(Vector2f viewport_size);
+
+            /// @brief get shape containing all labels, textured with the glyph atlas. Use with mousetrap::RenderTask, alpha blending is required
+            /// @return shape
+            const Shape& get_shape() const;
+
+            /// @brief expose internal
+            NativeObject get_internal() const override;
+
+            /// @brief expose as GObject
+            operator NativeObject() const override;
+
+        private:
+            detail::TextShapeInternal* _internal = nullptr;
+    };
+}
+
+#endif // MOUSETRAP_ENABLE_OPENGL_COMPONENT
@@ -9,6 +9,7 @@
 #if MOUSETRAP_ENABLE_OPENGL_COMPONENT
 
 #include <string>
+#include <functional>
 #include <mousetrap/image.hpp>
 #include <mousetrap/texture_object.hpp>
 #include <mousetrap/texture_wrap_mode.hpp>
@@ -28,8 +29,19 @@ namespace mousetrap
             TextureWrapMode wrap_mode = TextureWrapMode::STRETCH;
             TextureScaleMode scale_mode = TextureScaleMode::NEAREST;
             Vector2i* size;
+
+            // number of mipmap levels, only files written as ImageFileFormat::RAW with mipmaps have more than one
+            uint64_t n_levels = 1;
+
+            uint64_t load_generation = 0;
+
+            // incremented whenever native_handle is replaced, such that objects referring to the previous handle can notice, even if OpenGL reuses its name
+            uint64_t handle_generation = 0;
         };
         using TextureInternal = _TextureInternal;
+
+        /// @brief get number of bytes of video memory of all levels, computed from the internal format the driver reports for the uploaded storage \for_internal_use_only
+        uint64_t texture_get_n_bytes(TextureInternal*);
     }
     #endif
 
@@ -70,6 +82,10 @@ namespace mousetrap
             /// @brief download texture data into a CPU-side image, this is an extremely costly operation
             [[nodiscard]] Image download() const;
 
+            /// @brief download texture data into a CPU-side image of a specific storage format, for example mousetrap::ImageFormat::RGBA32F to read back float data without quantization
+            /// @param format
+            [[nodiscard]] Image download(ImageFormat format) const;
+
             /// @brief bind the texture for rendering
             /// @param texture_unit texture unit to bind to, usually <tt>GL_TEXTURE0 + n</tt> where n = 0, 1, ...
             void bind(uint64_t texture_unit) const;
@@ -85,15 +101,36 @@ namespace mousetrap
             /// @param height
             void create(uint64_t width, uint64_t height);
 
-            /// @brief create texture from an image on disk
+            /// @brief create texture from an image on disk, the file is only decoded if it is not in mousetrap::image_cache. Use mousetrap::image_cache::get_texture to also share the upload. Files written as mousetrap::ImageFileFormat::RAW are uploaded straight from the memory-mapped file, including their mipmaps
             /// @param path absolute path
             /// @return true if operation was succesful, false otherwise
             bool create_from_file(const std::string& path);
 
-            /// @brief create from image
+            /// @brief create texture from an image on disk without blocking. The image is decoded and uploaded on a worker thread, until then the texture is a 1x1 transparent placeholder and can be used in render tasks as usual
+            /// @param path absolute path
+            /// @param on_done function with signature <tt>(Texture&, bool success, Data_t) -> void</tt>, invoked on the main thread once the texture is ready
+            /// @param data arbitrary data
+            /// @note if the texture is re-created before loading finished, the result of the load is discarded and on_done is not invoked
+            template<typename Function_t, typename Data_t>
+            void create_from_file_async(const std::string& path, Function_t on_done, Data_t data);
+
+            /// @brief create texture from an image on disk without blocking. The image is decoded and uploaded on a worker thread, until then the texture is a 1x1 transparent placeholder and can be used in render tasks as usual
+            /// @param path absolute path
+            /// @param on_done function with signature <tt>(Texture&, bool success) -> void</tt>, invoked on the main thread once the texture is ready
+            /// @note if the texture is re-created before loading finished, the result of the load is discarded and on_done is not invoked
+            template<typename Function_t>
+            void create_from_file_async(const std::string& path, Function_t on_done);
+
+            /// @brief create from image. The texture format matches the storage format of the image, mousetrap::ImageFormat::R8, mousetrap::ImageFormat::R32F and mousetrap::ImageFormat::RGBA32F are uploaded without conversion and single-channel textures are sampled as grayscale
             /// @param image
             void create_from_image(const Image&);
 
+            /// @brief overwrite a rectangular region of the texture with the pixels of an image, without reallocating the texture
+            /// @param x left-most column of the region, in pixels
+            /// @param y top-most row of the region, in pixels
+            /// @param image image, has to fit into the texture at the given offset
+            void set_region(uint64_t x, uint64_t y, const Image& image);
+
             /// @brief set wrap mode, this governs how the texture behaves when the texture coordinates of a vertex are outside of [0, 1]
             /// @param wrap_mode
             void set_wrap_mode(TextureWrapMode);
@@ -123,8 +160,12 @@ namespace mousetrap
             operator GObject*() const override;
 
         private:
+            void create_from_file_async_impl(const std::string& path, std::function<void(Texture&, bool)> on_done);
+
             detail::TextureInternal* _internal = nullptr;
     };
 }
 
+#include "inline/texture.hpp"
+
 #endif // MOUSETRAP_ENABLE_OPENGL_COMPONENT
\ No newline at end of file
@@ -0,0 +1,31 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/18/26
+//
+
+#pragma once
+
+#include <functional>
+#include <cstdint>
+
+namespace mousetrap
+{
+    #ifndef DOXYGEN
+    namespace detail
+    {
+        /// @brief work-stealing thread pool, each worker owns a deque of chunks and steals from the other workers once its own deque is empty
+        struct ThreadPool;
+
+        /// @brief get process-wide pool, created on first use with one worker less than the number of hardware threads, since the calling thread participates in all work
+        ThreadPool* thread_pool_get_default();
+
+        /// @brief get number of threads that execute work, including the calling thread
+        uint64_t thread_pool_get_n_threads(ThreadPool*);
+
+        /// @brief invoke f for all indices in [0, n), blocks until all invocations returned
+        /// @param f function with signature <tt>(uint64_t index, uint64_t thread_index) -> void</tt>, thread_index is in [0, thread_pool_get_n_threads), 0 being the calling thread
+        /// @param grain number of consecutive indices processed as one unit of work
+        /// @note if called from inside a pool worker, or while another thread is using the pool, f is invoked sequentially on the calling thread with thread_index 0
+        void thread_pool_parallel_for(ThreadPool*, uint64_t n, const std::function<void(uint64_t, uint64_t)>& f, uint64_t grain = 1);
+    }
+    #endif
+}
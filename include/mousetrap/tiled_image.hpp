@@ -0,0 +1,184 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/18/26
+//
+
+#pragma once
+
+#include <mousetrap/gtk_common.hpp>
+#include <mousetrap/image.hpp>
+#include <mousetrap/geometry.hpp>
+#include <mousetrap/signal_emitter.hpp>
+
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <list>
+#include <deque>
+
+namespace mousetrap
+{
+    #ifndef DOXYGEN
+    class TiledImage;
+    namespace detail
+    {
+        struct TiledImageTile
+        {
+            Image image;
+            uint64_t n_bytes;
+            std::list<uint64_t>::iterator lru_position;
+        };
+
+        struct _TiledImageInternal
+        {
+            GObject parent;
+
+            uint64_t width;
+            uint64_t height;
+            uint64_t n_levels;
+
+            // invoked on worker threads, has to be thread-safe
+            std::function<bool(uint64_t, uint64_t, uint64_t, Image&)>* decode;
+
+            // decoded tiles, lru is ordered from most to least recently used
+            std::unordered_map<uint64_t, TiledImageTile>* tiles;
+            std::list<uint64_t>* lru;
+            uint64_t memory_budget;
+            uint64_t memory_usage;
+
+            // requests are served most recent first, such that the current view takes priority over earlier ones
+            std::deque<uint64_t>* queue;
+            std::unordered_set<uint64_t>* queued;
+            std::unordered_set<uint64_t>* in_flight;
+            uint64_t max_n_in_flight;
+
+            // incremented on create, results of decodes started before are discarded
+            uint64_t generation;
+
+            std::unordered_map<void*, std::function<void(uint64_t, uint64_t, uint64_t)>>* listeners;
+        };
+        using TiledImageInternal = _TiledImageInternal;
+        DEFINE_INTERNAL_MAPPING(TiledImage);
+
+        /// @brief pack tile coordinates into a cache key
+        uint64_t tiled_image_key(uint64_t level, uint64_t x, uint64_t y);
+
+        /// @brief unpack cache key
+        void tiled_image_unpack_key(uint64_t key, uint64_t& level, uint64_t& x, uint64_t& y);
+
+        /// @brief register a function invoked on the main thread whenever a tile finished decoding, \for_internal_use_only
+        void tiled_image_add_listener(TiledImageInternal*, void* owner, std::function<void(uint64_t level, uint64_t x, uint64_t y)> f);
+
+        /// @brief unregister listener
+        void tiled_image_remove_listener(TiledImageInternal*, void* owner);
+    }
+    #endif
+
+    /// @brief image too large to be decoded at once. It is divided into tiles of 256x256 pixels at multiple levels of detail, level 0 being full resolution and each following level being half the size of the previous. Tiles are decoded on demand on background threads, and kept in a least-recently-used cache with a memory budget. Display using mousetrap::TiledImageDisplay
+    class TiledImage : public SignalEmitter
+    {
+        public:
+            /// @brief width and height of a tile, in pixels
+            static constexpr uint64_t tile_size = 256;
+
+            /// @brief construct as image of size 0x0
+            TiledImage();
+
+            /// @brief construct from internal
+            TiledImage(detail::TiledImageInternal*);
+
+            /// @brief destructor
+            ~TiledImage();
+
+            /// @brief copy ctor deleted
+            TiledImage(const TiledImage&) = delete;
+
+            /// @brief copy assignment deleted
+            TiledImage& operator=(const TiledImage&) = delete;
+
+            /// @brief expose internal
+            NativeObject get_internal() const override;
+
+            /// @brief expose as GObject \for_internal_use_only
+            operator GObject*() const override;
+
+            /// @brief create with a custom tile decoder, for example one reading a tiled file format region by region. This is the only way to open images that do not fit into memory
+            /// @param width width at full resolution
+            /// @param height height at full resolution
+            /// @param f function with signature <tt>(uint64_t level, uint64_t tile_x, uint64_t tile_y, Image& out, Data_t) -> bool</tt>, which should create `out` with the pixels of the given tile, see mousetrap::TiledImage::get_tile_region. Invoked concurrently on worker threads
+            /// @param data arbitrary data
+            template<typename Function_t, typename Data_t>
+            void create(uint64_t width, uint64_t height, Function_t f, Data_t data);
+
+            /// @brief create with a custom tile decoder, for example one reading a tiled file format region by region. This is the only way to open images that do not fit into memory
+            /// @param width width at full resolution
+            /// @param height height at full resolution
+            /// @param f function with signature <tt>(uint64_t level, uint64_t tile_x, uint64_t tile_y, Image& out) -> bool</tt>, which should create `out` with the pixels of the given tile, see mousetrap::TiledImage::get_tile_region. Invoked concurrently on worker threads
+            template<typename Function_t>
+            void create(uint64_t width, uint64_t height, Function_t f);
+
+            /// @brief create from an image file. GdkPixbuf cannot decode parts of a file, so each level is decoded whole, at most once, the first time one of its tiles is requested, and kept until the image is created again. Files whose levels together exceed the memory budget at 4 bytes per pixel are rejected. For images that do not fit into memory, use mousetrap::TiledImage::create with a decoder for a tiled format instead
+            /// @param path
+            /// @return true if the file could be opened and fits into the memory budget, false otherwise
+            bool create_from_file(const std::string& path);
+
+            /// @brief create from an image in memory, all levels are computed immediately
+            /// @param image
+            void create_from_image(const Image& image);
+
+            /// @brief get number of levels
+            /// @return n, level n - 1 is the first that fits into a single tile
+            uint64_t get_n_levels() const;
+
+            /// @brief get size of a level
+            /// @param level
+            /// @return width and height, in pixels
+            Vector2ui get_size(uint64_t level = 0) const;
+
+            /// @brief get number of tiles of a level
+            /// @param level
+            /// @return number of tiles along x and y
+            Vector2ui get_n_tiles(uint64_t level) const;
+
+            /// @brief get region of a level covered by a tile, tiles at the right and bottom edge may be smaller than mousetrap::TiledImage::tile_size
+            /// @param level
+            /// @param tile_x
+            /// @param tile_y
+            /// @return rectangle, in pixels of the level
+            Rectangle get_tile_region(uint64_t level, uint64_t tile_x, uint64_t tile_y) const;
+
+            /// @brief get a decoded tile, marking it as recently used
+            /// @param level
+            /// @param tile_x
+            /// @param tile_y
+            /// @return pointer to the tile, valid until the next call to any non-const function of this object. nullptr if the tile is not decoded yet
+            const Image* get_tile(uint64_t level, uint64_t tile_x, uint64_t tile_y);
+
+            /// @brief request a tile to be decoded in the background, does nothing if the tile is already decoded or requested
+            /// @param level
+            /// @param tile_x
+            /// @param tile_y
+            void request_tile(uint64_t level, uint64_t tile_x, uint64_t tile_y);
+
+            /// @brief drop all requests that were not started yet, for example after the view jumped to a different region
+            void clear_requests();
+
+            /// @brief set maximum number of bytes of decoded tiles kept in memory, least recently used tiles are evicted once it is exceeded
+            /// @param n_bytes
+            void set_memory_budget(uint64_t n_bytes);
+
+            /// @brief get maximum number of bytes of decoded tiles kept in memory
+            /// @return number of bytes, 256 MiB by default
+            uint64_t get_memory_budget() const;
+
+            /// @brief get number of bytes of decoded tiles currently kept in memory
+            /// @return number of bytes
+            uint64_t get_memory_usage() const;
+
+        private:
+            void create_impl(uint64_t width, uint64_t height, std::function<bool(uint64_t, uint64_t, uint64_t, Image&)>);
+
+            detail::TiledImageInternal* _internal = nullptr;
+    };
+}
+
+#include "inline/tiled_image.hpp"
@@ -0,0 +1,108 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/18/26
+//
+
+#pragma once
+
+#include <mousetrap/gl_common.hpp>
+#if MOUSETRAP_ENABLE_OPENGL_COMPONENT
+
+#include <mousetrap/render_area.hpp>
+#include <mousetrap/tiled_image.hpp>
+#include <mousetrap/texture.hpp>
+
+namespace mousetrap
+{
+    #ifndef DOXYGEN
+    namespace detail
+    {
+        struct _TiledImageDisplayInternal
+        {
+            GObject parent;
+
+            GtkGLArea* native;
+            TiledImageInternal* image;
+            uint64_t image_generation;
+
+            // all resident tiles share one texture, such that the entire view is a single draw call. nullptr until the first tile is uploaded, grown to the number of tiles the view needs
+            Texture* atlas;
+            uint64_t atlas_n_slots_per_row;
+            std::vector<uint64_t>* slot_keys;
+            std::vector<uint64_t>* slot_last_used;
+            std::unordered_map<uint64_t, uint64_t>* key_to_slot;
+            uint64_t frame;
+
+            // id of the idle source that continues uploading once the per-update limit was reached, 0 if none is pending
+            guint pending_update;
+
+            Shape* shape;
+            RenderTask* task;
+
+            // center in pixels of level 0, zoom in widget pixels per pixel of level 0
+            Vector2f center;
+            float zoom;
+
+            Vector2f drag_start_center;
+            Vector2f cursor_position;
+
+            GtkGestureDrag* drag;
+            GtkEventControllerScroll* scroll;
+            GtkEventControllerMotion* motion;
+        };
+        using TiledImageDisplayInternal = _TiledImageDisplayInternal;
+    }
+    #endif
+
+    /// @brief widget that displays a mousetrap::TiledImage, only the tiles of the level of detail matching the current zoom that are visible are decoded and uploaded. Tiles that are not decoded yet are drawn from a coarser level in the meantime. Supports panning by dragging and zooming using the scroll wheel
+    class TiledImageDisplay : public RenderArea
+    {
+        public:
+            /// @brief construct, displays nothing until mousetrap::TiledImageDisplay::set_tiled_image was called
+            TiledImageDisplay();
+
+            /// @brief destructor
+            ~TiledImageDisplay();
+
+            /// @brief set image to display, resets the view such that the entire image is visible
+            /// @param image tiled image, kept alive by this widget
+            void set_tiled_image(const TiledImage& image);
+
+            /// @brief set center and zoom of the view
+            /// @param center pixel of the full-resolution image that is displayed at the center of the widget
+            /// @param zoom number of widget pixels per pixel of the full-resolution image
+            void set_view(Vector2f center, float zoom);
+
+            /// @brief get center of the view
+            /// @return pixel of the full-resolution image at the center of the widget
+            Vector2f get_view_center() const;
+
+            /// @brief get zoom of the view
+            /// @return number of widget pixels per pixel of the full-resolution image
+            float get_zoom() const;
+
+            /// @brief move the view
+            /// @param offset offset in widget pixels
+            void pan(Vector2f offset);
+
+            /// @brief zoom, keeping the image pixel below a widget position in place
+            /// @param factor factor the current zoom is multiplied with
+            /// @param anchor position in widget pixels, for example the cursor position
+            void zoom(float factor, Vector2f anchor);
+
+            /// @brief resize the view such that the entire image is visible
+            void fit_to_widget();
+
+        private:
+            static void update(detail::TiledImageDisplayInternal*);
+            static gboolean on_pending_update(detail::TiledImageDisplayInternal*);
+            static void on_resize(GtkGLArea*, gint width, gint height, detail::TiledImageDisplayInternal*);
+            static void on_drag_begin(GtkGestureDrag*, double x, double y, detail::TiledImageDisplayInternal*);
+            static void on_drag_update(GtkGestureDrag*, double x, double y, detail::TiledImageDisplayInternal*);
+            static gboolean on_scroll(GtkEventControllerScroll*, double dx, double dy, detail::TiledImageDisplayInternal*);
+            static void on_motion(GtkEventControllerMotion*, double x, double y, detail::TiledImageDisplayInternal*);
+
+            detail::TiledImageDisplayInternal* _display_internal = nullptr;
+    };
+}
+
+#endif // MOUSETRAP_ENABLE_OPENGL_COMPONENT
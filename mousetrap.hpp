@@ -39,6 +39,15 @@
 #include <mousetrap/icon.hpp>
 #include <mousetrap/image.hpp>
 #include <mousetrap/image_display.hpp>
+#include <mousetrap/immediate_draw.hpp>
+#include <mousetrap/glyph_atlas.hpp>
+#include <mousetrap/text_shape.hpp>
+#include <mousetrap/post_process_chain.hpp>
+#include <mousetrap/render_graph.hpp>
+#include <mousetrap/render_command_list.hpp>
+#include <mousetrap/tiled_image.hpp>
+#include <mousetrap/tiled_image_display.hpp>
+#include <mousetrap/image_cache.hpp>
 #include <mousetrap/justify_mode.hpp>
 #include <mousetrap/key_event_controller.hpp>
 #include <mousetrap/key_file.hpp>
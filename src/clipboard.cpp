@@ -24,6 +24,59 @@ namespace mousetrap::detail
 
         return self;
     }
+
+    struct ClipboardImageTask
+    {
+        GdkTexture* texture = nullptr;
+        Image image;
+    };
+
+    static void clipboard_image_task_free(ClipboardImageTask* self)
+    {
+        if (self->texture != nullptr)
+            g_object_unref(self->texture);
+
+        delete self;
+    }
+
+    static void clipboard_image_task_run(GTask* task, gpointer, ClipboardImageTask* self, GCancellable*)
+    {
+        if (self->texture == nullptr)
+        {
+            g_task_return_boolean(task, false);
+            return;
+        }
+
+        const uint64_t width = gdk_texture_get_width(self->texture);
+        const uint64_t height = gdk_texture_get_height(self->texture);
+        self->image.create(width, height);
+
+        // download straight into the image, then convert each row in place
+        auto* pixels = static_cast<uint8_t*>(self->image.data());
+        const uint64_t rowstride = self->image.get_rowstride();
+        gdk_texture_download(self->texture, pixels, rowstride);
+
+        image_parallel_for_rows(height, width * 4, [&](uint64_t y, uint64_t){
+            convert_row_from_argb32_premultiplied(pixels + y * rowstride, pixels + y * rowstride, width);
+        });
+
+        g_task_return_boolean(task, true);
+    }
+
+    static void clipboard_image_task_finish(GObject* object, GAsyncResult* result, gpointer)
+    {
+        auto* instance = MOUSETRAP_CLIPBOARD_INTERNAL(object);
+        auto* self = (ClipboardImageTask*) g_task_get_task_data(G_TASK(result));
+        g_task_propagate_boolean(G_TASK(result), nullptr);
+
+        if (instance->get_image_f != nullptr)
+        {
+            auto temp = Clipboard(instance);
+            instance->get_image_f(temp, self->image);
+        }
+        else
+            log::critical("In Clipboard::get_image_callback_wrapper: Image succesfully read but no valid handler function is available", MOUSETRAP_DOMAIN);
+    }
 }
 
 namespace mousetrap
@@ -105,6 +158,12 @@ namespace mousetrap
 
     void Clipboard::set_image(const Image& image)
     {
+        if (image.get_format() != ImageFormat::RGBA8)
+        {
+            set_image(image.as_format(ImageFormat::RGBA8));
+            return;
+        }
+
         auto* pixbuf = image.operator GdkPixbuf*();
         auto* texture = gdk_texture_new_for_pixbuf(pixbuf);
         gdk_clipboard_set_texture(_internal->native, texture);
@@ -120,44 +179,16 @@ namespace mousetrap
         GError* error = nullptr;
         auto* texture = gdk_clipboard_read_texture_finish(GDK_CLIPBOARD(clipboard), result, &error);
 
-        auto* instance = (detail::ClipboardInternal*) self;
-        auto image = Image();
-
+        auto* task_data = new detail::ClipboardImageTask();
         if (error == nullptr)
-        {
-            auto size = Vector2ui(gdk_texture_get_width(texture), gdk_texture_get_height(texture));
-
-            // FORMAT: ARGB32, c.f. https://docs.gtk.org/gdk4/method.Texture.download.html
-
-            auto* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, gdk_texture_get_width(texture), gdk_texture_get_height(texture));
-            gdk_texture_download(texture, cairo_image_surface_get_data(surface), cairo_image_surface_get_stride(surface));
-
-            auto* data = cairo_image_surface_get_data(surface);
-            auto format = cairo_image_surface_get_format(surface);
-
-            image.create(size.x, size.y);
-            for (uint64_t i = 0; i < size.x * size.y * 4; i = i + 4)
-            {
-                guchar b = data[i + 0];
-                guchar g = data[i + 1];
-                guchar r = data[i + 2];
-                guchar a = data[i + 3];
-
-                image.set_pixel(i / 4, RGBA(r / 255.f, g / 255.f, b / 255.f, a / 255.f));
-            }
-
-            cairo_surface_mark_dirty(surface);
-            g_free(surface);
-        }
+            task_data->texture = texture;
         else
             g_error_free(error);
 
-        if (instance->get_image_f != nullptr)
-        {
-            auto temp = Clipboard(instance);
-            instance->get_image_f(temp, image);
-        }
-        else
-            log::critical("In Clipboard::get_image_callback_wrapper: Image succesfully read but no valid handler function is available", MOUSETRAP_DOMAIN);
+        // GTask keeps a reference to the internal until clipboard_image_task_finish ran
+        auto* task = g_task_new(G_OBJECT(self), nullptr, (GAsyncReadyCallback) detail::clipboard_image_task_finish, nullptr);
+        g_task_set_task_data(task, task_data, (GDestroyNotify) detail::clipboard_image_task_free);
+        g_task_run_in_thread(task, (GTaskThreadFunc) detail::clipboard_image_task_run);
+        g_object_unref(task);
     }
-}
\ No newline at end of file
+}
@@ -6,11 +6,19 @@
 #include <mousetrap/vector.hpp>
 #include <mousetrap/color.hpp>
 #include <mousetrap/log.hpp>
+#include <mousetrap/thread_pool.hpp>
 
 #include <sstream>
 #include <iostream>
 #include <cctype>
 #include <vector>
+#include <algorithm>
+
+#if defined(__AVX__)
+    #include <immintrin.h>
+#elif defined(__SSE2__) or defined(_M_X64)
+    #include <emmintrin.h>
+#endif
 
 namespace mousetrap
 {
@@ -41,7 +49,7 @@ namespace mousetrap
         r = out[0];
         g = out[1];
         b = out[2];
-        a = out[4];
+        a = out[3];
     }
 
     bool RGBA::operator==(const RGBA& other)
@@ -516,4 +524,239 @@ namespace mousetrap
     {
         return in.operator RGBA();
     }
+
+    namespace detail
+    {
+        // all kernels convert four colors at a time, the scalar versions perform the exact same operations, such that results do not depend on the position in the buffer
+
+        static void rgba_to_hsva_scalar(const float* in, float* out)
+        {
+            const float r = in[0], g = in[1], b = in[2];
+            const float max = std::max(std::max(r, g), b);
+            const float min = std::min(std::min(r, g), b);
+            const float delta = max - min;
+            const float inverse_delta = 1.f / delta;
+
+            float h;
+            if (max == r)
+                h = (g - b) * inverse_delta;
+            else if (max == g)
+                h = (b - r) * inverse_delta + 2.f;
+            else
+                h = (r - g) * inverse_delta + 4.f;
+
+            h = h * 60.f;
+            if (h < 0.f)
+                h = h + 360.f;
+
+            out[0] = delta == 0.f ? 0.f : h / 360.f;
+            out[1] = max == 0.f ? 1.f : delta / max;
+            out[2] = max;
+            out[3] = in[3];
+        }
+
+        static void hsva_to_rgba_scalar(const float* in, float* out)
+        {
+            const float h = in[0] * 6.f;
+            const float v = in[2];
+            const float c = v * in[1];
+
+            // channel = v - c * clamp(min(k, 4 - k), 0, 1) with k = (n + h) mod 6, n being 5, 3, 1 for red, green, blue
+            auto channel = [&](float n) -> float {
+                float k = n + h;
+                k = k - 6.f * float(int32_t(k / 6.f));
+                return v - c * std::max(0.f, std::min(std::min(k, 4.f - k), 1.f));
+            };
+
+            out[0] = channel(5.f);
+            out[1] = channel(3.f);
+            out[2] = channel(1.f);
+            out[3] = in[3];
+        }
+
+        static void quantize_scalar(const float* in, float* out, uint64_t n_values, float n_values_per_component)
+        {
+            for (uint64_t i = 0; i < n_values; ++i)
+                out[i] = float(int32_t(in[i] * n_values_per_component)) / n_values_per_component;
+        }
+
+        #if defined(__SSE2__) or defined(_M_X64) or defined(__AVX__)
+
+        static inline __m128 color_select(__m128 mask, __m128 if_true, __m128 if_false)
+        {
+            return _mm_or_ps(_mm_and_ps(mask, if_true), _mm_andnot_ps(mask, if_false));
+        }
+
+        static void rgba_to_hsva_sse(const float* in, float* out)
+        {
+            // transpose four colors into one register per component
+            __m128 r = _mm_loadu_ps(in + 0);
+            __m128 g = _mm_loadu_ps(in + 4);
+            __m128 b = _mm_loadu_ps(in + 8);
+            __m128 a = _mm_loadu_ps(in + 12);
+            _MM_TRANSPOSE4_PS(r, g, b, a);
+
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 max = _mm_max_ps(_mm_max_ps(r, g), b);
+            const __m128 min = _mm_min_ps(_mm_min_ps(r, g), b);
+            const __m128 delta = _mm_sub_ps(max, min);
+            const __m128 inverse_delta = _mm_div_ps(_mm_set1_ps(1.f), delta);
+
+            // evaluate all three hue sectors, then pick one, with red taking precedence over green over blue
+            const __m128 h_r = _mm_mul_ps(_mm_sub_ps(g, b), inverse_delta);
+            const __m128 h_g = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(b, r), inverse_delta), _mm_set1_ps(2.f));
+            const __m128 h_b = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(r, g), inverse_delta), _mm_set1_ps(4.f));
+
+            __m128 h = color_select(_mm_cmpeq_ps(max, g), h_g, h_b);
+            h = color_select(_mm_cmpeq_ps(max, r), h_r, h);
+            h = _mm_mul_ps(h, _mm_set1_ps(60.f));
+            h = _mm_add_ps(h, _mm_and_ps(_mm_cmplt_ps(h, zero), _mm_set1_ps(360.f)));
+
+            // gray has no hue, the nan produced by dividing by delta = 0 is masked out
+            h = _mm_andnot_ps(_mm_cmpeq_ps(delta, zero), _mm_div_ps(h, _mm_set1_ps(360.f)));
+            __m128 s = color_select(_mm_cmpeq_ps(max, zero), _mm_set1_ps(1.f), _mm_div_ps(delta, max));
+            __m128 v = max;
+
+            _MM_TRANSPOSE4_PS(h, s, v, a);
+            _mm_storeu_ps(out + 0, h);
+            _mm_storeu_ps(out + 4, s);
+            _mm_storeu_ps(out + 8, v);
+            _mm_storeu_ps(out + 12, a);
+        }
+
+        static void hsva_to_rgba_sse(const float* in, float* out)
+        {
+            __m128 h = _mm_loadu_ps(in + 0);
+            __m128 s = _mm_loadu_ps(in + 4);
+            __m128 v = _mm_loadu_ps(in + 8);
+            __m128 a = _mm_loadu_ps(in + 12);
+            _MM_TRANSPOSE4_PS(h, s, v, a);
+
+            h = _mm_mul_ps(h, _mm_set1_ps(6.f));
+            const __m128 c = _mm_mul_ps(v, s);
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 one = _mm_set1_ps(1.f);
+            const __m128 four = _mm_set1_ps(4.f);
+            const __m128 six = _mm_set1_ps(6.f);
+
+            auto channel = [&](float n) -> __m128 {
+                __m128 k = _mm_add_ps(_mm_set1_ps(n), h);
+                k = _mm_sub_ps(k, _mm_mul_ps(six, _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_div_ps(k, six)))));
+                __m128 f = _mm_max_ps(zero, _mm_min_ps(_mm_min_ps(k, _mm_sub_ps(four, k)), one));
+                return _mm_sub_ps(v, _mm_mul_ps(c, f));
+            };
+
+            __m128 r = channel(5.f);
+            __m128 g = channel(3.f);
+            __m128 b = channel(1.f);
+
+            _MM_TRANSPOSE4_PS(r, g, b, a);
+            _mm_storeu_ps(out + 0, r);
+            _mm_storeu_ps(out + 4, g);
+            _mm_storeu_ps(out + 8, b);
+            _mm_storeu_ps(out + 12, a);
+        }
+
+        #endif
+
+        // invoke f(begin, end) on blocks of colors, blocks are distributed across the thread pool once there is more than one
+        static void color_parallel_for(uint64_t n, const std::function<void(uint64_t, uint64_t)>& f)
+        {
+            constexpr uint64_t block_size = 1 << 14;
+            if (n <= block_size)
+            {
+                f(0, n);
+                return;
+            }
+
+            const uint64_t n_blocks = (n + block_size - 1) / block_size;
+            thread_pool_parallel_for(thread_pool_get_default(), n_blocks, [&](uint64_t block_i, uint64_t){
+                f(block_i * block_size, std::min(n, (block_i + 1) * block_size));
+            });
+        }
+
+        static_assert(sizeof(RGBA) == 4 * sizeof(float) and sizeof(HSVA) == 4 * sizeof(float));
+    }
+
+    void rgba_to_hsva(const RGBA* in, HSVA* out, uint64_t n)
+    {
+        const auto* in_data = reinterpret_cast<const float*>(in);
+        auto* out_data = reinterpret_cast<float*>(out);
+
+        detail::color_parallel_for(n, [&](uint64_t begin, uint64_t end){
+            uint64_t i = begin;
+
+            #if defined(__SSE2__) or defined(_M_X64) or defined(__AVX__)
+            for (; i + 4 <= end; i += 4)
+                detail::rgba_to_hsva_sse(in_data + 4 * i, out_data + 4 * i);
+            #endif
+
+            for (; i < end; ++i)
+                detail::rgba_to_hsva_scalar(in_data + 4 * i, out_data + 4 * i);
+        });
+    }
+
+    void hsva_to_rgba(const HSVA* in, RGBA* out, uint64_t n)
+    {
+        const auto* in_data = reinterpret_cast<const float*>(in);
+        auto* out_data = reinterpret_cast<float*>(out);
+
+        detail::color_parallel_for(n, [&](uint64_t begin, uint64_t end){
+            uint64_t i = begin;
+
+            #if defined(__SSE2__) or defined(_M_X64) or defined(__AVX__)
+            for (; i + 4 <= end; i += 4)
+                detail::hsva_to_rgba_sse(in_data + 4 * i, out_data + 4 * i);
+            #endif
+
+            for (; i < end; ++i)
+                detail::hsva_to_rgba_scalar(in_data + 4 * i, out_data + 4 * i);
+        });
+    }
+
+    std::vector<HSVA> rgba_to_hsva(const std::vector<RGBA>& in)
+    {
+        auto out = std::vector<HSVA>(in.size());
+        rgba_to_hsva(in.data(), out.data(), in.size());
+        return out;
+    }
+
+    std::vector<RGBA> hsva_to_rgba(const std::vector<HSVA>& in)
+    {
+        auto out = std::vector<RGBA>(in.size());
+        hsva_to_rgba(in.data(), out.data(), in.size());
+        return out;
+    }
+
+    namespace detail
+    {
+        static void quantize_buffer(const float* in, float* out, uint64_t n_colors, uint64_t n_values_per_component)
+        {
+            const float n_values = float(n_values_per_component);
+            color_parallel_for(n_colors, [&](uint64_t begin, uint64_t end){
+                uint64_t i = 4 * begin;
+
+                #if defined(__SSE2__) or defined(_M_X64) or defined(__AVX__)
+                const __m128 scale = _mm_set1_ps(n_values);
+                for (; i + 4 <= 4 * end; i += 4)
+                {
+                    __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(in + i), scale)));
+                    _mm_storeu_ps(out + i, _mm_div_ps(truncated, scale));
+                }
+                #endif
+
+                quantize_scalar(in + i, out + i, 4 * end - i, n_values);
+            });
+        }
+    }
+
+    void quantize(const RGBA* in, RGBA* out, uint64_t n, uint64_t n_values_per_component)
+    {
+        detail::quantize_buffer(reinterpret_cast<const float*>(in), reinterpret_cast<float*>(out), n, n_values_per_component);
+    }
+
+    void quantize(const HSVA* in, HSVA* out, uint64_t n, uint64_t n_values_per_component)
+    {
+        detail::quantize_buffer(reinterpret_cast<const float*>(in), reinterpret_cast<float*>(out), n, n_values_per_component);
+    }
 }
@@ -8,6 +8,12 @@
 
 #include <mousetrap/gl_transform.hpp>
 
+#if defined(__AVX__)
+    #include <immintrin.h>
+#elif defined(__SSE2__) or defined(_M_X64)
+    #include <emmintrin.h>
+#endif
+
 namespace mousetrap
 {
     GLTransform::GLTransform()
@@ -54,6 +60,118 @@ namespace mousetrap
     {
         transform = glm::mat4x4(1);
     }
+
+    namespace detail
+    {
+        static inline const float* offset_by_stride(const float* base, uint64_t stride, uint64_t i)
+        {
+            return (const float*) ((const char*) base + i * stride);
+        }
+
+        static inline float* offset_by_stride(float* base, uint64_t stride, uint64_t i)
+        {
+            return (float*) ((char*) base + i * stride);
+        }
+    }
+
+    void detail::apply_transform_to_positions(const glm::mat4x4& transform, const float* in, uint64_t in_stride, float* out, uint64_t out_stride, float* mirror, uint64_t mirror_stride, uint64_t n)
+    {
+        // strides are in bytes, positions are read fully before anything is written, so in == out is safe
+        const float* m = &transform[0][0];
+        uint64_t i = 0;
+
+        #if defined(__SSE2__) or defined(_M_X64) or defined(__AVX__)
+
+        auto store_xyz = [](float* destination, __m128 value) {
+            _mm_storel_pi((__m64*) destination, value);
+            _mm_store_ss(destination + 2, _mm_movehl_ps(value, value));
+        };
+
+        #if defined(__AVX__)
+
+        // two positions per iteration, low lane is position i, high lane is position i+1
+        const __m256 column_0 = _mm256_broadcast_ps((const __m128*) (m + 0));
+        const __m256 column_1 = _mm256_broadcast_ps((const __m128*) (m + 4));
+        const __m256 column_2 = _mm256_broadcast_ps((const __m128*) (m + 8));
+        const __m256 column_3 = _mm256_broadcast_ps((const __m128*) (m + 12));
+
+        for (; i + 1 < n; i += 2)
+        {
+            const float* a = offset_by_stride(in, in_stride, i);
+            const float* b = offset_by_stride(in, in_stride, i + 1);
+
+            __m256 x = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(a[0])), _mm_set1_ps(b[0]), 1);
+            __m256 y = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(a[1])), _mm_set1_ps(b[1]), 1);
+            __m256 z = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(a[2])), _mm_set1_ps(b[2]), 1);
+
+            __m256 result = _mm256_add_ps(
+                _mm256_add_ps(_mm256_mul_ps(column_0, x), _mm256_mul_ps(column_1, y)),
+                _mm256_add_ps(_mm256_mul_ps(column_2, z), column_3)
+            );
+
+            __m128 low = _mm256_castps256_ps128(result);
+            __m128 high = _mm256_extractf128_ps(result, 1);
+
+            store_xyz(offset_by_stride(out, out_stride, i), low);
+            store_xyz(offset_by_stride(out, out_stride, i + 1), high);
+
+            if (mirror != nullptr)
+            {
+                store_xyz(offset_by_stride(mirror, mirror_stride, i), low);
+                store_xyz(offset_by_stride(mirror, mirror_stride, i + 1), high);
+            }
+        }
+
+        #endif
+
+        // one position per iteration: out = c0 * x + c1 * y + c2 * z + c3
+        const __m128 c0 = _mm_loadu_ps(m + 0);
+        const __m128 c1 = _mm_loadu_ps(m + 4);
+        const __m128 c2 = _mm_loadu_ps(m + 8);
+        const __m128 c3 = _mm_loadu_ps(m + 12);
+
+        for (; i < n; ++i)
+        {
+            const float* p = offset_by_stride(in, in_stride, i);
+
+            __m128 result = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(p[0])), _mm_mul_ps(c1, _mm_set1_ps(p[1]))),
+                _mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(p[2])), c3)
+            );
+
+            store_xyz(offset_by_stride(out, out_stride, i), result);
+
+            if (mirror != nullptr)
+                store_xyz(offset_by_stride(mirror, mirror_stride, i), result);
+        }
+
+        #else
+
+        for (; i < n; ++i)
+        {
+            const float* p = offset_by_stride(in, in_stride, i);
+            const float x = p[0], y = p[1], z = p[2];
+
+            float result[3];
+            for (uint64_t row = 0; row < 3; ++row)
+                result[row] = m[0 + row] * x + m[4 + row] * y + m[8 + row] * z + m[12 + row];
+
+            float* o = offset_by_stride(out, out_stride, i);
+            o[0] = result[0];
+            o[1] = result[1];
+            o[2] = result[2];
+
+            if (mirror != nullptr)
+            {
+                float* mo = offset_by_stride(mirror, mirror_stride, i);
+                mo[0] = result[0];
+                mo[1] = result[1];
+                mo[2] = result[2];
+            }
+        }
+
+        #endif
+    }
 }
 
 #endif // MOUSETRAP_ENABLE_OPENGL_COMPONENT
\ No newline at end of file
@@ -0,0 +1,308 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/18/26
+//
+
+#include <mousetrap/gl_common.hpp>
+#if MOUSETRAP_ENABLE_OPENGL_COMPONENT
+
+#include <mousetrap/glyph_atlas.hpp>
+#include <mousetrap/log.hpp>
+
+#include <pango/pangocairo.h>
+#include <cmath>
+
+namespace mousetrap
+{
+    namespace detail
+    {
+        DECLARE_NEW_TYPE(GlyphAtlasInternal, glyph_atlas_internal, GLYPH_ATLAS_INTERNAL)
+
+        static void glyph_atlas_internal_finalize(GObject* object)
+        {
+            auto* self = MOUSETRAP_GLYPH_ATLAS_INTERNAL(object);
+            G_OBJECT_CLASS(glyph_atlas_internal_parent_class)->finalize(object);
+
+            if (detail::is_opengl_disabled())
+                return;
+
+            for (auto* font : *self->fonts)
+                g_object_unref(font);
+
+            delete self->fonts;
+            delete self->glyphs;
+            delete self->texture;
+
+            pango_font_description_free(self->font);
+            g_object_unref(self->context);
+        }
+
+        DEFINE_NEW_TYPE_TRIVIAL_INIT(GlyphAtlasInternal, glyph_atlas_internal, GLYPH_ATLAS_INTERNAL)
+        DEFINE_NEW_TYPE_TRIVIAL_CLASS_INIT(GlyphAtlasInternal, glyph_atlas_internal, GLYPH_ATLAS_INTERNAL)
+
+        static GlyphAtlasInternal* glyph_atlas_internal_new(const std::string& font_description, Vector2i size)
+        {
+            auto* self = (GlyphAtlasInternal*) g_object_new(glyph_atlas_internal_get_type(), nullptr);
+            glyph_atlas_internal_init(self);
+
+            self->context = pango_font_map_create_context(pango_cairo_font_map_get_default());
+            self->font = pango_font_description_from_string(font_description.c_str());
+            self->fonts = new std::set<PangoFont*>();
+            self->glyphs = new std::map<std::pair<PangoFont*, PangoGlyph>, GlyphInfo>();
+            self->size = size;
+
+            detail::make_opengl_context_current();
+
+            // allocate as RGBA8 instead of Texture::create's RGBA16F, the atlas only ever receives 8-bit coverage
+            self->texture = new Texture();
+            auto* texture_internal = (TextureInternal*) self->texture->get_internal();
+
+            auto zeros = std::vector<uint8_t>(size.x * size.y * 4, 0);
+            glActiveTexture(GL_TEXTURE0 + 0);
+            glBindTexture(GL_TEXTURE_2D, texture_internal->native_handle);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size.x, size.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, zeros.data());
+            glBindTexture(GL_TEXTURE_2D, 0);
+
+            *texture_internal->size = size;
+            self->texture->set_scale_mode(TextureScaleMode::LINEAR);
+
+            return self;
+        }
+
+        static const GlyphInfo* glyph_atlas_get_glyph(GlyphAtlasInternal* self, PangoFont* font, PangoGlyph glyph)
+        {
+            auto key = std::make_pair(font, glyph);
+            auto it = self->glyphs->find(key);
+            if (it != self->glyphs->end())
+                return &it->second;
+
+            if (self->fonts->insert(font).second)
+                g_object_ref(font);
+
+            PangoRectangle ink;
+            pango_font_get_glyph_extents(font, glyph, &ink, nullptr);
+
+            // 1 px padding on all sides, so linear filtering never samples a neighbouring glyph
+            int x0 = std::floor(ink.x / float(PANGO_SCALE)) - 1;
+            int y0 = std::floor(ink.y / float(PANGO_SCALE)) - 1;
+            int x1 = std::ceil((ink.x + ink.width) / float(PANGO_SCALE)) + 1;
+            int y1 = std::ceil((ink.y + ink.height) / float(PANGO_SCALE)) + 1;
+
+            auto info = GlyphInfo{{0, 0}, {x1 - x0, y1 - y0}, {x0, y0}};
+
+            // whitespace, nothing to rasterize
+            if (ink.width == 0 or ink.height == 0)
+            {
+                info.size = {0, 0};
+                return &self->glyphs->insert({key, info}).first->second;
+            }
+
+            if (self->shelf_x + info.size.x > self->size.x)
+            {
+                self->shelf_x = 0;
+                self->shelf_y += self->shelf_height;
+                self->shelf_height = 0;
+            }
+
+            if (info.size.x > self->size.x or self->shelf_y + info.size.y > self->size.y)
+            {
+                if (not self->is_full)
+                    log::critical("In GlyphAtlas: atlas of size " + std::to_string(self->size.x) + "x" + std::to_string(self->size.y) + " is full, glyphs that are not yet rasterized will not be rendered", MOUSETRAP_DOMAIN);
+
+                self->is_full = true;
+                info.size = {0, 0};
+                return &self->glyphs->insert({key, info}).first->second;
+            }
+
+            info.atlas_position = {self->shelf_x, self->shelf_y};
+            self->shelf_x += info.size.x;
+            self->shelf_height = std::max(self->shelf_height, info.size.y);
+
+            auto* surface = cairo_image_surface_create(CAIRO_FORMAT_A8, info.size.x, info.size.y);
+            auto* cr = cairo_create(surface);
+
+            auto* glyph_string = pango_glyph_string_new();
+            pango_glyph_string_set_size(glyph_string, 1);
+            glyph_string->glyphs[0].glyph = glyph;
+            glyph_string->glyphs[0].geometry.width = 0;
+            glyph_string->glyphs[0].geometry.x_offset = 0;
+            glyph_string->glyphs[0].geometry.y_offset = 0;
+
+            cairo_set_source_rgba(cr, 1, 1, 1, 1);
+            cairo_move_to(cr, -x0, -y0);
+            pango_cairo_show_glyph_string(cr, font, glyph_string);
+            cairo_surface_flush(surface);
+
+            auto* data = cairo_image_surface_get_data(surface);
+            auto stride = cairo_image_surface_get_stride(surface);
+
+            auto rgba = std::vector<uint8_t>(info.size.x * info.size.y * 4);
+            for (int y = 0; y < info.size.y; ++y)
+            {
+                for (int x = 0; x < info.size.x; ++x)
+                {
+                    auto* out = rgba.data() + (y * info.size.x + x) * 4;
+                    out[0] = 255;
+                    out[1] = 255;
+                    out[2] = 255;
+                    out[3] = data[y * stride + x];
+                }
+            }
+
+            // only the new glyphs region is uploaded, the rest of the atlas stays untouched
+            glActiveTexture(GL_TEXTURE0 + 0);
+            glBindTexture(GL_TEXTURE_2D, self->texture->get_native_handle());
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, info.atlas_position.x, info.atlas_position.y, info.size.x, info.size.y, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+            glBindTexture(GL_TEXTURE_2D, 0);
+
+            pango_glyph_string_free(glyph_string);
+            cairo_destroy(cr);
+            cairo_surface_destroy(surface);
+
+            return &self->glyphs->insert({key, info}).first->second;
+        }
+
+        static PangoLayout* glyph_atlas_create_layout(GlyphAtlasInternal* self, const std::string& text)
+        {
+            auto* layout = pango_layout_new(self->context);
+            pango_layout_set_font_description(layout, self->font);
+            pango_layout_set_text(layout, text.c_str(), text.size());
+            return layout;
+        }
+
+        void glyph_atlas_layout(GlyphAtlasInternal* self, const std::string& text, std::vector<GlyphQuad>& out)
+        {
+            out.clear();
+
+            if (detail::is_opengl_disabled())
+                return;
+
+            detail::make_opengl_context_current();
+
+            auto* layout = glyph_atlas_create_layout(self, text);
+            auto* iter = pango_layout_get_iter(layout);
+            auto atlas_size = Vector2f(self->size.x, self->size.y);
+
+            do
+            {
+                auto* run = pango_layout_iter_get_run_readonly(iter);
+                if (run == nullptr)
+                    continue;
+
+                PangoRectangle logical;
+                pango_layout_iter_get_run_extents(iter, nullptr, &logical);
+                int baseline = pango_layout_iter_get_baseline(iter);
+                int x = logical.x;
+
+                auto* font = run->item->analysis.font;
+                for (int i = 0; i < run->glyphs->num_glyphs; ++i)
+                {
+                    auto& glyph = run->glyphs->glyphs[i];
+                    if (glyph.glyph != PANGO_GLYPH_EMPTY and not (glyph.glyph & PANGO_GLYPH_UNKNOWN_FLAG))
+                    {
+                        auto* info = glyph_atlas_get_glyph(self, font, glyph.glyph);
+                        if (info->size.x > 0 and info->size.y > 0)
+                        {
+                            auto origin = Vector2f(
+                                std::round((x + glyph.geometry.x_offset) / float(PANGO_SCALE)),
+                                std::round((baseline + glyph.geometry.y_offset) / float(PANGO_SCALE))
+                            );
+
+                            out.push_back(GlyphQuad{
+                                origin + Vector2f(info->bearing.x, info->bearing.y),
+                                Vector2f(info->size.x, info->size.y),
+                                Vector2f(info->atlas_position.x, info->atlas_position.y) / atlas_size,
+                                Vector2f(info->size.x, info->size.y) / atlas_size
+                            });
+                        }
+                    }
+
+                    x += glyph.geometry.width;
+                }
+            }
+            while (pango_layout_iter_next_run(iter));
+
+            pango_layout_iter_free(iter);
+            g_object_unref(layout);
+        }
+    }
+
+    GlyphAtlas::GlyphAtlas(const std::string& font_description, Vector2i atlas_size)
+    {
+        if (detail::is_opengl_disabled())
+        {
+            _internal = nullptr;
+            return;
+        }
+
+        _internal = detail::glyph_atlas_internal_new(font_description, atlas_size);
+        g_object_ref(_internal);
+    }
+
+    GlyphAtlas::GlyphAtlas(detail::GlyphAtlasInternal* internal)
+    {
+        if (detail::is_opengl_disabled())
+        {
+            _internal = nullptr;
+            return;
+        }
+
+        _internal = g_object_ref(internal);
+    }
+
+    GlyphAtlas::~GlyphAtlas()
+    {
+        if (not detail::is_opengl_disabled())
+            g_object_unref(_internal);
+    }
+
+    NativeObject GlyphAtlas::get_internal() const
+    {
+        if (detail::is_opengl_disabled())
+            return nullptr;
+
+        return G_OBJECT(_internal);
+    }
+
+    GlyphAtlas::operator NativeObject() const
+    {
+        return get_internal();
+    }
+
+    const Texture& GlyphAtlas::get_texture() const
+    {
+        if (detail::is_opengl_disabled())
+        {
+            // constructed while the OpenGL component is disabled, so it holds no internal
+            static const auto empty = Texture();
+            return empty;
+        }
+
+        return *_internal->texture;
+    }
+
+    uint64_t GlyphAtlas::get_n_glyphs() const
+    {
+        if (detail::is_opengl_disabled())
+            return 0;
+
+        return _internal->glyphs->size();
+    }
+
+    Vector2f GlyphAtlas::get_text_size(const std::string& text) const
+    {
+        if (detail::is_opengl_disabled())
+            return {0, 0};
+
+        auto* layout = detail::glyph_atlas_create_layout(_internal, text);
+
+        int width, height;
+        pango_layout_get_pixel_size(layout, &width, &height);
+        g_object_unref(layout);
+
+        return {width, height};
+    }
+}
+
+#endif // MOUSETRAP_ENABLE_OPENGL_COMPONENT
@@ -4,13 +4,290 @@
 //
 
 #include <mousetrap/image.hpp>
+#include <mousetrap/image_cache.hpp>
+#include <mousetrap/raw_image.hpp>
 #include <mousetrap/log.hpp>
+#include <mousetrap/thread_pool.hpp>
 
 #include <sstream>
 #include <iostream>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <mutex>
+#include <condition_variable>
+
+#if defined(__AVX__)
+    #include <immintrin.h>
+#elif defined(__SSE2__) or defined(_M_X64)
+    #include <emmintrin.h>
+#endif
 
 namespace mousetrap
 {
+    namespace detail
+    {
+        void convert_u8_to_f32(const uint8_t* in, float* out, uint64_t n)
+        {
+            uint64_t i = 0;
+
+            #if defined(__SSE2__) or defined(_M_X64) or defined(__AVX__)
+
+            // widen 16 bytes to 4x4 int32, then convert and scale
+            const __m128 scale = _mm_set1_ps(1.f / 255.f);
+            const __m128i zero = _mm_setzero_si128();
+            for (; i + 16 <= n; i += 16)
+            {
+                __m128i bytes = _mm_loadu_si128((const __m128i*) (in + i));
+                __m128i low = _mm_unpacklo_epi8(bytes, zero);
+                __m128i high = _mm_unpackhi_epi8(bytes, zero);
+
+                _mm_storeu_ps(out + i + 0, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(low, zero)), scale));
+                _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(low, zero)), scale));
+                _mm_storeu_ps(out + i + 8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(high, zero)), scale));
+                _mm_storeu_ps(out + i + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(high, zero)), scale));
+            }
+
+            #endif
+
+            for (; i < n; ++i)
+                out[i] = in[i] / 255.f;
+        }
+
+        void convert_f32_to_u8(const float* in, uint8_t* out, uint64_t n)
+        {
+            uint64_t i = 0;
+
+            #if defined(__SSE2__) or defined(_M_X64) or defined(__AVX__)
+
+            // cvtps rounds to nearest, the saturating packs clamp to [0, 255]
+            const __m128 scale = _mm_set1_ps(255.f);
+            for (; i + 16 <= n; i += 16)
+            {
+                __m128i a = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(in + i + 0), scale));
+                __m128i b = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(in + i + 4), scale));
+                __m128i c = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(in + i + 8), scale));
+                __m128i d = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(in + i + 12), scale));
+
+                __m128i result = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+                _mm_storeu_si128((__m128i*) (out + i), result);
+            }
+
+            #endif
+
+            for (; i < n; ++i)
+            {
+                // nan maps to 0, same as the vectorized path
+                float value = std::round(in[i] * 255.f);
+                out[i] = value >= 255.f ? 255 : (value > 0.f ? uint8_t(value) : 0);
+            }
+        }
+
+        void convert_row_to_rgba32f(const uint8_t* in, uint64_t n_channels, float* out, uint64_t n_pixels)
+        {
+            if (n_channels == 4)
+            {
+                convert_u8_to_f32(in, out, n_pixels * 4);
+                return;
+            }
+
+            for (uint64_t i = 0; i < n_pixels; ++i)
+            {
+                out[4 * i + 0] = in[n_channels * i + 0] / 255.f;
+                out[4 * i + 1] = in[n_channels * i + 1] / 255.f;
+                out[4 * i + 2] = in[n_channels * i + 2] / 255.f;
+                out[4 * i + 3] = 1;
+            }
+        }
+
+        void convert_row_from_rgba32f(const float* in, uint8_t* out, uint64_t n_channels, uint64_t n_pixels)
+        {
+            if (n_channels == 4)
+            {
+                convert_f32_to_u8(in, out, n_pixels * 4);
+                return;
+            }
+
+            uint8_t rgba[4];
+            for (uint64_t i = 0; i < n_pixels; ++i)
+            {
+                convert_f32_to_u8(in + 4 * i, rgba, 4);
+                out[n_channels * i + 0] = rgba[0];
+                out[n_channels * i + 1] = rgba[1];
+                out[n_channels * i + 2] = rgba[2];
+            }
+        }
+
+        void convert_row_from_argb32_premultiplied(const uint8_t* in, uint8_t* out, uint64_t n_pixels)
+        {
+            uint64_t i = 0;
+
+            #if defined(__SSE2__) or defined(_M_X64) or defined(__AVX__)
+
+            // x86 is little-endian, so each pixel is stored as b, g, r, a
+            const __m128 max = _mm_set1_ps(255.f);
+            const __m128 zero_f = _mm_setzero_ps();
+            const __m128 alpha_lane = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+            const __m128i zero = _mm_setzero_si128();
+
+            auto unpremultiply = [&](__m128i pixel) -> __m128i {
+                __m128 bgra = _mm_cvtepi32_ps(pixel);
+                __m128 alpha = _mm_shuffle_ps(bgra, bgra, _MM_SHUFFLE(3, 3, 3, 3));
+
+                // branchless: fully transparent pixels divide by 0, the resulting inf is masked to 0
+                __m128 scale = _mm_and_ps(_mm_div_ps(max, alpha), _mm_cmpgt_ps(alpha, zero_f));
+                __m128 color = _mm_mul_ps(bgra, scale);
+                __m128 result = _mm_or_ps(_mm_andnot_ps(alpha_lane, color), _mm_and_ps(alpha_lane, bgra));
+                return _mm_cvtps_epi32(_mm_shuffle_ps(result, result, _MM_SHUFFLE(3, 0, 1, 2)));
+            };
+
+            for (; i + 4 <= n_pixels; i += 4)
+            {
+                __m128i bytes = _mm_loadu_si128((const __m128i*) (in + 4 * i));
+                __m128i low = _mm_unpacklo_epi8(bytes, zero);
+                __m128i high = _mm_unpackhi_epi8(bytes, zero);
+
+                __m128i a = unpremultiply(_mm_unpacklo_epi16(low, zero));
+                __m128i b = unpremultiply(_mm_unpackhi_epi16(low, zero));
+                __m128i c = unpremultiply(_mm_unpacklo_epi16(high, zero));
+                __m128i d = unpremultiply(_mm_unpackhi_epi16(high, zero));
+
+                // saturating packs clamp rounding errors above 255
+                _mm_storeu_si128((__m128i*) (out + 4 * i), _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d)));
+            }
+
+            #endif
+
+            for (; i < n_pixels; ++i)
+            {
+                // native-endian 32-bit word, alpha in the highest byte
+                uint32_t pixel;
+                std::memcpy(&pixel, in + 4 * i, sizeof(uint32_t));
+
+                const uint8_t alpha = pixel >> 24;
+                const float scale = alpha == 0 ? 0.f : 255.f / float(alpha);
+                auto unpremultiply = [&](uint32_t value) -> uint8_t {
+                    return std::min<long>(255, std::lrint(float(value & 0xFF) * scale));
+                };
+
+                out[4 * i + 0] = unpremultiply(pixel >> 16);
+                out[4 * i + 1] = unpremultiply(pixel >> 8);
+                out[4 * i + 2] = unpremultiply(pixel);
+                out[4 * i + 3] = alpha;
+            }
+        }
+
+        uint64_t image_format_get_n_channels(ImageFormat format)
+        {
+            return format == ImageFormat::R8 or format == ImageFormat::R32F ? 1 : 4;
+        }
+
+        uint64_t image_format_get_value_size(ImageFormat format)
+        {
+            return format == ImageFormat::RGBA32F or format == ImageFormat::R32F ? sizeof(float) : 1;
+        }
+
+        void convert_row_to_rgba32f(const uint8_t* in, ImageFormat format, uint64_t n_channels, float* out, uint64_t n_pixels)
+        {
+            if (format == ImageFormat::RGBA8)
+                convert_row_to_rgba32f(in, n_channels, out, n_pixels);
+            else if (format == ImageFormat::RGBA32F)
+                std::memcpy(out, in, n_pixels * 4 * sizeof(float));
+            else if (format == ImageFormat::R32F)
+            {
+                const auto* values = reinterpret_cast<const float*>(in);
+                for (uint64_t i = 0; i < n_pixels; ++i)
+                {
+                    out[4 * i + 0] = values[i];
+                    out[4 * i + 1] = values[i];
+                    out[4 * i + 2] = values[i];
+                    out[4 * i + 3] = 1;
+                }
+            }
+            else
+            {
+                for (uint64_t i = 0; i < n_pixels; ++i)
+                {
+                    float value = in[i] / 255.f;
+                    out[4 * i + 0] = value;
+                    out[4 * i + 1] = value;
+                    out[4 * i + 2] = value;
+                    out[4 * i + 3] = 1;
+                }
+            }
+        }
+
+        void convert_row_from_rgba32f(const float* in, ImageFormat format, uint64_t n_channels, uint8_t* out, uint64_t n_pixels)
+        {
+            if (format == ImageFormat::RGBA8)
+                convert_row_from_rgba32f(in, out, n_channels, n_pixels);
+            else if (format == ImageFormat::RGBA32F)
+                std::memcpy(out, in, n_pixels * 4 * sizeof(float));
+            else if (format == ImageFormat::R32F)
+            {
+                auto* values = reinterpret_cast<float*>(out);
+                for (uint64_t i = 0; i < n_pixels; ++i)
+                    values[i] = in[4 * i];
+            }
+            else
+            {
+                for (uint64_t i = 0; i < n_pixels; ++i)
+                    convert_f32_to_u8(in + 4 * i, out + i, 1);
+            }
+        }
+
+        // convert pixels between any two formats, rows of the same format are copied as is
+        static void image_convert_row(const uint8_t* in, ImageFormat in_format, uint64_t in_n_channels, uint8_t* out, ImageFormat out_format, uint64_t out_n_channels, uint64_t n_pixels)
+        {
+            if (in_format == out_format and in_n_channels == out_n_channels)
+                std::memcpy(out, in, n_pixels * in_n_channels * image_format_get_value_size(in_format));
+            else if (in_format == ImageFormat::RGBA8 and out_format == ImageFormat::RGBA8)
+            {
+                for (uint64_t i = 0; i < n_pixels; ++i)
+                {
+                    out[out_n_channels * i + 0] = in[in_n_channels * i + 0];
+                    out[out_n_channels * i + 1] = in[in_n_channels * i + 1];
+                    out[out_n_channels * i + 2] = in[in_n_channels * i + 2];
+                    if (out_n_channels == 4)
+                        out[out_n_channels * i + 3] = 255;
+                }
+            }
+            else if (out_format == ImageFormat::RGBA32F)
+                convert_row_to_rgba32f(in, in_format, in_n_channels, reinterpret_cast<float*>(out), n_pixels);
+            else if (in_format == ImageFormat::RGBA32F)
+                convert_row_from_rgba32f(reinterpret_cast<const float*>(in), out_format, out_n_channels, out, n_pixels);
+            else
+            {
+                thread_local std::vector<float> rgba;
+                rgba.resize(n_pixels * 4);
+                convert_row_to_rgba32f(in, in_format, in_n_channels, rgba.data(), n_pixels);
+                convert_row_from_rgba32f(rgba.data(), out_format, out_n_channels, out, n_pixels);
+            }
+        }
+
+        void image_parallel_for_rows(uint64_t n_rows, uint64_t row_size, const std::function<void(uint64_t, uint64_t)>& f)
+        {
+            // at least 64 KiB per unit of work, such that small images do not pay for synchronization
+            uint64_t grain = std::max<uint64_t>(1, (uint64_t(1) << 16) / std::max<uint64_t>(1, row_size));
+            thread_pool_parallel_for(thread_pool_get_default(), n_rows, f, grain);
+        }
+
+        Image image_new_from_pixbuf(GdkPixbuf* pixbuf)
+        {
+            return Image(pixbuf);
+        }
+
+        GBytes* pixbuf_get_pixel_bytes(GdkPixbuf* pixbuf)
+        {
+            return g_bytes_new_with_free_func(
+                gdk_pixbuf_get_pixels(pixbuf),
+                gdk_pixbuf_get_byte_length(pixbuf),
+                g_object_unref,
+                g_object_ref(pixbuf)
+            );
+        }
+    }
+
     Image::~Image()
     {
         if (G_IS_OBJECT(_data))
@@ -41,8 +318,10 @@ namespace mousetrap
 
     Image::Image(const Image& other)
     {
-        _data = gdk_pixbuf_copy(other._data);
+        _data = other._data != nullptr ? gdk_pixbuf_copy(other._data) : nullptr;
         _size = other._size;
+        _format = other._format;
+        _buffer = other._buffer;
     }
 
     Image::Image(Image&& other) noexcept
@@ -52,27 +331,44 @@ namespace mousetrap
 
         _data = other._data;
         _size = other._size;
+        _format = other._format;
+        _buffer = std::move(other._buffer);
 
         other._data = nullptr;
         other._size = {0, 0};
+        other._format = ImageFormat::RGBA8;
+        other._buffer.clear();
     }
 
     Image& Image::operator=(const Image& other)
     {
-        _data = gdk_pixbuf_copy(other._data);
+        if (this == &other)
+            return *this;
+
+        if (G_IS_OBJECT(_data))
+            g_object_unref(_data);
+
+        _data = other._data != nullptr ? gdk_pixbuf_copy(other._data) : nullptr;
         _size = other._size;
+        _format = other._format;
+        _buffer = other._buffer;
         return *this;
     }
 
     Image& Image::operator=(Image&& other) noexcept
     {
-        g_object_unref(_data);
+        if (G_IS_OBJECT(_data))
+            g_object_unref(_data);
 
         _data = other._data;
         _size = other._size;
+        _format = other._format;
+        _buffer = std::move(other._buffer);
 
         other._data = nullptr;
         other._size = {0, 0};
+        other._format = ImageFormat::RGBA8;
+        other._buffer.clear();
         return *this;
     }
 
@@ -88,11 +384,40 @@ namespace mousetrap
 
         _data = gdk_pixbuf_new(GDK_COLORSPACE_RGB, TRUE, 8, width, height);
         _size = {width, height};
+        _format = ImageFormat::RGBA8;
+        _buffer.clear();
+        _buffer.shrink_to_fit();
+        fill(default_color);
+    }
+
+    void Image::create(uint64_t width, uint64_t height, ImageFormat format)
+    {
+        if (format == ImageFormat::RGBA8)
+        {
+            create(width, height, RGBA(0, 0, 0, 0));
+            return;
+        }
+
+        if (G_IS_OBJECT(_data))
+            g_object_unref(_data);
+
+        _data = nullptr;
+        _size = {width, height};
+        _format = format;
+        _buffer.assign(width * height * detail::image_format_get_n_channels(format) * detail::image_format_get_value_size(format), 0);
+    }
+
+    ImageFormat Image::get_format() const
+    {
+        return _format;
+    }
 
-        if (default_color.r != 0 or default_color.g != 0 or default_color.b != 0 or default_color.a != 0)
-            for (uint64_t x = 0; x < width; ++x)
-                for (uint64_t y = 0; y < height; ++y)
-                    set_pixel(x, y, default_color);
+    bool Image::is_allocated() const
+    {
+        if (_format == ImageFormat::RGBA8)
+            return _data != nullptr;
+        else
+            return not _buffer.empty();
     }
 
     bool Image::create_from_file(const std::string& path)
@@ -100,8 +425,33 @@ namespace mousetrap
         if (G_IS_OBJECT(_data))
             g_object_unref(_data);
 
+        _data = nullptr;
+        _format = ImageFormat::RGBA8;
+        _buffer.clear();
+        _buffer.shrink_to_fit();
+
+        // raw files are copied straight from the page cache, they do not need to be cached
+        if (detail::raw_image_has_magic(path))
+        {
+            auto raw = detail::RawImageFile();
+            if (not detail::raw_image_open(path, raw))
+            {
+                log::critical("In Image::create_from_file: file \"" + path + "\" is not a valid raw image, it is truncated or was written by a different version", MOUSETRAP_DOMAIN);
+                _size = {0, 0};
+                return false;
+            }
+
+            uint64_t width, height;
+            const auto* pixels = detail::raw_image_get_level(raw, 0, width, height);
+            create(width, height, ImageFormat(raw.header->format));
+            convert_from(_format, pixels);
+
+            detail::raw_image_close(raw);
+            return true;
+        }
+
         GError* error_maybe = nullptr;
-        _data = gdk_pixbuf_new_from_file(path.c_str(), &error_maybe);
+        auto* cached = detail::image_cache_get_pixbuf(path, &error_maybe);
 
         if (error_maybe != nullptr)
         {
@@ -111,6 +461,10 @@ namespace mousetrap
             return false;
         }
 
+        // images are mutable, so they cannot share the cached pixels, copying is still much cheaper than decoding
+        _data = gdk_pixbuf_copy(cached);
+        g_object_unref(cached);
+
         _size.x = gdk_pixbuf_get_width(_data);
         _size.y = gdk_pixbuf_get_height(_data);
 
@@ -125,6 +479,10 @@ namespace mousetrap
             return false;
         }
 
+        // encoders only accept 8-bit data
+        if (_format != ImageFormat::RGBA8)
+            return as_format(ImageFormat::RGBA8).save_to_file(path);
+
         GError* error = nullptr;
         gdk_pixbuf_save(_data, path.c_str(), "png", &error, NULL);
         if (error != nullptr)
@@ -137,6 +495,274 @@ namespace mousetrap
         return true;
     }
 
+    namespace detail
+    {
+        static const char* image_file_format_to_gdk_type(ImageFileFormat format)
+        {
+            if (format == ImageFileFormat::JPEG)
+                return "jpeg";
+            else if (format == ImageFileFormat::WEBP)
+                return "webp";
+            else
+                return "png";
+        }
+
+        // encodes into a file if path is not nullptr, into out otherwise
+        static bool image_encode(GdkPixbuf* pixbuf, ImageFileFormat format, const ImageEncodeOptions& options, const std::string* path, std::vector<uint8_t>* out, std::string& error_message)
+        {
+            std::vector<std::string> keys;
+            std::vector<std::string> values;
+
+            if (format == ImageFileFormat::PNG)
+            {
+                keys.push_back("compression");
+                values.push_back(std::to_string(std::min<uint64_t>(options.png_compression_level, 9)));
+            }
+            else
+            {
+                keys.push_back("quality");
+                values.push_back(std::to_string(std::min<uint64_t>(options.quality, 100)));
+            }
+
+            std::vector<char*> key_ptrs;
+            std::vector<char*> value_ptrs;
+            for (uint64_t i = 0; i < keys.size(); ++i)
+            {
+                key_ptrs.push_back(keys.at(i).data());
+                value_ptrs.push_back(values.at(i).data());
+            }
+            key_ptrs.push_back(nullptr);
+            value_ptrs.push_back(nullptr);
+
+            auto* type = image_file_format_to_gdk_type(format);
+            GError* error = nullptr;
+
+            if (path != nullptr)
+                gdk_pixbuf_savev(pixbuf, path->c_str(), type, key_ptrs.data(), value_ptrs.data(), &error);
+            else
+            {
+                gchar* buffer = nullptr;
+                gsize n_bytes = 0;
+                if (gdk_pixbuf_save_to_bufferv(pixbuf, &buffer, &n_bytes, type, key_ptrs.data(), value_ptrs.data(), &error))
+                {
+                    out->assign(reinterpret_cast<uint8_t*>(buffer), reinterpret_cast<uint8_t*>(buffer) + n_bytes);
+                    g_free(buffer);
+                }
+            }
+
+            if (error != nullptr)
+            {
+                error_message = error->message;
+                g_error_free(error);
+                return false;
+            }
+
+            return true;
+        }
+
+        // raw files keep the format of the image, so they are written without converting to RGBA8 first
+        static bool image_write_raw(const Image& image, const ImageEncodeOptions& options, const std::string& path, std::string& error_message)
+        {
+            std::vector<uint8_t> bytes;
+            raw_image_encode(image, options.generate_mipmaps, bytes);
+
+            GError* error = nullptr;
+            g_file_set_contents(path.c_str(), reinterpret_cast<const gchar*>(bytes.data()), bytes.size(), &error);
+
+            if (error != nullptr)
+            {
+                error_message = error->message;
+                g_error_free(error);
+                return false;
+            }
+
+            return true;
+        }
+
+        // saves that were started but did not finish writing yet, bounded to limit the memory held by pixel copies
+        static std::mutex IMAGE_ENCODE_MUTEX;
+        static std::condition_variable IMAGE_ENCODE_DONE;
+        static uint64_t IMAGE_ENCODE_N_PENDING = 0;
+
+        struct ImageEncodeTask
+        {
+            GdkPixbuf* pixbuf = nullptr;
+            Image* raw_image = nullptr;
+            std::string path;
+            ImageFileFormat format;
+            ImageEncodeOptions options;
+            std::function<void(bool)> on_done;
+            std::string error_message;
+        };
+
+        static void image_encode_task_free(ImageEncodeTask* self)
+        {
+            if (self->pixbuf != nullptr)
+                g_object_unref(self->pixbuf);
+
+            delete self->raw_image;
+            delete self;
+        }
+
+        static void image_encode_task_run(GTask* task, gpointer, ImageEncodeTask* self, GCancellable*)
+        {
+            bool success;
+            if (self->format == ImageFileFormat::RAW)
+            {
+                success = image_write_raw(*self->raw_image, self->options, self->path, self->error_message);
+                delete self->raw_image;
+                self->raw_image = nullptr;
+            }
+            else
+            {
+                success = image_encode(self->pixbuf, self->format, self->options, &self->path, nullptr, self->error_message);
+                g_object_unref(self->pixbuf);
+                self->pixbuf = nullptr;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(IMAGE_ENCODE_MUTEX);
+                IMAGE_ENCODE_N_PENDING -= 1;
+            }
+            IMAGE_ENCODE_DONE.notify_all();
+
+            g_task_return_boolean(task, success);
+        }
+
+        static void image_encode_task_finish(GObject*, GAsyncResult* result, gpointer)
+        {
+            auto* self = (ImageEncodeTask*) g_task_get_task_data(G_TASK(result));
+            bool success = g_task_propagate_boolean(G_TASK(result), nullptr);
+
+            if (not success)
+                log::critical("In Image::save_to_file_async: Unable to save file at `" + self->path + "`: " + self->error_message, MOUSETRAP_DOMAIN);
+
+            if (self->on_done)
+                self->on_done(success);
+        }
+    }
+
+    bool Image::save_to_file(const std::string& path, ImageFileFormat format, const ImageEncodeOptions& options) const
+    {
+        if (_size.x == 0 and _size.y == 0)
+        {
+            log::critical("In Image::save_to_file: Attempting to write an image of size 0x0 to disk, no file will be generated.", MOUSETRAP_DOMAIN);
+            return false;
+        }
+
+        std::string error_message;
+        if (format == ImageFileFormat::RAW)
+        {
+            if (not detail::image_write_raw(*this, options, path, error_message))
+            {
+                log::critical("In Image::save_to_file: " + error_message, MOUSETRAP_DOMAIN);
+                return false;
+            }
+
+            return true;
+        }
+
+        if (_format != ImageFormat::RGBA8)
+            return as_format(ImageFormat::RGBA8).save_to_file(path, format, options);
+
+        if (not detail::image_encode(_data, format, options, &path, nullptr, error_message))
+        {
+            log::critical("In Image::save_to_file: " + error_message, MOUSETRAP_DOMAIN);
+            return false;
+        }
+
+        return true;
+    }
+
+    void Image::save_to_file_async_impl(const std::string& path, ImageFileFormat format, const ImageEncodeOptions& options, std::function<void(bool)> on_done) const
+    {
+        if (_size.x == 0 and _size.y == 0)
+        {
+            log::critical("In Image::save_to_file_async: Attempting to write an image of size 0x0 to disk, no file will be generated.", MOUSETRAP_DOMAIN);
+            if (on_done)
+                on_done(false);
+
+            return;
+        }
+
+        // wait before copying, so at most this many copies exist at a time
+        {
+            const uint64_t max_n_pending = 2 * detail::thread_pool_get_n_threads(detail::thread_pool_get_default());
+            std::unique_lock<std::mutex> lock(detail::IMAGE_ENCODE_MUTEX);
+            detail::IMAGE_ENCODE_DONE.wait(lock, [&](){
+                return detail::IMAGE_ENCODE_N_PENDING < max_n_pending;
+            });
+            detail::IMAGE_ENCODE_N_PENDING += 1;
+        }
+
+        auto* task_data = new detail::ImageEncodeTask();
+        if (format == ImageFileFormat::RAW)
+            task_data->raw_image = new Image(*this);
+        else
+            task_data->pixbuf = _format == ImageFormat::RGBA8 ? gdk_pixbuf_copy(_data) : GDK_PIXBUF(g_object_ref(as_format(ImageFormat::RGBA8)._data));
+
+        task_data->path = path;
+        task_data->format = format;
+        task_data->options = options;
+        task_data->on_done = std::move(on_done);
+
+        auto* task = g_task_new(nullptr, nullptr, (GAsyncReadyCallback) detail::image_encode_task_finish, nullptr);
+        g_task_set_task_data(task, task_data, (GDestroyNotify) detail::image_encode_task_free);
+        g_task_run_in_thread(task, (GTaskThreadFunc) detail::image_encode_task_run);
+        g_object_unref(task);
+    }
+
+    bool Image::encode_to_bytes(ImageFileFormat format, std::vector<uint8_t>& out, const ImageEncodeOptions& options) const
+    {
+        out.clear();
+        if (_size.x == 0 and _size.y == 0)
+        {
+            log::critical("In Image::encode_to_bytes: Attempting to encode an image of size 0x0", MOUSETRAP_DOMAIN);
+            return false;
+        }
+
+        if (format == ImageFileFormat::RAW)
+        {
+            detail::raw_image_encode(*this, options.generate_mipmaps, out);
+            return true;
+        }
+
+        if (_format != ImageFormat::RGBA8)
+            return as_format(ImageFormat::RGBA8).encode_to_bytes(format, out, options);
+
+        std::string error_message;
+        if (not detail::image_encode(_data, format, options, nullptr, &out, error_message))
+        {
+            log::critical("In Image::encode_to_bytes: " + error_message, MOUSETRAP_DOMAIN);
+            return false;
+        }
+
+        return true;
+    }
+
+    bool Image::is_file_format_supported(ImageFileFormat format)
+    {
+        if (format == ImageFileFormat::RAW)
+            return true;
+
+        std::string type = detail::image_file_format_to_gdk_type(format);
+        bool out = false;
+
+        auto* formats = gdk_pixbuf_get_formats();
+        for (auto* it = formats; it != nullptr; it = it->next)
+        {
+            auto* info = (GdkPixbufFormat*) it->data;
+            gchar* name = gdk_pixbuf_format_get_name(info);
+            if (type == name and gdk_pixbuf_format_is_writable(info))
+                out = true;
+
+            g_free(name);
+        }
+
+        g_slist_free(formats);
+        return out;
+    }
+
     Vector2ui Image::get_size() const
     {
         return _size;
@@ -144,12 +770,46 @@ namespace mousetrap
 
     void* Image::data() const
     {
+        if (_format != ImageFormat::RGBA8)
+            return const_cast<uint8_t*>(_buffer.data());
+
+        if (_data == nullptr)
+            return nullptr;
+
         return gdk_pixbuf_get_pixels(_data);
     }
 
     uint64_t Image::get_data_size() const
     {
-        return _size.x * _size.y * 4;
+        if (_format != ImageFormat::RGBA8)
+            return _buffer.size();
+
+        if (_data == nullptr)
+            return 0;
+
+        return gdk_pixbuf_get_byte_length(_data);
+    }
+
+    uint64_t Image::get_rowstride() const
+    {
+        if (_format != ImageFormat::RGBA8)
+            return _size.x * detail::image_format_get_n_channels(_format) * detail::image_format_get_value_size(_format);
+
+        if (_data == nullptr)
+            return 0;
+
+        return gdk_pixbuf_get_rowstride(_data);
+    }
+
+    uint64_t Image::get_n_channels() const
+    {
+        if (_format != ImageFormat::RGBA8)
+            return detail::image_format_get_n_channels(_format);
+
+        if (_data == nullptr)
+            return 4;
+
+        return gdk_pixbuf_get_n_channels(_data);
     }
 
     uint64_t Image::get_n_pixels() const
@@ -159,24 +819,154 @@ namespace mousetrap
 
     uint64_t Image::to_linear_index(uint64_t x, uint64_t y) const
     {
-        return y * (_size.x * 4) + (x * 4);
+        return y * get_rowstride() + x * get_n_channels() * detail::image_format_get_value_size(_format);
     }
 
-    void Image::set_pixel(uint64_t x, uint64_t y, RGBA color)
+    ImageRowSpan<uint8_t> Image::get_row(uint64_t y)
     {
-        auto i = to_linear_index(x, y);
+        if (not is_allocated() or y >= uint64_t(_size.y) or detail::image_format_get_value_size(_format) != 1)
+            return ImageRowSpan<uint8_t>();
 
-        if (i >= get_data_size())
+        return {static_cast<uint8_t*>(data()) + y * get_rowstride(), uint64_t(_size.x), get_n_channels()};
+    }
+
+    ImageRowSpan<const uint8_t> Image::get_row(uint64_t y) const
+    {
+        if (not is_allocated() or y >= uint64_t(_size.y) or detail::image_format_get_value_size(_format) != 1)
+            return ImageRowSpan<const uint8_t>();
+
+        return {static_cast<const uint8_t*>(data()) + y * get_rowstride(), uint64_t(_size.x), get_n_channels()};
+    }
+
+    ImageRowSpan<float> Image::get_row_f32(uint64_t y)
+    {
+        if (not is_allocated() or y >= uint64_t(_size.y) or detail::image_format_get_value_size(_format) != sizeof(float))
+            return ImageRowSpan<float>();
+
+        return {reinterpret_cast<float*>(_buffer.data() + y * get_rowstride()), uint64_t(_size.x), get_n_channels()};
+    }
+
+    ImageRowSpan<const float> Image::get_row_f32(uint64_t y) const
+    {
+        if (not is_allocated() or y >= uint64_t(_size.y) or detail::image_format_get_value_size(_format) != sizeof(float))
+            return ImageRowSpan<const float>();
+
+        return {reinterpret_cast<const float*>(_buffer.data() + y * get_rowstride()), uint64_t(_size.x), get_n_channels()};
+    }
+
+    void Image::fill(RGBA color)
+    {
+        if (not is_allocated() or _size.x == 0 or _size.y == 0)
+            return;
+
+        const auto n_channels = get_n_channels();
+        const auto pixel_size = n_channels * detail::image_format_get_value_size(_format);
+
+        uint8_t pixel[4 * sizeof(float)];
+        float as_float[4] = {color.r, color.g, color.b, color.a};
+        detail::convert_row_from_rgba32f(as_float, _format, n_channels, pixel, 1);
+
+        auto* pixels = static_cast<uint8_t*>(data());
+        const auto rowstride = get_rowstride();
+        const auto row_size = _size.x * pixel_size;
+
+        if (std::all_of(pixel + 1, pixel + pixel_size, [&](uint8_t byte){ return byte == pixel[0]; }))
+        {
+            for (uint64_t y = 0; y < _size.y; ++y)
+                std::memset(pixels + y * rowstride, pixel[0], row_size);
+            return;
+        }
+
+        // fill first row by doubling, then copy it into all other rows
+        std::memcpy(pixels, pixel, pixel_size);
+        uint64_t n_filled = pixel_size;
+        while (n_filled < row_size)
+        {
+            auto n = std::min(n_filled, row_size - n_filled);
+            std::memcpy(pixels + n_filled, pixels, n);
+            n_filled += n;
+        }
+
+        detail::image_parallel_for_rows(_size.y - 1, row_size, [&](uint64_t y, uint64_t){
+            std::memcpy(pixels + (y + 1) * rowstride, pixels, row_size);
+        });
+    }
+
+    void Image::convert_to(ImageFormat format, void* destination) const
+    {
+        if (not is_allocated())
+            return;
+
+        const auto* pixels = static_cast<const uint8_t*>(data());
+        const uint64_t width = _size.x;
+        const uint64_t n_channels = get_n_channels();
+        const uint64_t rowstride = get_rowstride();
+        const uint64_t out_n_channels = detail::image_format_get_n_channels(format);
+        const uint64_t out_row_size = width * out_n_channels * detail::image_format_get_value_size(format);
+
+        detail::image_parallel_for_rows(_size.y, out_row_size, [&](uint64_t y, uint64_t){
+            detail::image_convert_row(
+                pixels + y * rowstride, _format, n_channels,
+                static_cast<uint8_t*>(destination) + y * out_row_size, format, out_n_channels,
+                width
+            );
+        });
+    }
+
+    void Image::convert_from(ImageFormat format, const void* source)
+    {
+        if (not is_allocated())
+            return;
+
+        auto* pixels = static_cast<uint8_t*>(data());
+        const uint64_t width = _size.x;
+        const uint64_t n_channels = get_n_channels();
+        const uint64_t rowstride = get_rowstride();
+        const uint64_t in_n_channels = detail::image_format_get_n_channels(format);
+        const uint64_t in_row_size = width * in_n_channels * detail::image_format_get_value_size(format);
+
+        detail::image_parallel_for_rows(_size.y, in_row_size, [&](uint64_t y, uint64_t){
+            detail::image_convert_row(
+                static_cast<const uint8_t*>(source) + y * in_row_size, format, in_n_channels,
+                pixels + y * rowstride, _format, n_channels,
+                width
+            );
+        });
+    }
+
+    Image Image::as_format(ImageFormat format) const
+    {
+        auto out = Image();
+        if (not is_allocated())
+            return out;
+
+        out.create(_size.x, _size.y, format);
+
+        const auto* in = static_cast<const uint8_t*>(data());
+        auto* out_pixels = static_cast<uint8_t*>(out.data());
+        const uint64_t in_rowstride = get_rowstride();
+        const uint64_t out_rowstride = out.get_rowstride();
+        const uint64_t n_channels = get_n_channels();
+        const uint64_t out_n_channels = out.get_n_channels();
+
+        detail::image_parallel_for_rows(_size.y, out_rowstride, [&](uint64_t y, uint64_t){
+            detail::image_convert_row(in + y * in_rowstride, _format, n_channels, out_pixels + y * out_rowstride, format, out_n_channels, _size.x);
+        });
+
+        return out;
+    }
+
+    void Image::set_pixel(uint64_t x, uint64_t y, RGBA color)
+    {
+        if (not is_allocated() or x >= uint64_t(_size.x) or y >= uint64_t(_size.y))
         {
             std::cerr << "[ERROR] In Image::set_pixel: indices " << x << " " << y << " are out of bounds for an image of size " << _size.x << "x" << _size.y << std::endl;
             return;
         }
 
-        auto* data = gdk_pixbuf_get_pixels(_data);
-        data[i] = color.r * 255;
-        data[i+1] = color.g * 255;
-        data[i+2] = color.b * 255;
-        data[i+3] = color.a * 255;
+        float as_float[4] = {color.r, color.g, color.b, color.a};
+        auto* data = static_cast<uint8_t*>(this->data()) + to_linear_index(x, y);
+        detail::convert_row_from_rgba32f(as_float, _format, get_n_channels(), data, 1);
     }
 
     void Image::set_pixel(uint64_t x, uint64_t y, HSVA color)
@@ -186,9 +976,7 @@ namespace mousetrap
 
     RGBA Image::get_pixel(uint64_t x, uint64_t y) const
     {
-        auto i = to_linear_index(x, y);
-
-        if (i >= get_data_size())
+        if (not is_allocated() or x >= uint64_t(_size.x) or y >= uint64_t(_size.y))
         {
             std::stringstream str;
             str << "[ERROR] In Image::get_pixel: indices " << x << " " << y << " are out of bounds for an image of size " << _size.x << "x" << _size.y;
@@ -197,34 +985,24 @@ namespace mousetrap
             return RGBA(0, 0, 0, 0);
         }
 
-        auto* data = gdk_pixbuf_get_pixels(_data);
-
-        return RGBA (
-        data[i] / 255.f,
-        data[i+1] / 255.f,
-        data[i+2] / 255.f,
-        data[i+3] / 255.f
-        );
+        float rgba[4];
+        auto* data = static_cast<const uint8_t*>(this->data()) + to_linear_index(x, y);
+        detail::convert_row_to_rgba32f(data, _format, get_n_channels(), rgba, 1);
+        return RGBA(rgba[0], rgba[1], rgba[2], rgba[3]);
     }
 
     void Image::set_pixel(uint64_t i, RGBA color)
     {
-        i *= 4;
-
-        if (i >= get_data_size())
+        if (i >= get_n_pixels())
         {
             std::stringstream str;
-            str << "In Image::set_pixel: index " << i / 4 << " out of bounds for an image of with " << _size.x * _size.y << " pixels";
+            str << "In Image::set_pixel: index " << i << " out of bounds for an image of with " << _size.x * _size.y << " pixels";
 
             log::critical(str.str(), MOUSETRAP_DOMAIN);
             return;
         }
 
-        auto* data = gdk_pixbuf_get_pixels(_data);
-        data[i] = color.r * 255;
-        data[i+1] = color.g * 255;
-        data[i+2] = color.b * 255;
-        data[i+3] = color.a * 255;
+        set_pixel(i % _size.x, i / _size.x, color);
     }
 
     void Image::set_pixel(uint64_t i, HSVA color_hsva)
@@ -234,42 +1012,445 @@ namespace mousetrap
 
     RGBA Image::get_pixel(uint64_t i) const
     {
-        i *= 4;
+        if (i >= get_n_pixels())
+        {
+            std::stringstream str;
+            str << "In Image::get_pixel: index " << i << " out of bounds for an image of with " << _size.x * _size.y << " pixels";
 
-        auto* data = gdk_pixbuf_get_pixels(_data);
+            log::critical(str.str(), MOUSETRAP_DOMAIN);
+            return RGBA(0, 0, 0, 0);
+        }
 
-        return RGBA (
-            data[i] / 255.f,
-            data[i+1] / 255.f,
-            data[i+2] / 255.f,
-            data[i+3] / 255.f
-        );
+        return get_pixel(i % _size.x, i / _size.x);
+    }
+
+    namespace detail
+    {
+        // 4 channel pixel data of an image, RGB images are expanded into buffer first
+        static const uint8_t* image_get_rgba8(const Image& image, std::vector<uint8_t>& buffer, uint64_t& rowstride)
+        {
+            if (image.get_format() == ImageFormat::RGBA8 and image.get_n_channels() == 4)
+            {
+                rowstride = image.get_rowstride();
+                return static_cast<const uint8_t*>(image.data());
+            }
+
+            buffer.resize(image.get_n_pixels() * 4);
+            image.convert_to(ImageFormat::RGBA8, buffer.data());
+            rowstride = image.get_size().x * 4;
+            return buffer.data();
+        }
+
+        // out[i] = in[n - 1 - i], in and out may not overlap
+        static void reverse_pixels(const uint32_t* in, uint32_t* out, uint64_t n)
+        {
+            uint64_t i = 0;
+
+            #if defined(__SSE2__) or defined(_M_X64) or defined(__AVX__)
+
+            for (; i + 4 <= n; i += 4)
+            {
+                __m128i pixels = _mm_loadu_si128((const __m128i*) (in + n - i - 4));
+                _mm_storeu_si128((__m128i*) (out + i), _mm_shuffle_epi32(pixels, _MM_SHUFFLE(0, 1, 2, 3)));
+            }
+
+            #endif
+
+            for (; i < n; ++i)
+                out[i] = in[n - 1 - i];
+        }
+
+        // rotate by 90° clockwise if clockwise is true, counter-clockwise otherwise
+        static void rotate_pixels(const uint8_t* in, uint64_t in_rowstride, uint64_t width, uint64_t height, uint8_t* out, uint64_t out_rowstride, bool clockwise)
+        {
+            // tiles of 64x64 pixels fit into l1 cache for both source and destination
+            constexpr uint64_t tile_size = 64;
+            const uint64_t n_tile_rows = (height + tile_size - 1) / tile_size;
+
+            auto in_pixel = [&](uint64_t x, uint64_t y) -> const uint32_t* {
+                return reinterpret_cast<const uint32_t*>(in + y * in_rowstride) + x;
+            };
+
+            auto out_pixel = [&](uint64_t x, uint64_t y) -> uint32_t* {
+                return reinterpret_cast<uint32_t*>(out + y * out_rowstride) + x;
+            };
+
+            // clockwise: in(x, y) -> out(height - 1 - y, x), counter-clockwise: in(x, y) -> out(y, width - 1 - x)
+            thread_pool_parallel_for(thread_pool_get_default(), n_tile_rows, [&](uint64_t tile_y, uint64_t){
+                const uint64_t y_begin = tile_y * tile_size;
+                const uint64_t y_end = std::min(height, y_begin + tile_size);
+
+                for (uint64_t x_begin = 0; x_begin < width; x_begin += tile_size)
+                {
+                    const uint64_t x_end = std::min(width, x_begin + tile_size);
+                    uint64_t y = y_begin;
+
+                    #if defined(__SSE2__) or defined(_M_X64) or defined(__AVX__)
+
+                    // 4x4 blocks are transposed in registers, then stored as four rows of the output
+                    for (; y + 4 <= y_end; y += 4)
+                    {
+                        uint64_t x = x_begin;
+                        for (; x + 4 <= x_end; x += 4)
+                        {
+                            __m128 r0 = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*) in_pixel(x, y + 0)));
+                            __m128 r1 = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*) in_pixel(x, y + 1)));
+                            __m128 r2 = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*) in_pixel(x, y + 2)));
+                            __m128 r3 = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*) in_pixel(x, y + 3)));
+                            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+                            // after transposing, r<i> holds column x + i, ordered by y
+                            __m128i columns[4] = {_mm_castps_si128(r0), _mm_castps_si128(r1), _mm_castps_si128(r2), _mm_castps_si128(r3)};
+                            for (uint64_t i = 0; i < 4; ++i)
+                            {
+                                if (clockwise)
+                                {
+                                    // y increasing maps to out x decreasing
+                                    __m128i reversed = _mm_shuffle_epi32(columns[i], _MM_SHUFFLE(0, 1, 2, 3));
+                                    _mm_storeu_si128((__m128i*) out_pixel(height - 1 - (y + 3), x + i), reversed);
+                                }
+                                else
+                                    _mm_storeu_si128((__m128i*) out_pixel(y, width - 1 - (x + i)), columns[i]);
+                            }
+                        }
+
+                        for (; x < x_end; ++x)
+                            for (uint64_t yi = y; yi < y + 4; ++yi)
+                                if (clockwise)
+                                    *out_pixel(height - 1 - yi, x) = *in_pixel(x, yi);
+                                else
+                                    *out_pixel(yi, width - 1 - x) = *in_pixel(x, yi);
+                    }
+
+                    #endif
+
+                    for (; y < y_end; ++y)
+                        for (uint64_t x = x_begin; x < x_end; ++x)
+                            if (clockwise)
+                                *out_pixel(height - 1 - y, x) = *in_pixel(x, y);
+                            else
+                                *out_pixel(y, width - 1 - x) = *in_pixel(x, y);
+                }
+            });
+        }
     }
 
     Image Image::as_cropped(int offset_x, int offset_y, uint64_t size_x, uint64_t size_y) const
     {
+        // 8-bit images are always cropped into RGBA, all other formats are preserved
         auto out = Image();
-        out.create(size_x, size_y);
+        if (_format == ImageFormat::RGBA8)
+            out.create(size_x, size_y, RGBA(0, 0, 0, 0));
+        else
+            out.create(size_x, size_y, _format);
+
+        // pixel (x, y) of out is pixel (x - offset_x, y - offset_y) of this image, copy the overlapping rectangle row by row
+        const int64_t x_begin = std::max<int64_t>(0, offset_x);
+        const int64_t x_end = std::min<int64_t>(int64_t(size_x), int64_t(_size.x) + offset_x);
+        const int64_t y_begin = std::max<int64_t>(0, offset_y);
+        const int64_t y_end = std::min<int64_t>(int64_t(size_y), int64_t(_size.y) + offset_y);
 
-        for (uint64_t y = 0; y < size_y; ++y)
+        if (not is_allocated() or x_begin >= x_end or y_begin >= y_end)
+            return out;
+
+        std::vector<uint8_t> buffer;
+        uint64_t in_rowstride = 0;
+        const uint8_t* in = nullptr;
+        if (_format == ImageFormat::RGBA8)
+            in = detail::image_get_rgba8(*this, buffer, in_rowstride);
+        else
         {
-            for (uint64_t x = 0; x < size_x; ++x)
+            in = _buffer.data();
+            in_rowstride = get_rowstride();
+        }
+
+        auto* out_pixels = static_cast<uint8_t*>(out.data());
+        const uint64_t out_rowstride = out.get_rowstride();
+        const uint64_t pixel_size = out.get_n_channels() * detail::image_format_get_value_size(_format);
+        const uint64_t n_bytes = (x_end - x_begin) * pixel_size;
+
+        detail::image_parallel_for_rows(y_end - y_begin, n_bytes, [&](uint64_t row_i, uint64_t){
+            const int64_t y = y_begin + row_i;
+            std::memcpy(
+                out_pixels + y * out_rowstride + x_begin * pixel_size,
+                in + (y - offset_y) * in_rowstride + (x_begin - offset_x) * pixel_size,
+                n_bytes
+            );
+        });
+
+        return out;
+    }
+
+    namespace detail
+    {
+        // filter weights for one axis, output pixel i is the weighted sum of input pixels [first[i], first[i] + n[i])
+        struct ResampleWeights
+        {
+            std::vector<uint64_t> first;
+            std::vector<uint64_t> n;
+
+            // max_n weights per output pixel, zero-padded
+            std::vector<float> weights;
+            uint64_t max_n = 0;
+        };
+
+        static double resample_filter_support(InterpolationType type)
+        {
+            if (type == InterpolationType::LANCZOS)
+                return 3;
+            else if (type == InterpolationType::BICUBIC)
+                return 2;
+            else
+                return 0.5;
+        }
+
+        static double resample_filter(InterpolationType type, double x)
+        {
+            x = std::abs(x);
+            if (type == InterpolationType::LANCZOS)
             {
-                Vector2i pos = {x - offset_x, y - offset_y};
+                if (x < 1e-8)
+                    return 1;
 
-                if (pos.x < 0 or pos.x >= get_size().x or pos.y < 0 or pos.y >= get_size().y)
-                    out.set_pixel(x, y, RGBA(0, 0, 0, 0));
+                if (x >= 3)
+                    return 0;
+
+                const double pi_x = 3.14159265358979323846 * x;
+                return 3 * std::sin(pi_x) * std::sin(pi_x / 3) / (pi_x * pi_x);
+            }
+            else if (type == InterpolationType::BICUBIC)
+            {
+                // keys cubic with a = -0.5
+                constexpr double a = -0.5;
+                if (x < 1)
+                    return ((a + 2) * x - (a + 3)) * x * x + 1;
+                else if (x < 2)
+                    return ((a * x - 5 * a) * x + 8 * a) * x - 4 * a;
                 else
-                    out.set_pixel(x, y, get_pixel(pos.x, pos.y));
+                    return 0;
             }
+            else
+                return x <= 0.5 ? 1 : 0;
         }
 
-        return out;
+        static ResampleWeights resample_compute_weights(uint64_t in_size, uint64_t out_size, InterpolationType type)
+        {
+            // when downscaling, the filter is stretched such that it covers all input pixels of an output pixel
+            const double scale = double(in_size) / double(out_size);
+            const double filter_scale = std::max(scale, 1.0);
+            const double support = resample_filter_support(type) * filter_scale;
+
+            ResampleWeights out;
+            out.max_n = uint64_t(std::ceil(support)) * 2 + 1;
+            out.first.resize(out_size);
+            out.n.resize(out_size);
+            out.weights.resize(out_size * out.max_n, 0);
+
+            for (uint64_t i = 0; i < out_size; ++i)
+            {
+                const double center = (i + 0.5) * scale;
+                int64_t begin = std::max<int64_t>(0, int64_t(center - support + 0.5));
+                int64_t end = std::min<int64_t>(in_size, int64_t(center + support + 0.5));
+                end = std::min<int64_t>(end, begin + out.max_n);
+
+                float* weights = out.weights.data() + i * out.max_n;
+                double sum = 0;
+                for (int64_t j = begin; j < end; ++j)
+                {
+                    double weight = resample_filter(type, (j - center + 0.5) / filter_scale);
+                    weights[j - begin] = weight;
+                    sum += weight;
+                }
+
+                if (sum != 0)
+                    for (int64_t j = 0; j < end - begin; ++j)
+                        weights[j] /= sum;
+
+                out.first[i] = begin;
+                out.n[i] = end - begin;
+            }
+
+            return out;
+        }
+
+        // u8 rgba to float, rgb multiplied by alpha
+        static void resample_load_row(const uint8_t* in, float* out, uint64_t n_pixels)
+        {
+            convert_u8_to_f32(in, out, n_pixels * 4);
+            uint64_t i = 0;
+
+            #if defined(__SSE2__) or defined(_M_X64) or defined(__AVX__)
+
+            const __m128 rgb_mask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+            const __m128 alpha_one = _mm_set_ps(1, 0, 0, 0);
+            for (; i < n_pixels; ++i)
+            {
+                __m128 pixel = _mm_loadu_ps(out + 4 * i);
+                __m128 alpha = _mm_shuffle_ps(pixel, pixel, _MM_SHUFFLE(3, 3, 3, 3));
+                __m128 factor = _mm_or_ps(_mm_and_ps(rgb_mask, alpha), alpha_one);
+                _mm_storeu_ps(out + 4 * i, _mm_mul_ps(pixel, factor));
+            }
+
+            #endif
+
+            for (; i < n_pixels; ++i)
+            {
+                float* pixel = out + 4 * i;
+                pixel[0] *= pixel[3];
+                pixel[1] *= pixel[3];
+                pixel[2] *= pixel[3];
+            }
+        }
+
+        // premultiplied float to u8 rgba, in is modified
+        static void resample_store_row(float* in, uint8_t* out, uint64_t n_pixels)
+        {
+            for (uint64_t i = 0; i < n_pixels; ++i)
+            {
+                float* pixel = in + 4 * i;
+                float alpha = pixel[3];
+                float factor = alpha > 1.f / 512.f ? 1.f / alpha : 0.f;
+                pixel[0] *= factor;
+                pixel[1] *= factor;
+                pixel[2] *= factor;
+            }
+
+            convert_f32_to_u8(in, out, n_pixels * 4);
+        }
+
+        // out = sum_j weights[j] * in[(first + j) * stride], for 4-channel float pixels
+        static inline void resample_accumulate_pixel(const float* in, uint64_t stride, const float* weights, uint64_t n, float* out)
+        {
+            #if defined(__SSE2__) or defined(_M_X64) or defined(__AVX__)
+
+            __m128 sum = _mm_setzero_ps();
+            for (uint64_t j = 0; j < n; ++j)
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[j]), _mm_loadu_ps(in + j * stride)));
+
+            _mm_storeu_ps(out, sum);
+
+            #else
+
+            float sum[4] = {0, 0, 0, 0};
+            for (uint64_t j = 0; j < n; ++j)
+                for (uint64_t c = 0; c < 4; ++c)
+                    sum[c] += weights[j] * in[j * stride + c];
+
+            for (uint64_t c = 0; c < 4; ++c)
+                out[c] = sum[c];
+
+            #endif
+        }
+
+        static void resample_separable(const uint8_t* in, uint64_t in_rowstride, uint64_t in_width, uint64_t in_height, uint8_t* out, uint64_t out_rowstride, uint64_t out_width, uint64_t out_height, InterpolationType type)
+        {
+            const auto weights_x = resample_compute_weights(in_width, out_width, type);
+            const auto weights_y = resample_compute_weights(in_height, out_height, type);
+
+            // bands of output rows, each band filters the input rows it needs horizontally once, then vertically
+            constexpr uint64_t band_height = 32;
+            const uint64_t n_bands = (out_height + band_height - 1) / band_height;
+
+            thread_pool_parallel_for(thread_pool_get_default(), n_bands, [&](uint64_t band_i, uint64_t){
+                const uint64_t y_begin = band_i * band_height;
+                const uint64_t y_end = std::min(out_height, y_begin + band_height);
+
+                uint64_t in_y_begin = weights_y.first[y_begin];
+                uint64_t in_y_end = 0;
+                for (uint64_t y = y_begin; y < y_end; ++y)
+                    in_y_end = std::max(in_y_end, weights_y.first[y] + weights_y.n[y]);
+
+                thread_local std::vector<float> in_row;
+                thread_local std::vector<float> horizontal;
+                thread_local std::vector<float> out_row;
+                in_row.resize(in_width * 4);
+                horizontal.resize((in_y_end - in_y_begin) * out_width * 4);
+                out_row.resize(out_width * 4);
+
+                for (uint64_t in_y = in_y_begin; in_y < in_y_end; ++in_y)
+                {
+                    resample_load_row(in + in_y * in_rowstride, in_row.data(), in_width);
+                    float* destination = horizontal.data() + (in_y - in_y_begin) * out_width * 4;
+                    for (uint64_t x = 0; x < out_width; ++x)
+                        resample_accumulate_pixel(
+                            in_row.data() + weights_x.first[x] * 4, 4,
+                            weights_x.weights.data() + x * weights_x.max_n, weights_x.n[x],
+                            destination + x * 4
+                        );
+                }
+
+                const uint64_t row_size = out_width * 4;
+                for (uint64_t y = y_begin; y < y_end; ++y)
+                {
+                    // rows are accumulated whole, which vectorizes across pixels
+                    const float* weights = weights_y.weights.data() + y * weights_y.max_n;
+                    const float* first_row = horizontal.data() + (weights_y.first[y] - in_y_begin) * row_size;
+                    std::fill(out_row.begin(), out_row.end(), 0.f);
+
+                    for (uint64_t j = 0; j < weights_y.n[y]; ++j)
+                    {
+                        const float weight = weights[j];
+                        const float* row = first_row + j * row_size;
+                        float* sum = out_row.data();
+                        for (uint64_t i = 0; i < row_size; ++i)
+                            sum[i] += weight * row[i];
+                    }
+
+                    resample_store_row(out_row.data(), out + y * out_rowstride, out_width);
+                }
+            });
+        }
+
+        // box filter for integer factors, alpha-weighted integer averages of factor_x * factor_y blocks
+        static void resample_box_integer(const uint8_t* in, uint64_t in_rowstride, uint8_t* out, uint64_t out_rowstride, uint64_t out_width, uint64_t out_height, uint64_t factor_x, uint64_t factor_y)
+        {
+            const uint32_t n = factor_x * factor_y;
+            detail::image_parallel_for_rows(out_height, out_width * factor_x * factor_y * 4, [&](uint64_t y, uint64_t){
+                thread_local std::vector<uint32_t> sums;
+                sums.assign(out_width * 4, 0);
+
+                for (uint64_t dy = 0; dy < factor_y; ++dy)
+                {
+                    const uint8_t* row = in + (y * factor_y + dy) * in_rowstride;
+                    for (uint64_t x = 0; x < out_width; ++x)
+                    {
+                        uint32_t* sum = sums.data() + x * 4;
+                        const uint8_t* pixel = row + x * factor_x * 4;
+                        for (uint64_t dx = 0; dx < factor_x; ++dx, pixel += 4)
+                        {
+                            const uint32_t alpha = pixel[3];
+                            sum[0] += pixel[0] * alpha;
+                            sum[1] += pixel[1] * alpha;
+                            sum[2] += pixel[2] * alpha;
+                            sum[3] += alpha;
+                        }
+                    }
+                }
+
+                uint8_t* out_row = out + y * out_rowstride;
+                for (uint64_t x = 0; x < out_width; ++x)
+                {
+                    const uint32_t* sum = sums.data() + x * 4;
+                    const uint32_t alpha = sum[3];
+                    uint8_t* pixel = out_row + x * 4;
+                    pixel[3] = (alpha + n / 2) / n;
+
+                    if (alpha == 0)
+                        pixel[0] = pixel[1] = pixel[2] = 0;
+                    else
+                    {
+                        pixel[0] = (sum[0] + alpha / 2) / alpha;
+                        pixel[1] = (sum[1] + alpha / 2) / alpha;
+                        pixel[2] = (sum[2] + alpha / 2) / alpha;
+                    }
+                }
+            });
+        }
     }
 
     Image Image::as_scaled(uint64_t size_x, uint64_t size_y, InterpolationType type) const
     {
-        if (int(size_x) == _size.x and int(size_y) == _size.y)
+        if (int(size_x) == _size.x and int(size_y) == _size.y and _format == ImageFormat::RGBA8)
             return *this;
 
         if (size_x == uint64_t(0))
@@ -278,32 +1459,109 @@ namespace mousetrap
         if (size_y == uint64_t(0))
             size_y = 1;
 
-        GdkInterpType gdk_interpolation_type;
-        GdkPixbuf* unscaled = _data;
-        return Image(gdk_pixbuf_scale_simple(unscaled, size_x, size_y, (GdkInterpType) type));
+        if (type == InterpolationType::BOX or type == InterpolationType::BICUBIC or type == InterpolationType::LANCZOS)
+        {
+            auto out = Image();
+            if (not is_allocated() or _size.x == 0 or _size.y == 0)
+                return out;
+
+            out._data = gdk_pixbuf_new(GDK_COLORSPACE_RGB, TRUE, 8, size_x, size_y);
+            out._size = {size_x, size_y};
+
+            std::vector<uint8_t> buffer;
+            uint64_t in_rowstride = 0;
+            const uint8_t* in = detail::image_get_rgba8(*this, buffer, in_rowstride);
+            auto* out_pixels = static_cast<uint8_t*>(out.data());
+
+            const uint64_t width = _size.x;
+            const uint64_t height = _size.y;
+            const bool is_integer_downscale = width % size_x == 0 and height % size_y == 0 and (width / size_x) * (height / size_y) <= 65536;
+
+            if (type == InterpolationType::BOX and is_integer_downscale)
+                detail::resample_box_integer(in, in_rowstride, out_pixels, out.get_rowstride(), size_x, size_y, width / size_x, height / size_y);
+            else
+                detail::resample_separable(in, in_rowstride, width, height, out_pixels, out.get_rowstride(), size_x, size_y, type);
+
+            return out;
+        }
+
+        if (_format != ImageFormat::RGBA8)
+            return as_format(ImageFormat::RGBA8).as_scaled(size_x, size_y, type);
+
+        // Image(GdkPixbuf*) takes its own reference
+        GdkPixbuf* scaled = gdk_pixbuf_scale_simple(_data, size_x, size_y, (GdkInterpType) type);
+        auto out = Image(scaled);
+        g_object_unref(scaled);
+        return out;
     }
 
     Image Image::as_flipped(bool flip_horizontally, bool flip_vertically) const
     {
         auto out = Image();
-        out.create(_size.x, _size.y);
+        if (not is_allocated())
+            return out;
 
-        for (uint64_t x = 0; x < _size.x; ++x)
-        {
-            for (uint64_t y = 0; y < _size.y; ++y)
-            {
-                Vector2ui pos = {x, y};
+        out._data = gdk_pixbuf_new(GDK_COLORSPACE_RGB, TRUE, 8, _size.x, _size.y);
+        out._size = _size;
 
-                if (flip_horizontally)
-                    pos.x = _size.x - pos.x - 1;
+        std::vector<uint8_t> buffer;
+        uint64_t in_rowstride = 0;
+        const uint8_t* in = detail::image_get_rgba8(*this, buffer, in_rowstride);
 
-                if (flip_vertically)
-                    pos.y = _size.y - pos.y - 1;
+        auto* out_pixels = static_cast<uint8_t*>(out.data());
+        const uint64_t out_rowstride = out.get_rowstride();
+        const uint64_t width = _size.x;
+        const uint64_t height = _size.y;
 
-                out.set_pixel(pos.x, pos.y, get_pixel(x, y));
-            }
-        }
+        detail::image_parallel_for_rows(height, width * 4, [&](uint64_t y, uint64_t){
+            const uint8_t* in_row = in + (flip_vertically ? height - 1 - y : y) * in_rowstride;
+            uint8_t* out_row = out_pixels + y * out_rowstride;
+
+            if (flip_horizontally)
+                detail::reverse_pixels(reinterpret_cast<const uint32_t*>(in_row), reinterpret_cast<uint32_t*>(out_row), width);
+            else
+                std::memcpy(out_row, in_row, width * 4);
+        });
+
+        return out;
+    }
+
+    Image Image::as_rotated_90() const
+    {
+        auto out = Image();
+        if (not is_allocated())
+            return out;
+
+        out._data = gdk_pixbuf_new(GDK_COLORSPACE_RGB, TRUE, 8, _size.y, _size.x);
+        out._size = {_size.y, _size.x};
+
+        std::vector<uint8_t> buffer;
+        uint64_t in_rowstride = 0;
+        const uint8_t* in = detail::image_get_rgba8(*this, buffer, in_rowstride);
+
+        detail::rotate_pixels(in, in_rowstride, _size.x, _size.y, static_cast<uint8_t*>(out.data()), out.get_rowstride(), true);
+        return out;
+    }
+
+    Image Image::as_rotated_180() const
+    {
+        return as_flipped(true, true);
+    }
+
+    Image Image::as_rotated_270() const
+    {
+        auto out = Image();
+        if (not is_allocated())
+            return out;
+
+        out._data = gdk_pixbuf_new(GDK_COLORSPACE_RGB, TRUE, 8, _size.y, _size.x);
+        out._size = {_size.y, _size.x};
+
+        std::vector<uint8_t> buffer;
+        uint64_t in_rowstride = 0;
+        const uint8_t* in = detail::image_get_rgba8(*this, buffer, in_rowstride);
 
+        detail::rotate_pixels(in, in_rowstride, _size.x, _size.y, static_cast<uint8_t*>(out.data()), out.get_rowstride(), false);
         return out;
     }
 }
\ No newline at end of file
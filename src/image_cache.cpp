@@ -0,0 +1,359 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/18/26
+//
+
+#include <mousetrap/image_cache.hpp>
+#include <mousetrap/file_descriptor.hpp>
+#include <mousetrap/image.hpp>
+#include <mousetrap/log.hpp>
+
+#include <mutex>
+#include <list>
+#include <unordered_map>
+
+namespace mousetrap
+{
+    namespace detail
+    {
+        struct ImageCacheEntry
+        {
+            // modification time and size at the time of decoding, the entry is stale once they differ
+            std::string stamp;
+
+            GdkPixbuf* pixbuf = nullptr;
+            GdkTexture* gdk_texture = nullptr;
+            GObject* texture = nullptr;
+
+            uint64_t n_bytes = 0;
+            uint64_t n_gpu_bytes = 0;
+            std::list<std::string>::iterator lru_position;
+        };
+
+        struct ImageCache
+        {
+            std::mutex mutex;
+            bool enabled = true;
+
+            std::unordered_map<std::string, ImageCacheEntry> entries;
+
+            // ordered from most to least recently used
+            std::list<std::string> lru;
+
+            uint64_t memory_budget = 256 * 1024 * 1024;
+            uint64_t memory_usage = 0;
+            uint64_t gpu_memory_usage = 0;
+
+            uint64_t n_hits = 0;
+            uint64_t n_misses = 0;
+            uint64_t n_evictions = 0;
+        };
+
+        static ImageCache* image_cache_get()
+        {
+            static auto* cache = new ImageCache();
+            return cache;
+        }
+
+        static std::string image_cache_get_stamp(const std::string& path)
+        {
+            auto file = FileDescriptor(path);
+            auto* info = g_file_query_info(
+                file.operator GFile*(),
+                G_FILE_ATTRIBUTE_TIME_MODIFIED "," G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC "," G_FILE_ATTRIBUTE_STANDARD_SIZE,
+                G_FILE_QUERY_INFO_NONE,
+                nullptr,
+                nullptr
+            );
+
+            // files that cannot be queried are never cached
+            if (info == nullptr)
+                return "";
+
+            auto out = std::to_string(g_file_info_get_attribute_uint64(info, G_FILE_ATTRIBUTE_TIME_MODIFIED)) + "."
+                + std::to_string(g_file_info_get_attribute_uint32(info, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC)) + "|"
+                + std::to_string(g_file_info_get_attribute_uint64(info, G_FILE_ATTRIBUTE_STANDARD_SIZE));
+
+            g_object_unref(info);
+            return out;
+        }
+
+        // raw files never reach the cache, callers check for them with raw_image_has_magic and map them instead
+        static GdkPixbuf* image_cache_decode(const std::string& path, GError** error)
+        {
+            return gdk_pixbuf_new_from_file(path.c_str(), error);
+        }
+
+        static gboolean image_cache_unref_on_main_thread(void* object)
+        {
+            g_object_unref(object);
+            return G_SOURCE_REMOVE;
+        }
+
+        // cache has to be locked
+        static void image_cache_remove(ImageCache* cache, std::unordered_map<std::string, ImageCacheEntry>::iterator it)
+        {
+            auto& entry = it->second;
+            cache->memory_usage -= entry.n_bytes;
+            cache->gpu_memory_usage -= entry.n_gpu_bytes;
+            cache->lru.erase(entry.lru_position);
+
+            // objects still in use elsewhere stay alive, they only lose the reference held by the cache
+            g_object_unref(entry.pixbuf);
+
+            if (entry.gdk_texture != nullptr)
+                g_object_unref(entry.gdk_texture);
+
+            // deleting a gl texture requires the gl context, which is only current on the main thread
+            if (entry.texture != nullptr)
+                g_idle_add(image_cache_unref_on_main_thread, entry.texture);
+
+            cache->entries.erase(it);
+        }
+
+        // cache has to be locked
+        static void image_cache_evict(ImageCache* cache)
+        {
+            while (cache->memory_usage + cache->gpu_memory_usage > cache->memory_budget and not cache->lru.empty())
+            {
+                image_cache_remove(cache, cache->entries.find(cache->lru.back()));
+                cache->n_evictions += 1;
+            }
+        }
+
+        // cache has to be locked, returns nullptr if the path is not cached or the entry is stale
+        static ImageCacheEntry* image_cache_find(ImageCache* cache, const std::string& path, const std::string& stamp)
+        {
+            auto it = cache->entries.find(path);
+            if (it == cache->entries.end())
+                return nullptr;
+
+            if (it->second.stamp != stamp)
+            {
+                image_cache_remove(cache, it);
+                return nullptr;
+            }
+
+            auto& entry = it->second;
+            cache->lru.splice(cache->lru.begin(), cache->lru, entry.lru_position);
+            return &entry;
+        }
+
+        GdkPixbuf* image_cache_get_pixbuf(const std::string& path, GError** error)
+        {
+            auto* cache = image_cache_get();
+            auto stamp = image_cache_get_stamp(path);
+
+            {
+                auto lock = std::lock_guard(cache->mutex);
+                if (not cache->enabled)
+                    stamp = "";
+                else
+                {
+                    if (not stamp.empty())
+                    {
+                        auto* entry = image_cache_find(cache, path, stamp);
+                        if (entry != nullptr)
+                        {
+                            cache->n_hits += 1;
+                            return GDK_PIXBUF(g_object_ref(entry->pixbuf));
+                        }
+                    }
+
+                    cache->n_misses += 1;
+                }
+            }
+
+            // decode without holding the lock, such that other threads are not blocked by it
+            auto* pixbuf = image_cache_decode(path, error);
+            if (pixbuf == nullptr or stamp.empty())
+                return pixbuf;
+
+            auto lock = std::lock_guard(cache->mutex);
+            if (not cache->enabled)
+                return pixbuf;
+
+            // another thread may have decoded the same file in the meantime
+            auto* existing = image_cache_find(cache, path, stamp);
+            if (existing != nullptr)
+            {
+                g_object_unref(pixbuf);
+                return GDK_PIXBUF(g_object_ref(existing->pixbuf));
+            }
+
+            const uint64_t n_bytes = gdk_pixbuf_get_byte_length(pixbuf);
+            if (n_bytes > cache->memory_budget)
+                return pixbuf;
+
+            cache->lru.push_front(path);
+
+            auto& entry = cache->entries[path];
+            entry.stamp = stamp;
+            entry.pixbuf = GDK_PIXBUF(g_object_ref(pixbuf));
+            entry.n_bytes = n_bytes;
+            entry.lru_position = cache->lru.begin();
+
+            cache->memory_usage += n_bytes;
+            image_cache_evict(cache);
+            return pixbuf;
+        }
+
+        GdkTexture* image_cache_get_gdk_texture(const std::string& path, GError** error)
+        {
+            auto* pixbuf = image_cache_get_pixbuf(path, error);
+            if (pixbuf == nullptr)
+                return nullptr;
+
+            auto* cache = image_cache_get();
+            {
+                auto lock = std::lock_guard(cache->mutex);
+                auto it = cache->entries.find(path);
+                if (it != cache->entries.end() and it->second.pixbuf == pixbuf and it->second.gdk_texture != nullptr)
+                {
+                    g_object_unref(pixbuf);
+                    return GDK_TEXTURE(g_object_ref(it->second.gdk_texture));
+                }
+            }
+
+            // pixels are referenced, not copied, so the texture does not count towards memory usage. gdk_pixbuf_read_pixel_bytes would copy them
+            auto* bytes = pixbuf_get_pixel_bytes(pixbuf);
+            auto* texture = gdk_memory_texture_new(
+                gdk_pixbuf_get_width(pixbuf),
+                gdk_pixbuf_get_height(pixbuf),
+                gdk_pixbuf_get_has_alpha(pixbuf) ? GDK_MEMORY_R8G8B8A8 : GDK_MEMORY_R8G8B8,
+                bytes,
+                gdk_pixbuf_get_rowstride(pixbuf)
+            );
+            g_bytes_unref(bytes);
+
+            auto lock = std::lock_guard(cache->mutex);
+            auto it = cache->entries.find(path);
+            if (it != cache->entries.end() and it->second.pixbuf == pixbuf and it->second.gdk_texture == nullptr)
+                it->second.gdk_texture = GDK_TEXTURE(g_object_ref(texture));
+
+            g_object_unref(pixbuf);
+            return texture;
+        }
+    }
+
+    void image_cache::set_enabled(bool b)
+    {
+        auto* cache = detail::image_cache_get();
+        auto lock = std::lock_guard(cache->mutex);
+        cache->enabled = b;
+
+        if (not b)
+            while (not cache->entries.empty())
+                detail::image_cache_remove(cache, cache->entries.begin());
+    }
+
+    bool image_cache::get_enabled()
+    {
+        auto* cache = detail::image_cache_get();
+        auto lock = std::lock_guard(cache->mutex);
+        return cache->enabled;
+    }
+
+    void image_cache::set_memory_budget(uint64_t n_bytes)
+    {
+        auto* cache = detail::image_cache_get();
+        auto lock = std::lock_guard(cache->mutex);
+        cache->memory_budget = n_bytes;
+        detail::image_cache_evict(cache);
+    }
+
+    uint64_t image_cache::get_memory_budget()
+    {
+        auto* cache = detail::image_cache_get();
+        auto lock = std::lock_guard(cache->mutex);
+        return cache->memory_budget;
+    }
+
+    void image_cache::invalidate(const std::string& path)
+    {
+        auto* cache = detail::image_cache_get();
+        auto lock = std::lock_guard(cache->mutex);
+
+        auto it = cache->entries.find(path);
+        if (it != cache->entries.end())
+            detail::image_cache_remove(cache, it);
+    }
+
+    void image_cache::clear()
+    {
+        auto* cache = detail::image_cache_get();
+        auto lock = std::lock_guard(cache->mutex);
+
+        while (not cache->entries.empty())
+            detail::image_cache_remove(cache, cache->entries.begin());
+    }
+
+    ImageCacheStatistics image_cache::get_statistics()
+    {
+        auto* cache = detail::image_cache_get();
+        auto lock = std::lock_guard(cache->mutex);
+
+        auto out = ImageCacheStatistics();
+        out.n_hits = cache->n_hits;
+        out.n_misses = cache->n_misses;
+        out.hit_rate = cache->n_hits + cache->n_misses == 0 ? 0 : float(cache->n_hits) / float(cache->n_hits + cache->n_misses);
+        out.n_evictions = cache->n_evictions;
+        out.n_entries = cache->entries.size();
+        out.memory_usage = cache->memory_usage;
+        out.gpu_memory_usage = cache->gpu_memory_usage;
+        return out;
+    }
+
+    void image_cache::reset_statistics()
+    {
+        auto* cache = detail::image_cache_get();
+        auto lock = std::lock_guard(cache->mutex);
+
+        cache->n_hits = 0;
+        cache->n_misses = 0;
+        cache->n_evictions = 0;
+    }
+
+    #if MOUSETRAP_ENABLE_OPENGL_COMPONENT
+
+    Texture image_cache::get_texture(const std::string& path)
+    {
+        if (detail::is_opengl_disabled())
+            return Texture();
+
+        auto* cache = detail::image_cache_get();
+        auto stamp = detail::image_cache_get_stamp(path);
+        {
+            auto lock = std::lock_guard(cache->mutex);
+            auto* entry = cache->enabled and not stamp.empty() ? detail::image_cache_find(cache, path, stamp) : nullptr;
+            if (entry != nullptr and entry->texture != nullptr)
+            {
+                cache->n_hits += 1;
+                return Texture((detail::TextureInternal*) entry->texture);
+            }
+        }
+
+        // counts as a hit if only the pixels were cached, those are uploaded without copying
+        auto texture = Texture();
+        if (not texture.create_from_file(path))
+            return Texture();
+
+        auto* texture_internal = (detail::TextureInternal*) texture.get_internal();
+        const uint64_t n_gpu_bytes = detail::texture_get_n_bytes(texture_internal);
+
+        {
+            auto lock = std::lock_guard(cache->mutex);
+            auto it = cache->entries.find(path);
+            if (it != cache->entries.end() and it->second.texture == nullptr)
+            {
+                it->second.texture = G_OBJECT(g_object_ref(texture_internal));
+                it->second.n_gpu_bytes = n_gpu_bytes;
+                cache->gpu_memory_usage += it->second.n_gpu_bytes;
+                detail::image_cache_evict(cache);
+            }
+        }
+
+        return Texture(texture_internal);
+    }
+
+    #endif
+}
@@ -4,24 +4,55 @@
 //
 
 #include <mousetrap/image_display.hpp>
+#include <mousetrap/image_cache.hpp>
+#include <mousetrap/raw_image.hpp>
 #include <mousetrap/log.hpp>
 
 #include <iostream>
+#include <mutex>
+#include <cstring>
 
 namespace mousetrap
 {
     namespace detail
     {
+        struct ImageDisplayFrame;
+
         struct _ImageDisplayInternal
         {
             GObject parent;
             GtkImage* native;
             Vector2ui size;
+
+            // buffers not currently referenced by a texture, all of the same size. Textures may be released off the main thread, so access is locked
+            std::vector<ImageDisplayFrame*>* frame_pool;
+            std::mutex* frame_pool_mutex;
         };
 
+        struct ImageDisplayFrame
+        {
+            ImageDisplayInternal* owner;
+            std::vector<uint8_t> data;
+        };
+
+        // number of frame buffers kept for reuse, one displayed, one waiting for gtk to release it, one being written
+        static constexpr uint64_t image_display_max_n_pooled_frames = 3;
+
         DECLARE_NEW_TYPE(ImageDisplayInternal, image_display_internal, IMAGE_DISPLAY_INTERNAL)
+
+        static void image_display_internal_finalize(GObject* object)
+        {
+            auto* self = MOUSETRAP_IMAGE_DISPLAY_INTERNAL(object);
+            G_OBJECT_CLASS(image_display_internal_parent_class)->finalize(object);
+
+            for (auto* frame : *self->frame_pool)
+                delete frame;
+
+            delete self->frame_pool;
+            delete self->frame_pool_mutex;
+        }
+
         DEFINE_NEW_TYPE_TRIVIAL_INIT(ImageDisplayInternal, image_display_internal, IMAGE_DISPLAY_INTERNAL)
-        DEFINE_NEW_TYPE_TRIVIAL_FINALIZE(ImageDisplayInternal, image_display_internal, IMAGE_DISPLAY_INTERNAL)
         DEFINE_NEW_TYPE_TRIVIAL_CLASS_INIT(ImageDisplayInternal, image_display_internal, IMAGE_DISPLAY_INTERNAL)
 
         static ImageDisplayInternal* image_display_internal_new(GtkImage* image)
@@ -30,8 +61,67 @@ namespace mousetrap
             image_display_internal_init(self);
             self->native = image;
             self->size = {0, 0};
+            self->frame_pool = new std::vector<ImageDisplayFrame*>();
+            self->frame_pool_mutex = new std::mutex();
             return self;
         }
+
+        // free func of the GBytes backing a frame texture
+        static void image_display_frame_release(ImageDisplayFrame* frame)
+        {
+            auto* owner = frame->owner;
+            {
+                std::lock_guard<std::mutex> lock(*owner->frame_pool_mutex);
+                auto& pool = *owner->frame_pool;
+
+                // frames of an outdated size are not reused
+                bool keep = pool.size() < image_display_max_n_pooled_frames and (pool.empty() or pool.front()->data.size() == frame->data.size());
+                if (keep)
+                    pool.push_back(frame);
+                else
+                    delete frame;
+            }
+
+            g_object_unref(owner);
+        }
+
+        static ImageDisplayFrame* image_display_frame_acquire(ImageDisplayInternal* self, uint64_t n_bytes)
+        {
+            ImageDisplayFrame* frame = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(*self->frame_pool_mutex);
+                auto& pool = *self->frame_pool;
+                if (not pool.empty() and pool.front()->data.size() != n_bytes)
+                {
+                    for (auto* outdated : pool)
+                        delete outdated;
+
+                    pool.clear();
+                }
+
+                if (not pool.empty())
+                {
+                    frame = pool.back();
+                    pool.pop_back();
+                }
+            }
+
+            if (frame == nullptr)
+            {
+                frame = new ImageDisplayFrame();
+                frame->data.resize(n_bytes);
+            }
+
+            // released in image_display_frame_release, keeps the pool alive while gtk holds the texture
+            frame->owner = g_object_ref(self);
+            return frame;
+        }
+
+        // wrap pixel data in a texture without copying, bytes are unreferenced by the caller
+        static GdkTexture* image_display_texture_new(uint64_t width, uint64_t height, bool has_alpha, GBytes* bytes, uint64_t rowstride)
+        {
+            return gdk_memory_texture_new(width, height, has_alpha ? GDK_MEMORY_R8G8B8A8 : GDK_MEMORY_R8G8B8, bytes, rowstride);
+        }
     }
 
     void ImageDisplay::initialize()
@@ -131,8 +221,19 @@ namespace mousetrap
     {
         gtk_image_clear(GTK_IMAGE(operator NativeWidget()));
 
+        // gdk cannot read raw files, they are mapped by Image instead
+        if (detail::raw_image_has_magic(path))
+        {
+            auto image = Image();
+            if (not image.create_from_file(path))
+                return false;
+
+            create_from_image(image);
+            return true;
+        }
+
         GError* error = nullptr;
-        auto* pixbuf = gdk_pixbuf_new_from_file(path.c_str(), &error);
+        auto* texture = detail::image_cache_get_gdk_texture(path, &error);
 
         if (error != nullptr)
         {
@@ -141,22 +242,81 @@ namespace mousetrap
             return false;
         }
 
-        gtk_image_set_from_pixbuf(GTK_IMAGE(operator NativeWidget()), pixbuf);
+        // all displays of the same file share one texture
+        gtk_image_set_from_paintable(GTK_IMAGE(operator NativeWidget()), GDK_PAINTABLE(texture));
 
-        _internal->size.x = gdk_pixbuf_get_width(pixbuf);
-        _internal->size.y = gdk_pixbuf_get_height(pixbuf);
+        _internal->size.x = gdk_texture_get_width(texture);
+        _internal->size.y = gdk_texture_get_height(texture);
 
-        g_object_unref(pixbuf);
+        g_object_unref(texture);
         return true;
     }
 
     void ImageDisplay::create_from_image(const Image& image)
     {
+        // gdk textures are 8-bit, the converted pixbuf is kept alive by the texture
+        if (image.get_format() != ImageFormat::RGBA8)
+        {
+            create_from_image(image.as_format(ImageFormat::RGBA8));
+            return;
+        }
+
         gtk_image_clear(GTK_IMAGE(operator NativeWidget()));
-        gtk_image_set_from_pixbuf(GTK_IMAGE(operator NativeWidget()), image.operator GdkPixbuf*());
+
+        auto* pixbuf = image.operator GdkPixbuf*();
+        if (pixbuf == nullptr or image.get_size().x == 0 or image.get_size().y == 0)
+        {
+            update_size(0, 0);
+            return;
+        }
+
+        // bytes reference the pixbuf instead of copying its pixels
+        auto* bytes = detail::pixbuf_get_pixel_bytes(pixbuf);
+        auto* texture = detail::image_display_texture_new(image.get_size().x, image.get_size().y, gdk_pixbuf_get_has_alpha(pixbuf), bytes, image.get_rowstride());
+        gtk_image_set_from_paintable(GTK_IMAGE(operator NativeWidget()), GDK_PAINTABLE(texture));
+
+        g_object_unref(texture);
+        g_bytes_unref(bytes);
         _internal->size = image.get_size();
     }
 
+    void ImageDisplay::update(const Image& frame)
+    {
+        const uint64_t width = frame.get_size().x;
+        const uint64_t height = frame.get_size().y;
+        if (width == 0 or height == 0)
+        {
+            clear();
+            return;
+        }
+
+        if (frame.get_format() != ImageFormat::RGBA8)
+        {
+            update(frame.as_format(ImageFormat::RGBA8));
+            return;
+        }
+
+        const uint64_t row_size = width * frame.get_n_channels();
+        auto* buffer = detail::image_display_frame_acquire(_internal, row_size * height);
+
+        // pooled buffers are tightly packed, the source may have padding at the end of each row
+        auto* in = static_cast<const uint8_t*>(frame.data());
+        const uint64_t in_rowstride = frame.get_rowstride();
+        if (in_rowstride == row_size)
+            std::memcpy(buffer->data.data(), in, row_size * height);
+        else
+            for (uint64_t y = 0; y < height; ++y)
+                std::memcpy(buffer->data.data() + y * row_size, in + y * in_rowstride, row_size);
+
+        auto* bytes = g_bytes_new_with_free_func(buffer->data.data(), buffer->data.size(), (GDestroyNotify) detail::image_display_frame_release, buffer);
+        auto* texture = detail::image_display_texture_new(width, height, frame.get_n_channels() == 4, bytes, row_size);
+        gtk_image_set_from_paintable(GTK_IMAGE(operator NativeWidget()), GDK_PAINTABLE(texture));
+
+        g_object_unref(texture);
+        g_bytes_unref(bytes);
+        update_size(width, height);
+    }
+
     void ImageDisplay::create_from_icon(const Icon& icon)
     {
         auto size = icon.get_size() * Vector2ui(icon.get_scale());
@@ -0,0 +1,384 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/18/26
+//
+
+#include <mousetrap/gl_common.hpp>
+#if MOUSETRAP_ENABLE_OPENGL_COMPONENT
+
+#include <mousetrap/immediate_draw.hpp>
+#include <mousetrap/render_area.hpp>
+#include <mousetrap/log.hpp>
+
+#include <cstring>
+#include <cassert>
+#include <algorithm>
+
+namespace mousetrap
+{
+    namespace detail
+    {
+        static void streaming_vertex_buffer_allocate(StreamingVertexBuffer* self)
+        {
+            glGenVertexArrays(1, &self->vertex_array_id);
+            glGenBuffers(1, &self->buffer_id);
+
+            glBindVertexArray(self->vertex_array_id);
+            glBindBuffer(GL_ARRAY_BUFFER, self->buffer_id);
+
+            auto n_bytes = StreamingVertexBuffer::n_regions * self->region_size * sizeof(VertexInfo);
+
+            if (GLEW_ARB_buffer_storage)
+            {
+                // coherent mapping, writes become visible to the gpu without an explicit flush
+                GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+                glBufferStorage(GL_ARRAY_BUFFER, n_bytes, nullptr, flags);
+                self->mapped = (VertexInfo*) glMapBufferRange(GL_ARRAY_BUFFER, 0, n_bytes, flags);
+            }
+            else
+            {
+                glBufferData(GL_ARRAY_BUFFER, n_bytes, nullptr, GL_STREAM_DRAW);
+                self->mapped = nullptr;
+            }
+
+            auto position_location = Shader::get_vertex_position_location();
+            glEnableVertexAttribArray(position_location);
+            glVertexAttribPointer(position_location, 3, GL_FLOAT, GL_FALSE, sizeof(VertexInfo), (GLvoid*) (G_STRUCT_OFFSET(VertexInfo, _position)));
+
+            auto color_location = Shader::get_vertex_color_location();
+            glEnableVertexAttribArray(color_location);
+            glVertexAttribPointer(color_location, 4, GL_FLOAT, GL_FALSE, sizeof(VertexInfo), (GLvoid*) (G_STRUCT_OFFSET(VertexInfo, _color)));
+
+            auto texture_coordinate_location = Shader::get_vertex_texture_coordinate_location();
+            glEnableVertexAttribArray(texture_coordinate_location);
+            glVertexAttribPointer(texture_coordinate_location, 2, GL_FLOAT, GL_FALSE, sizeof(VertexInfo), (GLvoid*) (G_STRUCT_OFFSET(VertexInfo, _texture_coordinates)));
+
+            glBindVertexArray(0);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+
+        static void streaming_vertex_buffer_release(StreamingVertexBuffer* self)
+        {
+            for (auto& fence : self->fences)
+            {
+                if (fence != nullptr)
+                    glDeleteSync(fence);
+
+                fence = nullptr;
+            }
+
+            if (self->mapped != nullptr)
+            {
+                glBindBuffer(GL_ARRAY_BUFFER, self->buffer_id);
+                glUnmapBuffer(GL_ARRAY_BUFFER);
+                glBindBuffer(GL_ARRAY_BUFFER, 0);
+                self->mapped = nullptr;
+            }
+
+            if (self->buffer_id != 0)
+                glDeleteBuffers(1, &self->buffer_id);
+
+            if (self->vertex_array_id != 0)
+                glDeleteVertexArrays(1, &self->vertex_array_id);
+
+            self->buffer_id = 0;
+            self->vertex_array_id = 0;
+        }
+
+        StreamingVertexBuffer* streaming_vertex_buffer_new(uint64_t region_size)
+        {
+            auto* self = new StreamingVertexBuffer();
+            self->region_size = region_size;
+            streaming_vertex_buffer_allocate(self);
+            return self;
+        }
+
+        void streaming_vertex_buffer_free(StreamingVertexBuffer* self)
+        {
+            if (self == nullptr)
+                return;
+
+            streaming_vertex_buffer_release(self);
+            delete self;
+        }
+
+        void streaming_vertex_buffer_begin_frame(StreamingVertexBuffer* self, uint64_t n_vertices)
+        {
+            self->n_written = 0;
+
+            if (n_vertices > self->region_size)
+            {
+                // the driver keeps the old storage alive until all pending draws reading from it are done
+                streaming_vertex_buffer_release(self);
+                self->region_size = std::max<uint64_t>(n_vertices, 2 * self->region_size);
+                self->current_region = 0;
+                streaming_vertex_buffer_allocate(self);
+                return;
+            }
+
+            // first region the gpu is done reading from, starting after the current one. Regions that are still in use are skipped
+            for (uint64_t i = 1; i <= StreamingVertexBuffer::n_regions; ++i)
+            {
+                auto region = (self->current_region + i) % StreamingVertexBuffer::n_regions;
+                auto& fence = self->fences[region];
+                if (fence != nullptr)
+                {
+                    auto status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+                    if (status == GL_TIMEOUT_EXPIRED)
+                        continue;
+
+                    if (status == GL_WAIT_FAILED)
+                        log::critical("In streaming_vertex_buffer_begin_frame: glClientWaitSync failed", MOUSETRAP_DOMAIN);
+
+                    glDeleteSync(fence);
+                    fence = nullptr;
+                }
+
+                self->current_region = region;
+                return;
+            }
+
+            // every region is in use, wait a bounded time for the oldest one, then replace the storage instead of stalling the main thread
+            auto region = (self->current_region + 1) % StreamingVertexBuffer::n_regions;
+            auto& fence = self->fences[region];
+
+            const GLuint64 timeout = 1000000; // 1ms, in ns
+            if (glClientWaitSync(fence, 0, timeout) == GL_TIMEOUT_EXPIRED)
+            {
+                streaming_vertex_buffer_release(self);
+                self->current_region = 0;
+                streaming_vertex_buffer_allocate(self);
+                return;
+            }
+
+            glDeleteSync(fence);
+            fence = nullptr;
+            self->current_region = region;
+        }
+
+        uint64_t streaming_vertex_buffer_write(StreamingVertexBuffer* self, const VertexInfo* data, uint64_t n_vertices)
+        {
+            assert(self->n_written + n_vertices <= self->region_size);
+
+            uint64_t first = self->current_region * self->region_size + self->n_written;
+            if (self->mapped != nullptr)
+                std::memcpy(self->mapped + first, data, n_vertices * sizeof(VertexInfo));
+            else
+            {
+                glBindBuffer(GL_ARRAY_BUFFER, self->buffer_id);
+                glBufferSubData(GL_ARRAY_BUFFER, first * sizeof(VertexInfo), n_vertices * sizeof(VertexInfo), data);
+                glBindBuffer(GL_ARRAY_BUFFER, 0);
+            }
+
+            self->n_written += n_vertices;
+            return first;
+        }
+
+        void streaming_vertex_buffer_end_frame(StreamingVertexBuffer* self)
+        {
+            auto& fence = self->fences[self->current_region];
+            if (fence != nullptr)
+                glDeleteSync(fence);
+
+            fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        }
+    }
+
+    namespace detail
+    {
+        DECLARE_NEW_TYPE(ImmediateDrawInternal, immediate_draw_internal, IMMEDIATE_DRAW_INTERNAL)
+
+        static void immediate_draw_internal_finalize(GObject* object)
+        {
+            auto* self = MOUSETRAP_IMMEDIATE_DRAW_INTERNAL(object);
+            G_OBJECT_CLASS(immediate_draw_internal_parent_class)->finalize(object);
+
+            if (detail::is_opengl_disabled())
+                return;
+
+            delete self->triangles;
+            delete self->lines;
+            delete self->points;
+
+            if (self->buffer != nullptr)
+            {
+                detail::make_opengl_context_current();
+                delete self->shader;
+                streaming_vertex_buffer_free(self->buffer);
+            }
+        }
+
+        DEFINE_NEW_TYPE_TRIVIAL_INIT(ImmediateDrawInternal, immediate_draw_internal, IMMEDIATE_DRAW_INTERNAL)
+        DEFINE_NEW_TYPE_TRIVIAL_CLASS_INIT(ImmediateDrawInternal, immediate_draw_internal, IMMEDIATE_DRAW_INTERNAL)
+
+        ImmediateDrawInternal* immediate_draw_internal_new()
+        {
+            auto* self = (ImmediateDrawInternal*) g_object_new(immediate_draw_internal_get_type(), nullptr);
+            immediate_draw_internal_init(self);
+
+            if (detail::is_opengl_disabled())
+            {
+                log::critical("In immediate_draw_internal_new: Trying to instantiate mousetrap::ImmediateDraw, but the OpenGL component is disabled", MOUSETRAP_DOMAIN);
+                return self;
+            }
+
+            self->triangles = new std::vector<VertexInfo>();
+            self->lines = new std::vector<VertexInfo>();
+            self->points = new std::vector<VertexInfo>();
+
+            // allocated on the first flush with queued primitives, most render areas never use immediate mode
+            self->buffer = nullptr;
+            self->shader = nullptr;
+
+            return self;
+        }
+
+        static void immediate_draw_push_vertex(std::vector<VertexInfo>* out, Vector2f position, RGBA color)
+        {
+            auto gl_position = to_gl_position(position);
+            out->push_back(VertexInfo{
+                {gl_position.x, gl_position.y, 0},
+                {color.r, color.g, color.b, color.a},
+                {0, 0}
+            });
+        }
+
+        void immediate_draw_flush(ImmediateDrawInternal* self)
+        {
+            if (detail::is_opengl_disabled())
+                return;
+
+            uint64_t n_vertices = self->triangles->size() + self->lines->size() + self->points->size();
+            if (n_vertices == 0)
+                return;
+
+            if (self->buffer == nullptr)
+            {
+                self->buffer = streaming_vertex_buffer_new(std::max<uint64_t>(n_vertices, 1 << 10));
+                self->shader = new Shader();
+            }
+
+            streaming_vertex_buffer_begin_frame(self->buffer, n_vertices);
+
+            auto identity = GLTransform();
+            auto* shader_internal = (ShaderInternal*) self->shader->get_internal();
+            glUseProgram(self->shader->get_program_id());
+            glUniformMatrix4fv(shader_internal->transform_location, 1, GL_FALSE, &(identity.transform[0][0]));
+            glUniformMatrix4fv(shader_internal->model_transform_location, 1, GL_FALSE, &(identity.transform[0][0]));
+            glUniform1i(shader_internal->texture_set_location, GL_FALSE);
+
+            glBindVertexArray(self->buffer->vertex_array_id);
+
+            for (auto pair : {
+                std::make_pair(self->triangles, GL_TRIANGLES),
+                std::make_pair(self->lines, GL_LINES),
+                std::make_pair(self->points, GL_POINTS)
+            })
+            {
+                auto* vertices = pair.first;
+                if (vertices->empty())
+                    continue;
+
+                auto first = streaming_vertex_buffer_write(self->buffer, vertices->data(), vertices->size());
+                glDrawArrays(pair.second, first, vertices->size());
+
+                // keeps capacity, no allocation once the queue reached its steady-state size
+                vertices->clear();
+            }
+
+            glBindVertexArray(0);
+            glUseProgram(0);
+
+            streaming_vertex_buffer_end_frame(self->buffer);
+        }
+    }
+
+    ImmediateDraw::ImmediateDraw(detail::ImmediateDrawInternal* internal)
+    {
+        if (detail::is_opengl_disabled())
+        {
+            _internal = nullptr;
+            return;
+        }
+
+        _internal = g_object_ref(internal);
+    }
+
+    ImmediateDraw::~ImmediateDraw()
+    {
+        if (not detail::is_opengl_disabled())
+            g_object_unref(_internal);
+    }
+
+    void ImmediateDraw::add_triangle(Vector2f a, Vector2f b, Vector2f c, RGBA color)
+    {
+        if (detail::is_opengl_disabled())
+            return;
+
+        detail::immediate_draw_push_vertex(_internal->triangles, a, color);
+        detail::immediate_draw_push_vertex(_internal->triangles, b, color);
+        detail::immediate_draw_push_vertex(_internal->triangles, c, color);
+    }
+
+    void ImmediateDraw::add_rectangle(Vector2f top_left, Vector2f size, RGBA color)
+    {
+        if (detail::is_opengl_disabled())
+            return;
+
+        auto top_right = Vector2f(top_left.x + size.x, top_left.y);
+        auto bottom_right = Vector2f(top_left.x + size.x, top_left.y - size.y);
+        auto bottom_left = Vector2f(top_left.x, top_left.y - size.y);
+
+        add_triangle(top_left, top_right, bottom_right, color);
+        add_triangle(top_left, bottom_right, bottom_left, color);
+    }
+
+    void ImmediateDraw::add_line(Vector2f a, Vector2f b, RGBA color)
+    {
+        if (detail::is_opengl_disabled())
+            return;
+
+        detail::immediate_draw_push_vertex(_internal->lines, a, color);
+        detail::immediate_draw_push_vertex(_internal->lines, b, color);
+    }
+
+    void ImmediateDraw::add_point(Vector2f position, RGBA color)
+    {
+        if (detail::is_opengl_disabled())
+            return;
+
+        detail::immediate_draw_push_vertex(_internal->points, position, color);
+    }
+
+    void ImmediateDraw::clear()
+    {
+        if (detail::is_opengl_disabled())
+            return;
+
+        _internal->triangles->clear();
+        _internal->lines->clear();
+        _internal->points->clear();
+    }
+
+    uint64_t ImmediateDraw::get_n_vertices() const
+    {
+        if (detail::is_opengl_disabled())
+            return 0;
+
+        return _internal->triangles->size() + _internal->lines->size() + _internal->points->size();
+    }
+
+    NativeObject ImmediateDraw::get_internal() const
+    {
+        if (detail::is_opengl_disabled())
+            return nullptr;
+
+        return G_OBJECT(_internal);
+    }
+
+    ImmediateDraw::operator NativeObject() const
+    {
+        return get_internal();
+    }
+}
+
+#endif // MOUSETRAP_ENABLE_OPENGL_COMPONENT
@@ -26,6 +26,9 @@ namespace mousetrap
             if (internal->msaa_color_buffer_texture != 0)
                 glDeleteTextures(1, &internal->msaa_color_buffer_texture);
 
+            if (internal->msaa_depth_buffer != 0)
+                glDeleteRenderbuffers(1, &internal->msaa_depth_buffer);
+
             if (internal->intermediate_buffer != 0)
                 glDeleteFramebuffers(1, &internal->intermediate_buffer);
 
@@ -118,6 +121,13 @@ namespace mousetrap
         glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, 0);
         glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D_MULTISAMPLE, _internal->msaa_color_buffer_texture, 0);
 
+        // only used by render areas with depth testing enabled, never resolved
+        glGenRenderbuffers(1, &_internal->msaa_depth_buffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, _internal->msaa_depth_buffer);
+        glRenderbufferStorageMultisample(GL_RENDERBUFFER, _internal->n_samples, GL_DEPTH_COMPONENT24, width, height);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, _internal->msaa_depth_buffer);
+
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
         glGenFramebuffers(1, &_internal->intermediate_buffer);
@@ -194,6 +204,9 @@ namespace mousetrap
         if (_internal->msaa_color_buffer_texture != 0)
             glDeleteTextures(1, &_internal->msaa_color_buffer_texture);
 
+        if (_internal->msaa_depth_buffer != 0)
+            glDeleteRenderbuffers(1, &_internal->msaa_depth_buffer);
+
         if (_internal->intermediate_buffer != 0)
             glDeleteFramebuffers(1, &_internal->intermediate_buffer);
 
@@ -0,0 +1,382 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/18/26
+//
+
+#include <mousetrap/gl_common.hpp>
+#if MOUSETRAP_ENABLE_OPENGL_COMPONENT
+
+#include <mousetrap/post_process_chain.hpp>
+#include <mousetrap/log.hpp>
+
+#include <cmath>
+#include <algorithm>
+#include <sstream>
+
+namespace mousetrap
+{
+    namespace detail
+    {
+        DECLARE_NEW_TYPE(PostProcessChainInternal, post_process_chain_internal, POST_PROCESS_CHAIN_INTERNAL)
+
+        static void post_process_chain_internal_finalize(GObject* object)
+        {
+            auto* self = MOUSETRAP_POST_PROCESS_CHAIN_INTERNAL(object);
+            G_OBJECT_CLASS(post_process_chain_internal_parent_class)->finalize(object);
+
+            if (detail::is_opengl_disabled())
+                return;
+
+            for (auto& pass : *self->passes)
+                g_object_unref(pass.task);
+
+            for (auto* shader : *self->owned_shaders)
+                delete shader;
+
+            delete self->passes;
+            delete self->owned_shaders;
+            delete self->shape;
+
+            if (self->scene_depth_buffer != 0)
+                glDeleteRenderbuffers(1, &self->scene_depth_buffer);
+
+            for (uint64_t i = 0; i < 2; ++i)
+            {
+                delete self->full_resolution[i];
+                delete self->half_resolution[i];
+            }
+        }
+
+        DEFINE_NEW_TYPE_TRIVIAL_INIT(PostProcessChainInternal, post_process_chain_internal, POST_PROCESS_CHAIN_INTERNAL)
+        DEFINE_NEW_TYPE_TRIVIAL_CLASS_INIT(PostProcessChainInternal, post_process_chain_internal, POST_PROCESS_CHAIN_INTERNAL)
+
+        PostProcessChainInternal* post_process_chain_internal_new()
+        {
+            auto* self = (PostProcessChainInternal*) g_object_new(post_process_chain_internal_get_type(), nullptr);
+            post_process_chain_internal_init(self);
+
+            if (detail::is_opengl_disabled())
+            {
+                log::critical("In post_process_chain_internal_new: Trying to instantiate mousetrap::PostProcessChain, but the OpenGL component is disabled", MOUSETRAP_DOMAIN);
+                return self;
+            }
+
+            detail::make_opengl_context_current();
+
+            self->passes = new std::vector<PostProcessPass>();
+            self->owned_shaders = new std::vector<Shader*>();
+
+            self->shape = new Shape();
+            self->shape->as_rectangle({-1, 1}, {2, 2});
+            self->shape->set_vertex_texture_coordinate(0, {0, 1});
+            self->shape->set_vertex_texture_coordinate(1, {1, 1});
+            self->shape->set_vertex_texture_coordinate(2, {1, 0});
+            self->shape->set_vertex_texture_coordinate(3, {0, 0});
+
+            for (uint64_t i = 0; i < 2; ++i)
+            {
+                self->full_resolution[i] = new RenderTexture();
+                self->full_resolution[i]->set_scale_mode(TextureScaleMode::LINEAR);
+
+                self->half_resolution[i] = new RenderTexture();
+                self->half_resolution[i]->set_scale_mode(TextureScaleMode::LINEAR);
+            }
+
+            self->half_resolution_allocated = false;
+            self->size = {0, 0};
+            self->allocated_size = {0, 0};
+            self->scene_depth_buffer = 0;
+            return self;
+        }
+
+        static void post_process_chain_allocate_half_resolution(PostProcessChainInternal* self)
+        {
+            if (self->size.x == 0 or self->size.y == 0)
+                return;
+
+            for (auto* target : self->half_resolution)
+                target->create(std::max(self->size.x / 2, 1), std::max(self->size.y / 2, 1));
+
+            self->half_resolution_allocated = true;
+        }
+
+        // an empty chain is never bound, so its targets are not allocated until the first pass is added
+        static void post_process_chain_allocate_full_resolution(PostProcessChainInternal* self)
+        {
+            auto size = self->size;
+            if (size.x == 0 or size.y == 0 or size == self->allocated_size)
+                return;
+
+            self->allocated_size = size;
+            for (auto* target : self->full_resolution)
+                target->create(size.x, size.y);
+
+            if (self->scene_depth_buffer == 0)
+                glGenRenderbuffers(1, &self->scene_depth_buffer);
+
+            GLint before = 0;
+            glGetIntegerv(GL_FRAMEBUFFER_BINDING, &before);
+            glBindRenderbuffer(GL_RENDERBUFFER, self->scene_depth_buffer);
+            glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, size.x, size.y);
+            glBindRenderbuffer(GL_RENDERBUFFER, 0);
+            glBindFramebuffer(GL_FRAMEBUFFER, self->full_resolution[0]->get_native_handle());
+            glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, self->scene_depth_buffer);
+            glBindFramebuffer(GL_FRAMEBUFFER, before);
+        }
+
+        void post_process_chain_resize(PostProcessChainInternal* self, Vector2i size)
+        {
+            if (detail::is_opengl_disabled() or size == self->size)
+                return;
+
+            self->size = size;
+            self->half_resolution_allocated = false;
+
+            if (self->passes->empty())
+                return;
+
+            post_process_chain_allocate_full_resolution(self);
+
+            // half resolution targets are only allocated once a pass uses them
+            for (auto& pass : *self->passes)
+            {
+                if (pass.half_resolution)
+                {
+                    post_process_chain_allocate_half_resolution(self);
+                    break;
+                }
+            }
+        }
+
+        bool post_process_chain_begin(PostProcessChainInternal* self)
+        {
+            if (detail::is_opengl_disabled() or self->passes->empty() or self->size.x == 0 or self->size.y == 0)
+                return false;
+
+            self->full_resolution[0]->bind_as_render_target();
+            return true;
+        }
+
+        void post_process_chain_end(PostProcessChainInternal* self)
+        {
+            if (detail::is_opengl_disabled())
+                return;
+
+            self->full_resolution[0]->unbind_as_render_target();
+
+            GLint screen_buffer;
+            GLint screen_viewport[4];
+            glGetIntegerv(GL_FRAMEBUFFER_BINDING, &screen_buffer);
+            glGetIntegerv(GL_VIEWPORT, screen_viewport);
+
+            RenderTexture* source = self->full_resolution[0];
+            uint64_t n_passes = self->passes->size();
+
+            for (uint64_t i = 0; i < n_passes; ++i)
+            {
+                auto& pass = self->passes->at(i);
+                bool is_last = i == n_passes - 1;
+
+                RenderTexture* destination = nullptr;
+                if (not is_last)
+                {
+                    auto** targets = pass.half_resolution ? self->half_resolution : self->full_resolution;
+                    destination = targets[0] == source ? targets[1] : targets[0];
+                    destination->bind_as_render_target();
+                }
+
+                auto source_size = source->get_size();
+                (*pass.task->_vec2s)["_texel_size"] = Vector2f(1.f / source_size.x, 1.f / source_size.y);
+
+                self->shape->set_texture(source);
+                RenderTask(pass.task).render();
+
+                if (destination != nullptr)
+                {
+                    destination->unbind_as_render_target();
+                    source = destination;
+                }
+            }
+
+            glBindFramebuffer(GL_FRAMEBUFFER, screen_buffer);
+            glViewport(screen_viewport[0], screen_viewport[1], screen_viewport[2], screen_viewport[3]);
+        }
+
+        static std::string post_process_separable_shader_source(const std::vector<float>& kernel, Vector2f direction)
+        {
+            std::stringstream str;
+            str << R"(
+                #version 130
+
+                in vec4 _vertex_color;
+                in vec2 _texture_coordinates;
+                in vec3 _vertex_position;
+
+                out vec4 _fragment_color;
+
+                uniform int _texture_set;
+                uniform sampler2D _texture;
+                uniform vec2 _texel_size;
+            )";
+
+            str << "const int _kernel_radius = " << kernel.size() - 1 << ";\n";
+            str << "const float _kernel[" << kernel.size() << "] = float[](";
+            for (uint64_t i = 0; i < kernel.size(); ++i)
+                str << std::showpoint << kernel.at(i) << (i == kernel.size() - 1 ? "" : ", ");
+            str << ");\n";
+            str << "const vec2 _direction = vec2(" << std::showpoint << direction.x << ", " << direction.y << ");\n";
+
+            str << R"(
+                void main()
+                {
+                    vec4 sum = texture(_texture, _texture_coordinates) * _kernel[0];
+                    for (int i = 1; i <= _kernel_radius; ++i)
+                    {
+                        vec2 offset = _direction * _texel_size * float(i);
+                        sum += (texture(_texture, _texture_coordinates + offset) + texture(_texture, _texture_coordinates - offset)) * _kernel[i];
+                    }
+                    _fragment_color = sum;
+                }
+            )";
+
+            return str.str();
+        }
+    }
+
+    PostProcessChain::PostProcessChain(detail::PostProcessChainInternal* internal)
+    {
+        if (detail::is_opengl_disabled())
+        {
+            _internal = nullptr;
+            return;
+        }
+
+        _internal = g_object_ref(internal);
+    }
+
+    PostProcessChain::~PostProcessChain()
+    {
+        if (not detail::is_opengl_disabled())
+            g_object_unref(_internal);
+    }
+
+    NativeObject PostProcessChain::get_internal() const
+    {
+        if (detail::is_opengl_disabled())
+            return nullptr;
+
+        return G_OBJECT(_internal);
+    }
+
+    PostProcessChain::operator NativeObject() const
+    {
+        return get_internal();
+    }
+
+    uint64_t PostProcessChain::add_pass(const Shader& fragment_shader, bool half_resolution)
+    {
+        if (detail::is_opengl_disabled())
+            return 0;
+
+        auto task = RenderTask(*_internal->shape, &fragment_shader, GLTransform(), BlendMode::NONE);
+        auto* task_internal = (detail::RenderTaskInternal*) task.operator GObject*();
+        g_object_ref(task_internal);
+
+        _internal->passes->push_back({task_internal, half_resolution});
+
+        detail::make_opengl_context_current();
+        detail::post_process_chain_allocate_full_resolution(_internal);
+
+        if (half_resolution and not _internal->half_resolution_allocated)
+            detail::post_process_chain_allocate_half_resolution(_internal);
+
+        return _internal->passes->size() - 1;
+    }
+
+    uint64_t PostProcessChain::add_separable_pass(const std::vector<float>& kernel, bool half_resolution)
+    {
+        if (detail::is_opengl_disabled())
+            return 0;
+
+        if (kernel.empty())
+        {
+            log::critical("In PostProcessChain::add_separable_pass: kernel is empty", MOUSETRAP_DOMAIN);
+            return _internal->passes->size();
+        }
+
+        auto out = _internal->passes->size();
+        for (auto direction : {Vector2f(1, 0), Vector2f(0, 1)})
+        {
+            auto* shader = new Shader();
+            shader->create_from_string(ShaderType::FRAGMENT, detail::post_process_separable_shader_source(kernel, direction));
+            _internal->owned_shaders->push_back(shader);
+            add_pass(*shader, half_resolution);
+        }
+
+        return out;
+    }
+
+    uint64_t PostProcessChain::add_gaussian_blur(float sigma, bool half_resolution)
+    {
+        return add_separable_pass(gaussian_kernel(sigma), half_resolution);
+    }
+
+    std::vector<float> PostProcessChain::gaussian_kernel(float sigma)
+    {
+        if (sigma <= 0)
+            return {1};
+
+        uint64_t radius = std::ceil(3 * sigma);
+        auto out = std::vector<float>(radius + 1);
+
+        float sum = 0;
+        for (uint64_t i = 0; i <= radius; ++i)
+        {
+            out[i] = std::exp(-float(i * i) / (2 * sigma * sigma));
+            sum += i == 0 ? out[i] : 2 * out[i];
+        }
+
+        for (auto& weight : out)
+            weight /= sum;
+
+        return out;
+    }
+
+    RenderTask PostProcessChain::get_pass(uint64_t index) const
+    {
+        if (detail::is_opengl_disabled())
+            return RenderTask(nullptr);
+
+        if (index >= _internal->passes->size())
+        {
+            log::critical("In PostProcessChain::get_pass: index " + std::to_string(index) + " out of bounds for a chain with " + std::to_string(_internal->passes->size()) + " passes", MOUSETRAP_DOMAIN);
+            return RenderTask(nullptr);
+        }
+
+        return RenderTask(_internal->passes->at(index).task);
+    }
+
+    uint64_t PostProcessChain::get_n_passes() const
+    {
+        if (detail::is_opengl_disabled())
+            return 0;
+
+        return _internal->passes->size();
+    }
+
+    void PostProcessChain::clear()
+    {
+        if (detail::is_opengl_disabled())
+            return;
+
+        for (auto& pass : *_internal->passes)
+            g_object_unref(pass.task);
+
+        for (auto* shader : *_internal->owned_shaders)
+            delete shader;
+
+        _internal->passes->clear();
+        _internal->owned_shaders->clear();
+    }
+}
+
+#endif // MOUSETRAP_ENABLE_OPENGL_COMPONENT
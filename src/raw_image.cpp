@@ -0,0 +1,204 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/18/26
+//
+
+#include <mousetrap/raw_image.hpp>
+#include <mousetrap/thread_pool.hpp>
+
+#include <cstring>
+#include <algorithm>
+#include <fstream>
+
+namespace mousetrap
+{
+    namespace detail
+    {
+        static constexpr char RAW_IMAGE_MAGIC[8] = {'M', 'T', 'R', 'A', 'W', 'I', 'M', 'G'};
+        static constexpr uint32_t RAW_IMAGE_BYTE_ORDER = 0x01020304;
+        static constexpr uint32_t RAW_IMAGE_VERSION = 1;
+
+        // largest width or height accepted from a header, such that the size of all levels cannot overflow 64 bits
+        static constexpr uint64_t RAW_IMAGE_MAX_SIZE = uint64_t(1) << 24;
+
+        static uint64_t raw_image_get_pixel_size(ImageFormat format)
+        {
+            return image_format_get_n_channels(format) * image_format_get_value_size(format);
+        }
+
+        static uint64_t raw_image_align(uint64_t n)
+        {
+            return (n + raw_image_alignment - 1) / raw_image_alignment * raw_image_alignment;
+        }
+
+        // offset of a level from the start of the file, levels are stored consecutively after the header
+        static uint64_t raw_image_get_level_offset(ImageFormat format, uint64_t width, uint64_t height, uint64_t level)
+        {
+            uint64_t offset = raw_image_align(sizeof(RawImageHeader));
+            for (uint64_t i = 0; i < level; ++i)
+            {
+                offset += raw_image_align(width * height * raw_image_get_pixel_size(format));
+                width = std::max<uint64_t>(1, width / 2);
+                height = std::max<uint64_t>(1, height / 2);
+            }
+
+            return offset;
+        }
+
+        bool raw_image_has_magic(const std::string& path)
+        {
+            auto file = std::ifstream(path, std::ios::binary);
+            if (not file.is_open())
+                return false;
+
+            RawImageHeader header;
+            if (not file.read(reinterpret_cast<char*>(&header), sizeof(RawImageHeader)))
+                return false;
+
+            return std::memcmp(header.magic, RAW_IMAGE_MAGIC, sizeof(RAW_IMAGE_MAGIC)) == 0;
+        }
+
+        bool raw_image_open(const std::string& path, RawImageFile& out)
+        {
+            out = RawImageFile();
+
+            auto* mapped = g_mapped_file_new(path.c_str(), false, nullptr);
+            if (mapped == nullptr)
+                return false;
+
+            const uint64_t length = g_mapped_file_get_length(mapped);
+            const auto* header = reinterpret_cast<const RawImageHeader*>(g_mapped_file_get_contents(mapped));
+
+            bool valid = length >= sizeof(RawImageHeader)
+                and std::memcmp(header->magic, RAW_IMAGE_MAGIC, sizeof(RAW_IMAGE_MAGIC)) == 0
+                and header->byte_order == RAW_IMAGE_BYTE_ORDER
+                and header->version == RAW_IMAGE_VERSION
+                and header->format <= uint32_t(ImageFormat::R32F)
+                and header->width > 0 and header->width <= RAW_IMAGE_MAX_SIZE
+                and header->height > 0 and header->height <= RAW_IMAGE_MAX_SIZE
+                and header->n_levels > 0 and header->n_levels <= 64;
+
+            // a truncated file would otherwise be read past its end. With the size bounded above, no product or sum below can wrap
+            if (valid)
+            {
+                auto format = ImageFormat(header->format);
+                uint64_t width = std::max<uint64_t>(1, header->width >> (header->n_levels - 1));
+                uint64_t height = std::max<uint64_t>(1, header->height >> (header->n_levels - 1));
+                uint64_t end = raw_image_get_level_offset(format, header->width, header->height, header->n_levels - 1) + width * height * raw_image_get_pixel_size(format);
+                valid = end <= length;
+            }
+
+            if (not valid)
+            {
+                g_mapped_file_unref(mapped);
+                return false;
+            }
+
+            out.mapped = mapped;
+            out.header = header;
+            return true;
+        }
+
+        void raw_image_close(RawImageFile& file)
+        {
+            if (file.mapped != nullptr)
+                g_mapped_file_unref(file.mapped);
+
+            file = RawImageFile();
+        }
+
+        const uint8_t* raw_image_get_level(const RawImageFile& file, uint64_t level, uint64_t& width, uint64_t& height)
+        {
+            const auto* header = file.header;
+            width = std::max<uint64_t>(1, header->width >> level);
+            height = std::max<uint64_t>(1, header->height >> level);
+
+            auto offset = raw_image_get_level_offset(ImageFormat(header->format), header->width, header->height, level);
+            return reinterpret_cast<const uint8_t*>(g_mapped_file_get_contents(file.mapped)) + offset;
+        }
+
+        // average 2x2 blocks. For odd sizes, the last row or column is folded into the last block, which then averages 3 rows or columns, such that no pixel is dropped
+        static void raw_image_downsample(const uint8_t* in, uint64_t in_width, uint64_t in_height, ImageFormat format, uint8_t* out)
+        {
+            const uint64_t out_width = std::max<uint64_t>(1, in_width / 2);
+            const uint64_t out_height = std::max<uint64_t>(1, in_height / 2);
+            const uint64_t n_channels = image_format_get_n_channels(format);
+            const uint64_t pixel_size = raw_image_get_pixel_size(format);
+
+            // one row of scratch space per thread: up to 3 input rows and result
+            const uint64_t scratch_size = in_width * 4 * 3 + out_width * 4;
+            std::vector<float> scratch(thread_pool_get_n_threads(thread_pool_get_default()) * scratch_size);
+
+            image_parallel_for_rows(out_height, out_width * pixel_size, [&](uint64_t y, uint64_t thread_index){
+                float* rows = scratch.data() + thread_index * scratch_size;
+                float* result = rows + in_width * 4 * 3;
+
+                const uint64_t y_begin = std::min(2 * y, in_height - 1);
+                const uint64_t y_end = y + 1 == out_height ? in_height : 2 * y + 2;
+                for (uint64_t row_y = y_begin; row_y < y_end; ++row_y)
+                    convert_row_to_rgba32f(in + row_y * in_width * pixel_size, format, n_channels, rows + (row_y - y_begin) * in_width * 4, in_width);
+
+                for (uint64_t x = 0; x < out_width; ++x)
+                {
+                    const uint64_t x_begin = std::min(2 * x, in_width - 1);
+                    const uint64_t x_end = x + 1 == out_width ? in_width : 2 * x + 2;
+                    const float weight = 1.f / float((y_end - y_begin) * (x_end - x_begin));
+
+                    for (uint64_t c = 0; c < 4; ++c)
+                    {
+                        float sum = 0;
+                        for (uint64_t row_i = 0; row_i < y_end - y_begin; ++row_i)
+                            for (uint64_t column_x = x_begin; column_x < x_end; ++column_x)
+                                sum += rows[row_i * in_width * 4 + 4 * column_x + c];
+
+                        result[4 * x + c] = sum * weight;
+                    }
+                }
+
+                convert_row_from_rgba32f(result, format, n_channels, out + y * out_width * pixel_size, out_width);
+            });
+        }
+
+        void raw_image_encode(const Image& image, bool generate_mipmaps, std::vector<uint8_t>& out)
+        {
+            const auto format = image.get_format();
+            const uint64_t width = image.get_size().x;
+            const uint64_t height = image.get_size().y;
+
+            uint32_t n_levels = 1;
+            if (generate_mipmaps)
+                while ((width >> n_levels) > 0 or (height >> n_levels) > 0)
+                    n_levels += 1;
+
+            const uint64_t last_width = std::max<uint64_t>(1, width >> (n_levels - 1));
+            const uint64_t last_height = std::max<uint64_t>(1, height >> (n_levels - 1));
+            out.assign(raw_image_get_level_offset(format, width, height, n_levels - 1) + last_width * last_height * raw_image_get_pixel_size(format), 0);
+
+            auto header = RawImageHeader();
+            std::memcpy(header.magic, RAW_IMAGE_MAGIC, sizeof(RAW_IMAGE_MAGIC));
+            header.byte_order = RAW_IMAGE_BYTE_ORDER;
+            header.version = RAW_IMAGE_VERSION;
+            header.format = uint32_t(format);
+            header.n_levels = n_levels;
+            header.width = width;
+            header.height = height;
+            std::memcpy(out.data(), &header, sizeof(RawImageHeader));
+
+            // 3-channel pixbufs are expanded to 4 channels, such that every RGBA8 file has the same layout
+            image.convert_to(format, out.data() + raw_image_get_level_offset(format, width, height, 0));
+
+            uint64_t level_width = width;
+            uint64_t level_height = height;
+            for (uint64_t level = 1; level < n_levels; ++level)
+            {
+                raw_image_downsample(
+                    out.data() + raw_image_get_level_offset(format, width, height, level - 1),
+                    level_width, level_height, format,
+                    out.data() + raw_image_get_level_offset(format, width, height, level)
+                );
+
+                level_width = std::max<uint64_t>(1, level_width / 2);
+                level_height = std::max<uint64_t>(1, level_height / 2);
+            }
+        }
+    }
+}
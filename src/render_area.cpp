@@ -10,11 +10,136 @@
 #include <mousetrap/render_task.hpp>
 #include <mousetrap/msaa_render_texture.hpp>
 #include <mousetrap/shape.hpp>
+#include <mousetrap/thread_pool.hpp>
+
+#include <chrono>
+#include <algorithm>
+
+#if MOUSETRAP_ENABLE_HEADLESS_COMPONENT
+    #include <EGL/egl.h>
+    #include <EGL/eglext.h>
+#endif
 
 namespace mousetrap
 {
     namespace detail
     {
+        #if MOUSETRAP_ENABLE_HEADLESS_COMPONENT
+        static EGLDisplay HEADLESS_DISPLAY = EGL_NO_DISPLAY;
+        static EGLContext HEADLESS_CONTEXT = EGL_NO_CONTEXT;
+        #endif
+
+        bool initialize_opengl_headless()
+        {
+            #if MOUSETRAP_ENABLE_HEADLESS_COMPONENT
+            {
+                EGLint major = 0, minor = 0;
+                EGLConfig config = nullptr;
+                EGLint n_configs = 0;
+                GLenum glew_error = 0;
+
+                static const EGLint config_attributes[] = {
+                    EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+                    EGL_NONE
+                };
+
+                static const EGLint context_attributes[] = {
+                    EGL_CONTEXT_MAJOR_VERSION, 3,
+                    EGL_CONTEXT_MINOR_VERSION, 3,
+                    EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+                    EGL_NONE
+                };
+
+                auto get_platform_display = (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+                if (get_platform_display == nullptr)
+                {
+                    log::warning("In initialize_opengl_headless: EGL_EXT_platform_base is not supported", MOUSETRAP_DOMAIN);
+                    goto failed;
+                }
+
+                HEADLESS_DISPLAY = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+                if (HEADLESS_DISPLAY == EGL_NO_DISPLAY or not eglInitialize(HEADLESS_DISPLAY, &major, &minor))
+                {
+                    log::warning("In initialize_opengl_headless: Unable to initialize surfaceless EGL display", MOUSETRAP_DOMAIN);
+                    goto failed;
+                }
+
+                if (not eglBindAPI(EGL_OPENGL_API))
+                {
+                    log::warning("In initialize_opengl_headless: EGL display does not support desktop OpenGL", MOUSETRAP_DOMAIN);
+                    goto failed;
+                }
+
+                if (not eglChooseConfig(HEADLESS_DISPLAY, config_attributes, &config, 1, &n_configs) or n_configs == 0)
+                {
+                    log::warning("In initialize_opengl_headless: No suitable EGL config", MOUSETRAP_DOMAIN);
+                    goto failed;
+                }
+
+                HEADLESS_CONTEXT = eglCreateContext(HEADLESS_DISPLAY, config, EGL_NO_CONTEXT, context_attributes);
+                if (HEADLESS_CONTEXT == EGL_NO_CONTEXT)
+                {
+                    log::warning("In initialize_opengl_headless: Unable to create OpenGL 3.3 context", MOUSETRAP_DOMAIN);
+                    goto failed;
+                }
+
+                // requires EGL_KHR_surfaceless_context, always present on EGL_PLATFORM_SURFACELESS_MESA
+                if (not eglMakeCurrent(HEADLESS_DISPLAY, EGL_NO_SURFACE, EGL_NO_SURFACE, HEADLESS_CONTEXT))
+                {
+                    log::warning("In initialize_opengl_headless: Unable to make surfaceless context current", MOUSETRAP_DOMAIN);
+                    goto failed;
+                }
+
+                glewExperimental = GL_FALSE;
+                glew_error = glewInit();
+
+                // glewInit also initializes GLX, which fails without an X display, the context itself is still usable
+                if (glew_error == GLEW_ERROR_NO_GLX_DISPLAY)
+                    glew_error = glewContextInit();
+
+                if (glew_error != GLEW_NO_ERROR)
+                {
+                    std::stringstream str;
+                    str << "In initialize_opengl_headless: Unable to initialize glew " << "(" << glew_error << ") ";
+                    log::warning(str.str(), MOUSETRAP_DOMAIN);
+                    goto failed;
+                }
+
+                mousetrap::GL_INITIALIZED = true;
+                detail::GL_IS_HEADLESS = true;
+                detail::GL_CONTEXT = nullptr;
+                return true;
+
+                failed:
+                if (HEADLESS_CONTEXT != EGL_NO_CONTEXT)
+                    eglDestroyContext(HEADLESS_DISPLAY, HEADLESS_CONTEXT);
+
+                if (HEADLESS_DISPLAY != EGL_NO_DISPLAY)
+                    eglTerminate(HEADLESS_DISPLAY);
+
+                HEADLESS_CONTEXT = EGL_NO_CONTEXT;
+                HEADLESS_DISPLAY = EGL_NO_DISPLAY;
+                return false;
+            }
+            #else
+                log::warning("In initialize_opengl_headless: mousetrap was built without EGL, headless rendering is unavailable", MOUSETRAP_DOMAIN);
+                return false;
+            #endif
+        }
+
+        void make_opengl_context_current()
+        {
+            #if MOUSETRAP_ENABLE_HEADLESS_COMPONENT
+            if (detail::GL_IS_HEADLESS)
+            {
+                eglMakeCurrent(HEADLESS_DISPLAY, EGL_NO_SURFACE, EGL_NO_SURFACE, HEADLESS_CONTEXT);
+                return;
+            }
+            #endif
+
+            gdk_gl_context_make_current(detail::GL_CONTEXT);
+        }
+
         GdkGLContext* initialize_opengl()
         {
             if (not mousetrap::GL_INITIALIZED)
@@ -40,10 +165,33 @@ namespace mousetrap
                     }
                 }
 
+                auto* MOUSETRAP_OPENGL_HEADLESS = std::getenv("MOUSETRAP_OPENGL_HEADLESS");
+                if (MOUSETRAP_OPENGL_HEADLESS != nullptr)
+                {
+                    auto headless = std::string(MOUSETRAP_OPENGL_HEADLESS);
+                    if (headless == "1" or headless == "true" or headless == "TRUE" or headless == "yes" or headless == "YES" or headless == "on" or headless == "ON")
+                    {
+                        if (not initialize_opengl_headless())
+                        {
+                            log::critical("In initialize_opengl: Unable to create headless OpenGL context, disabling the OpenGL component", MOUSETRAP_DOMAIN);
+                            detail::GL_CONTEXT = nullptr;
+                        }
+
+                        return nullptr;
+                    }
+                    else if (not (headless == "0" or headless == "false" or headless == "FALSE" or headless == "no" or headless == "NO" or headless == "off" or headless == "OFF"))
+                    {
+                        log::critical("In initialize_opengl: ignoring value of environment variable `MOUSETRAP_OPENGL_HEADLESS`, because it is malformed. Expected `TRUE` or `FALSE`, got `" + headless + "`", MOUSETRAP_DOMAIN);
+                    }
+                }
+
                 auto* display = gdk_display_get_default();
                 if (display == nullptr)
                 {
-                    log::warning("In gdk_display_get_default: Unable to access default dispay.", MOUSETRAP_DOMAIN);
+                    log::warning("In gdk_display_get_default: Unable to access default dispay, attempting to create a headless context", MOUSETRAP_DOMAIN);
+                    if (initialize_opengl_headless())
+                        return nullptr;
+
                     goto failed;
                 }
 
@@ -112,18 +260,311 @@ namespace mousetrap
             if(GDK_IS_GL_CONTEXT(GL_CONTEXT))
                 g_object_unref(GL_CONTEXT);
 
+            #if MOUSETRAP_ENABLE_HEADLESS_COMPONENT
+            if (GL_IS_HEADLESS)
+            {
+                eglMakeCurrent(HEADLESS_DISPLAY, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+                eglDestroyContext(HEADLESS_DISPLAY, HEADLESS_CONTEXT);
+                eglTerminate(HEADLESS_DISPLAY);
+                HEADLESS_CONTEXT = EGL_NO_CONTEXT;
+                HEADLESS_DISPLAY = EGL_NO_DISPLAY;
+            }
+            #endif
+
             GL_CONTEXT = nullptr;
+            GL_IS_HEADLESS = false;
             GL_INITIALIZED = false;
         }
 
         bool is_opengl_disabled()
         {
-            return (mousetrap::GL_INITIALIZED == false or detail::GL_CONTEXT == nullptr);
+            return (mousetrap::GL_INITIALIZED == false or (detail::GL_CONTEXT == nullptr and not detail::GL_IS_HEADLESS));
+        }
+    }
+
+    namespace detail
+    {
+        struct RenderProfiler
+        {
+            // results are read back this many frames after they were recorded, so the cpu never waits for the gpu
+            static constexpr uint64_t n_frames_in_flight = 4;
+
+            struct Frame
+            {
+                std::vector<GLNativeHandle> queries;
+                uint64_t n_queries_used = 0;
+                bool is_pending = false;
+            };
+
+            Frame frames[n_frames_in_flight];
+            uint64_t current_frame = 0;
+
+            RenderStatistics statistics;
+            std::chrono::steady_clock::time_point frame_start;
+        };
+
+        static RenderProfiler* render_profiler_new()
+        {
+            return new RenderProfiler();
+        }
+
+        static void render_profiler_free(RenderProfiler* self)
+        {
+            if (self == nullptr)
+                return;
+
+            // queries belong to the shared context, which is not necessarily current during finalization
+            detail::make_opengl_context_current();
+
+            for (auto& frame : self->frames)
+                if (not frame.queries.empty())
+                    glDeleteQueries(frame.queries.size(), frame.queries.data());
+
+            delete self;
+        }
+
+        static void render_profiler_begin_frame(RenderProfiler* self, uint64_t n_tasks)
+        {
+            self->frame_start = std::chrono::steady_clock::now();
+            self->current_frame = (self->current_frame + 1) % RenderProfiler::n_frames_in_flight;
+            auto& frame = self->frames[self->current_frame];
+
+            // collect results recorded n_frames_in_flight frames ago, queries complete in order so checking the last one is sufficient.
+            // The first query covers the render graph, the last covers command lists, immediate draw and msaa resolve, all others are tasks
+            if (frame.is_pending and frame.n_queries_used > 0)
+            {
+                GLint available = GL_FALSE;
+                glGetQueryObjectiv(frame.queries.at(frame.n_queries_used - 1), GL_QUERY_RESULT_AVAILABLE, &available);
+
+                if (available == GL_TRUE)
+                {
+                    auto& statistics = self->statistics;
+                    statistics.task_gpu_time_ms.clear();
+                    statistics.gpu_time_ms = 0;
+
+                    for (uint64_t i = 0; i < frame.n_queries_used; ++i)
+                    {
+                        GLuint64 ns = 0;
+                        glGetQueryObjectui64v(frame.queries.at(i), GL_QUERY_RESULT, &ns);
+                        float ms = ns / 1e6f;
+                        statistics.gpu_time_ms += ms;
+
+                        if (i > 0 and i < frame.n_queries_used - 1)
+                            statistics.task_gpu_time_ms.push_back(ms);
+                    }
+                }
+            }
+
+            frame.is_pending = false;
+            frame.n_queries_used = 0;
+
+            uint64_t n_queries = n_tasks + 2;
+            if (frame.queries.size() < n_queries)
+            {
+                auto n_old = frame.queries.size();
+                frame.queries.resize(n_queries);
+                glGenQueries(n_queries - n_old, frame.queries.data() + n_old);
+            }
+
+            auto& statistics = self->statistics;
+            statistics.n_draw_calls = 0;
+            statistics.n_render_graph_passes = 0;
+            statistics.n_vertices = 0;
+            statistics.n_state_changes = 0;
+            statistics.task_cpu_time_ms.clear();
+        }
+
+        static void render_profiler_begin_query(RenderProfiler* self)
+        {
+            auto& frame = self->frames[self->current_frame];
+            glBeginQuery(GL_TIME_ELAPSED, frame.queries.at(frame.n_queries_used));
+        }
+
+        static void render_profiler_end_query(RenderProfiler* self)
+        {
+            auto& frame = self->frames[self->current_frame];
+            glEndQuery(GL_TIME_ELAPSED);
+            frame.n_queries_used += 1;
+        }
+
+        static void render_profiler_end_frame(RenderProfiler* self)
+        {
+            self->frames[self->current_frame].is_pending = true;
+            self->statistics.cpu_time_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - self->frame_start).count();
+        }
+
+        struct FramePacer
+        {
+            bool enabled = false;
+
+            // fence inserted after the last frame, nullptr once it was observed as signaled
+            GLsync fence = nullptr;
+            std::chrono::steady_clock::time_point fence_time;
+            bool fence_was_late = false;
+
+            bool render_pending = false;
+            guint tick_id = 0;
+
+            int64_t budget_override_us = 0;
+            int64_t refresh_interval_us = 16667;
+
+            std::chrono::steady_clock::time_point render_start;
+            double cpu_time_us = 0;
+            double average_frame_time_us = 0;
+
+            uint64_t n_merged_renders = 0;
+            uint64_t n_skipped_frames = 0;
+
+            // frames in a row over or well under budget before the quality level changes
+            static constexpr uint64_t n_frames_until_lower = 10;
+            static constexpr uint64_t n_frames_until_raise = 120;
+
+            std::function<void(uint64_t)>* quality_callback = nullptr;
+            uint64_t n_quality_levels = 0;
+            uint64_t quality_level = 0;
+            uint64_t n_frames_over_budget = 0;
+            uint64_t n_frames_under_budget = 0;
+        };
+
+        static FramePacer* frame_pacer_new()
+        {
+            return new FramePacer();
+        }
+
+        static void frame_pacer_free(FramePacer* self)
+        {
+            if (self->fence != nullptr)
+            {
+                detail::make_opengl_context_current();
+                glDeleteSync(self->fence);
+            }
+
+            delete self->quality_callback;
+            delete self;
+        }
+
+        static double frame_pacer_get_budget_us(FramePacer* self)
+        {
+            return self->budget_override_us > 0 ? self->budget_override_us : self->refresh_interval_us;
+        }
+
+        static void frame_pacer_add_sample(FramePacer* self, double frame_time_us)
+        {
+            if (self->average_frame_time_us == 0)
+                self->average_frame_time_us = frame_time_us;
+            else
+                self->average_frame_time_us = 0.9 * self->average_frame_time_us + 0.1 * frame_time_us;
+
+            if (self->quality_callback == nullptr)
+                return;
+
+            // hysteresis, such that quality does not oscillate around the budget
+            auto budget = frame_pacer_get_budget_us(self);
+            if (self->average_frame_time_us > 1.1 * budget)
+            {
+                self->n_frames_over_budget += 1;
+                self->n_frames_under_budget = 0;
+            }
+            else if (self->average_frame_time_us < 0.6 * budget)
+            {
+                self->n_frames_under_budget += 1;
+                self->n_frames_over_budget = 0;
+            }
+            else
+            {
+                self->n_frames_over_budget = 0;
+                self->n_frames_under_budget = 0;
+            }
+
+            bool changed = false;
+            if (self->n_frames_over_budget >= FramePacer::n_frames_until_lower and self->quality_level > 0)
+            {
+                self->quality_level -= 1;
+                changed = true;
+            }
+            else if (self->n_frames_under_budget >= FramePacer::n_frames_until_raise and self->quality_level + 1 < self->n_quality_levels)
+            {
+                self->quality_level += 1;
+                changed = true;
+            }
+
+            if (changed)
+            {
+                // restart averaging, frames rendered at the old quality are not representative
+                self->n_frames_over_budget = 0;
+                self->n_frames_under_budget = 0;
+                self->average_frame_time_us = 0;
+                (*self->quality_callback)(self->quality_level);
+            }
+        }
+
+        // non-blocking, the OpenGL context has to be current
+        static bool frame_pacer_is_gpu_behind(FramePacer* self)
+        {
+            if (self->fence == nullptr)
+                return false;
+
+            if (glClientWaitSync(self->fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+            {
+                self->fence_was_late = true;
+                return true;
+            }
+
+            // if the fence was signaled the first time it was checked, the gpu kept up and cpu time is the limiting factor
+            double gpu_time_us = 0;
+            if (self->fence_was_late)
+                gpu_time_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - self->fence_time).count();
+
+            // release the fence before the quality callback runs, it may re-enter through queue_render
+            glDeleteSync(self->fence);
+            self->fence = nullptr;
+
+            frame_pacer_add_sample(self, self->cpu_time_us + gpu_time_us);
+            return false;
+        }
+
+        static void frame_pacer_begin_frame(FramePacer* self)
+        {
+            // render was triggered by gtk directly, harvest the last sample if possible and drop the fence otherwise
+            frame_pacer_is_gpu_behind(self);
+            if (self->fence != nullptr)
+            {
+                glDeleteSync(self->fence);
+                self->fence = nullptr;
+            }
+
+            self->render_pending = false;
+            self->render_start = std::chrono::steady_clock::now();
+        }
+
+        static void frame_pacer_end_frame(FramePacer* self)
+        {
+            auto now = std::chrono::steady_clock::now();
+            self->cpu_time_us = std::chrono::duration<double, std::micro>(now - self->render_start).count();
+            self->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            self->fence_time = now;
+            self->fence_was_late = false;
         }
     }
 
     namespace detail
     {
+        static const std::vector<RenderTaskInternal*>& render_area_get_sorted_tasks(RenderAreaInternal* self)
+        {
+            if (not self->sorted_tasks_dirty and self->sorted_tasks_generation == RenderTaskInternal::z_index_generation)
+                return *self->sorted_tasks;
+
+            // self->tasks is in insertion order, a stable sort keeps that order for tasks with the same z-index
+            *self->sorted_tasks = *self->tasks;
+            std::stable_sort(self->sorted_tasks->begin(), self->sorted_tasks->end(), [](RenderTaskInternal* a, RenderTaskInternal* b){
+                return a->_z_index < b->_z_index;
+            });
+
+            self->sorted_tasks_dirty = false;
+            self->sorted_tasks_generation = RenderTaskInternal::z_index_generation;
+            return *self->sorted_tasks;
+        }
+
         DECLARE_NEW_TYPE(RenderAreaInternal, render_area_internal, RENDER_AREA_INTERNAL)
 
         static void render_area_internal_finalize(GObject* object)
@@ -138,14 +579,61 @@ namespace mousetrap
                 g_object_unref(task);
 
             delete self->tasks;
+            delete self->sorted_tasks;
             delete self->render_texture;
             delete self->render_texture_shape;
             delete self->render_texture_shape_task;
+
+            g_object_unref(self->immediate_draw);
+            g_object_unref(self->post_process_chain);
+            g_object_unref(self->render_graph);
+            render_profiler_free(self->profiler);
+
+            for (auto* list : *self->command_lists)
+                delete list;
+
+            delete self->command_lists;
+            delete self->preparation;
+            render_command_submitter_free(self->submitter);
+            frame_pacer_free(self->frame_pacer);
         }
 
         DEFINE_NEW_TYPE_TRIVIAL_INIT(RenderAreaInternal, render_area_internal, RENDER_AREA_INTERNAL)
         DEFINE_NEW_TYPE_TRIVIAL_CLASS_INIT(RenderAreaInternal, render_area_internal, RENDER_AREA_INTERNAL)
 
+        static void render_area_internal_initialize_msaa(RenderAreaInternal* self, int32_t msaa_samples)
+        {
+            self->render_texture = new MultisampledRenderTexture(msaa_samples);
+
+            self->render_texture_shape = new Shape();
+            self->render_texture_shape->as_rectangle({-1, 1}, {2, 2});
+            self->render_texture_shape->set_texture(self->render_texture);
+
+            static const std::string RENDER_TEXTURE_SHADER_SOURCE = R"(
+                #version 130
+
+                in vec4 _vertex_color;
+                in vec2 _texture_coordinates;
+                in vec3 _vertex_position;
+
+                out vec4 _fragment_color;
+
+                uniform int _texture_set;
+                uniform sampler2D _texture;
+
+                void main()
+                {
+                    // flip horizontally to correct render texture inversion
+                    _fragment_color = texture2D(_texture, vec2(_texture_coordinates.x, 1 - _texture_coordinates.y)) * _vertex_color;
+                }
+            )";
+
+            self->render_texture_shader = new Shader();
+            self->render_texture_shader->create_from_string(ShaderType::FRAGMENT, RENDER_TEXTURE_SHADER_SOURCE);
+
+            self->render_texture_shape_task = new RenderTask(*self->render_texture_shape, self->render_texture_shader);
+        }
+
         static RenderAreaInternal* render_area_internal_new(GtkGLArea* area, int32_t msaa_samples)
         {
             auto* self = (RenderAreaInternal*) g_object_new(render_area_internal_get_type(), nullptr);
@@ -159,46 +647,29 @@ namespace mousetrap
 
             self->native = area;
             self->tasks = new std::vector<detail::RenderTaskInternal*>();
+            self->sorted_tasks = new std::vector<detail::RenderTaskInternal*>();
+            self->sorted_tasks_dirty = false;
+            self->sorted_tasks_generation = RenderTaskInternal::z_index_generation;
+            self->depth_test_enabled = false;
             self->apply_msaa = msaa_samples > 0;
+            self->immediate_draw = detail::immediate_draw_internal_new();
+            self->post_process_chain = detail::post_process_chain_internal_new();
+            self->render_graph = detail::render_graph_internal_new();
+            self->profiler = nullptr;
+            self->frame_pacer = frame_pacer_new();
+            self->size = {0, 0};
+            self->preparation = nullptr;
+            self->n_preparation_jobs = 0;
+            self->command_lists = new std::vector<RenderCommandList*>();
+            self->submitter = nullptr;
+
+            self->render_texture = nullptr;
+            self->render_texture_shape = nullptr;
+            self->render_texture_shape_task = nullptr;
+            self->render_texture_shader = nullptr;
 
             if (self->apply_msaa)
-            {
-                self->render_texture = new MultisampledRenderTexture(msaa_samples);
-
-                self->render_texture_shape = new Shape();
-                self->render_texture_shape->as_rectangle({-1, 1}, {2, 2});
-                self->render_texture_shape->set_texture(self->render_texture);
-
-                static const std::string RENDER_TEXTURE_SHADER_SOURCE = R"(
-                    #version 130
-
-                    in vec4 _vertex_color;
-                    in vec2 _texture_coordinates;
-                    in vec3 _vertex_position;
-
-                    out vec4 _fragment_color;
-
-                    uniform int _texture_set;
-                    uniform sampler2D _texture;
-
-                    void main()
-                    {
-                        // flip horizontally to correct render texture inversion
-                        _fragment_color = texture2D(_texture, vec2(_texture_coordinates.x, 1 - _texture_coordinates.y)) * _vertex_color;
-                    }
-                )";
-
-                self->render_texture_shader = new Shader();
-                self->render_texture_shader->create_from_string(ShaderType::FRAGMENT, RENDER_TEXTURE_SHADER_SOURCE);
-
-                self->render_texture_shape_task = new RenderTask(*self->render_texture_shape, self->render_texture_shader);
-            }
-            else
-            {
-                self->render_texture = nullptr;
-                self->render_texture_shape = nullptr;
-                self->render_texture_shape_task = nullptr;
-            }
+                render_area_internal_initialize_msaa(self, msaa_samples);
 
             return self;
         }
@@ -274,6 +745,7 @@ namespace mousetrap
 
         auto* task_internal = (detail::RenderTaskInternal*) task.operator GObject*();
         _internal->tasks->push_back(task_internal);
+        _internal->sorted_tasks_dirty = true;
         g_object_ref(task_internal);
     }
 
@@ -286,6 +758,8 @@ namespace mousetrap
             g_object_unref(task);
 
         _internal->tasks->clear();
+        _internal->sorted_tasks->clear();
+        _internal->sorted_tasks_dirty = false;
     }
 
     void RenderArea::flush()
@@ -311,6 +785,17 @@ namespace mousetrap
             return nullptr;
 
         detail::initialize_opengl();
+
+        // headless contexts are not GdkGLContexts, a widget cannot render into them
+        if (detail::GL_CONTEXT == nullptr)
+        {
+            auto* error = g_error_new_literal(GDK_GL_ERROR, GDK_GL_ERROR_NOT_AVAILABLE, "In RenderArea::on_create_context: no GdkGLContext available, OpenGL was initialized headless or failed to initialize");
+            gtk_gl_area_set_error(area, error);
+            log::critical(error->message, MOUSETRAP_DOMAIN);
+            g_error_free(error);
+            return nullptr;
+        }
+
         g_object_ref(detail::GL_CONTEXT);
         gdk_gl_context_make_current(detail::GL_CONTEXT);
         return detail::GL_CONTEXT;
@@ -331,13 +816,130 @@ namespace mousetrap
 
         assert(GDK_IS_GL_CONTEXT(detail::GL_CONTEXT));
 
+        gtk_gl_area_make_current(area);
+
+        internal->size = {width, height};
         if (internal->apply_msaa)
             internal->render_texture->create(width, height);
 
-        gtk_gl_area_make_current(area);
+        detail::post_process_chain_resize(internal->post_process_chain, {width, height});
+        detail::render_graph_resize(internal->render_graph, {width, height});
+
         gtk_gl_area_queue_render(area);
     }
 
+    void RenderArea::render_tasks(detail::RenderAreaInternal* internal)
+    {
+        auto& tasks = detail::render_area_get_sorted_tasks(internal);
+        auto* profiler = internal->profiler;
+
+        // state at the start of the frame, such that only actual changes are counted
+        GLNativeHandle last_program = 0;
+        const TextureObject* last_texture = nullptr;
+        BlendMode last_blend_mode = BlendMode::NORMAL;
+
+        auto render_task = [&](detail::RenderTaskInternal* task)
+        {
+            if (profiler == nullptr)
+            {
+                RenderTask(task).render();
+                return;
+            }
+
+            auto& statistics = profiler->statistics;
+
+            auto program = Shader(task->_shader).get_program_id();
+            auto* texture = task->_shape->texture;
+            auto blend_mode = task->_blend_mode;
+
+            statistics.n_state_changes += (program != last_program) + (texture != last_texture) + (blend_mode != last_blend_mode);
+            last_program = program;
+            last_texture = texture;
+            last_blend_mode = blend_mode;
+
+            if (task->_shape->is_visible)
+            {
+                statistics.n_draw_calls += 1;
+                statistics.n_vertices += task->_shape->geometry->indices->size();
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            detail::render_profiler_begin_query(profiler);
+            RenderTask(task).render();
+            detail::render_profiler_end_query(profiler);
+            statistics.task_cpu_time_ms.push_back(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count());
+        };
+
+        if (not internal->depth_test_enabled)
+        {
+            for (auto* task : tasks)
+                render_task(task);
+        }
+        else
+        {
+            // each task is flattened onto its own depth, later tasks are closer to the viewer.
+            // Tasks with the same depth never overlap, so GL_LEQUAL only matters for fragments of the same task
+            uint64_t n = tasks.size();
+            auto task_depth = [&](uint64_t i) -> double {
+                return 1.0 - double(i + 1) / double(n + 1);
+            };
+
+            glEnable(GL_DEPTH_TEST);
+            glDepthFunc(GL_LEQUAL);
+            glDepthMask(GL_TRUE);
+            glClearDepth(1);
+            glClear(GL_DEPTH_BUFFER_BIT);
+
+            // opaque front-to-back, fills depth so occluded fragments further back are rejected early
+            for (uint64_t i = n; i > 0; --i)
+            {
+                auto* task = tasks.at(i - 1);
+                if (task->_blend_mode != BlendMode::NONE)
+                    continue;
+
+                glDepthRange(task_depth(i - 1), task_depth(i - 1));
+                render_task(task);
+            }
+
+            // translucent back-to-front on top, tested against but not writing depth
+            glDepthMask(GL_FALSE);
+            for (uint64_t i = 0; i < n; ++i)
+            {
+                auto* task = tasks.at(i);
+                if (task->_blend_mode == BlendMode::NONE)
+                    continue;
+
+                glDepthRange(task_depth(i), task_depth(i));
+                render_task(task);
+            }
+
+            glDepthMask(GL_TRUE);
+            glDepthRange(0, 1);
+            glDisable(GL_DEPTH_TEST);
+        }
+
+        if (profiler == nullptr)
+            return;
+
+        auto& statistics = profiler->statistics;
+
+        auto* immediate_draw = internal->immediate_draw;
+        for (auto* vertices : {immediate_draw->triangles, immediate_draw->lines, immediate_draw->points})
+        {
+            if (vertices->empty())
+                continue;
+
+            statistics.n_draw_calls += 1;
+            statistics.n_vertices += vertices->size();
+        }
+
+        if (internal->apply_msaa)
+        {
+            statistics.n_draw_calls += 1;
+            statistics.n_vertices += internal->render_texture_shape->get_n_vertices();
+        }
+    }
+
     gboolean RenderArea::on_render(GtkGLArea* area, GdkGLContext* context, detail::RenderAreaInternal* internal)
     {
         if (detail::is_opengl_disabled())
@@ -346,6 +948,19 @@ namespace mousetrap
         assert(GDK_IS_GL_CONTEXT(detail::GL_CONTEXT));
         gtk_gl_area_make_current(area);
 
+        auto* profiler = internal->profiler;
+        if (profiler != nullptr)
+            detail::render_profiler_begin_frame(profiler, internal->tasks->size());
+
+        auto* pacer = internal->frame_pacer;
+        if (pacer->enabled)
+            detail::frame_pacer_begin_frame(pacer);
+
+        prepare_commands(internal);
+
+        // if the chain has passes, everything below renders into its scene target instead
+        bool post_process = detail::post_process_chain_begin(internal->post_process_chain);
+
         if (internal->apply_msaa)
         {
             internal->render_texture->bind_as_render_target();
@@ -354,9 +969,24 @@ namespace mousetrap
             glEnable(GL_BLEND);
             set_current_blend_mode(BlendMode::NORMAL);
 
-            for (auto* internal:*(internal->tasks))
-                RenderTask(internal).render();
+            if (profiler != nullptr)
+                detail::render_profiler_begin_query(profiler);
+
+            auto n_passes = detail::render_graph_execute(internal->render_graph);
 
+            if (profiler != nullptr)
+            {
+                detail::render_profiler_end_query(profiler);
+                profiler->statistics.n_render_graph_passes = n_passes;
+            }
+
+            render_tasks(internal);
+
+            if (profiler != nullptr)
+                detail::render_profiler_begin_query(profiler);
+
+            submit_commands(internal);
+            detail::immediate_draw_flush(internal->immediate_draw);
             RenderArea::flush();
 
             internal->render_texture->unbind_as_render_target();
@@ -366,6 +996,10 @@ namespace mousetrap
             set_current_blend_mode(BlendMode::NORMAL);
 
             internal->render_texture_shape_task->render();
+
+            if (profiler != nullptr)
+                detail::render_profiler_end_query(profiler);
+
             RenderArea::flush();
         }
         else
@@ -375,36 +1009,419 @@ namespace mousetrap
             glEnable(GL_BLEND);
             set_current_blend_mode(BlendMode::NORMAL);
 
-            for (auto* internal:*(internal->tasks))
-                RenderTask(internal).render();
+            if (profiler != nullptr)
+                detail::render_profiler_begin_query(profiler);
+
+            auto n_passes = detail::render_graph_execute(internal->render_graph);
 
+            if (profiler != nullptr)
+            {
+                detail::render_profiler_end_query(profiler);
+                profiler->statistics.n_render_graph_passes = n_passes;
+            }
+
+            render_tasks(internal);
+
+            if (profiler != nullptr)
+                detail::render_profiler_begin_query(profiler);
+
+            submit_commands(internal);
+            detail::immediate_draw_flush(internal->immediate_draw);
+
+            if (profiler != nullptr)
+                detail::render_profiler_end_query(profiler);
+
+            RenderArea::flush();
+        }
+
+        if (post_process)
+        {
+            detail::post_process_chain_end(internal->post_process_chain);
             RenderArea::flush();
         }
 
+        if (profiler != nullptr)
+            detail::render_profiler_end_frame(profiler);
+
+        if (pacer->enabled)
+            detail::frame_pacer_end_frame(pacer);
+
         return TRUE;
     }
 
+    void RenderArea::prepare_commands(detail::RenderAreaInternal* internal)
+    {
+        if (internal->preparation == nullptr or internal->n_preparation_jobs == 0)
+            return;
+
+        auto* pool = detail::thread_pool_get_default();
+        auto& lists = *internal->command_lists;
+        while (lists.size() < detail::thread_pool_get_n_threads(pool))
+            lists.push_back(new RenderCommandList());
+
+        for (auto* list : lists)
+            list->clear();
+
+        // each job appends to the list of the thread it runs on, the segment remembers which commands belong to which job
+        auto& preparation = *internal->preparation;
+        detail::thread_pool_parallel_for(pool, internal->n_preparation_jobs, [&](uint64_t job_i, uint64_t thread_i){
+            auto* list = lists.at(thread_i);
+            auto begin = list->_commands.size();
+            list->_segment_begin = begin;
+            preparation(*list, job_i);
+            list->_segments.push_back({job_i, list, begin, list->_commands.size()});
+        });
+    }
+
+    void RenderArea::submit_commands(detail::RenderAreaInternal* internal)
+    {
+        if (internal->preparation == nullptr or internal->submitter == nullptr)
+            return;
+
+        detail::render_command_submitter_submit(internal->submitter, *internal->command_lists);
+
+        if (internal->profiler != nullptr)
+        {
+            auto& statistics = internal->profiler->statistics;
+            statistics.n_draw_calls += internal->submitter->n_draw_calls;
+            statistics.n_vertices += internal->submitter->n_vertices;
+        }
+
+        // release task references on the main thread
+        for (auto* list : *internal->command_lists)
+            list->clear();
+    }
+
+    void RenderArea::set_render_preparation_impl(uint64_t n_jobs, std::function<void(RenderCommandList&, uint64_t)> f)
+    {
+        if (detail::is_opengl_disabled())
+            return;
+
+        if (_internal->submitter == nullptr)
+        {
+            make_current();
+            _internal->submitter = detail::render_command_submitter_new();
+        }
+
+        delete _internal->preparation;
+        _internal->preparation = new std::function<void(RenderCommandList&, uint64_t)>(f);
+        _internal->n_preparation_jobs = n_jobs;
+        queue_render();
+    }
+
+    void RenderArea::clear_render_preparation()
+    {
+        if (detail::is_opengl_disabled())
+            return;
+
+        delete _internal->preparation;
+        _internal->preparation = nullptr;
+        _internal->n_preparation_jobs = 0;
+
+        for (auto* list : *_internal->command_lists)
+            list->clear();
+
+        queue_render();
+    }
+
     void RenderArea::render_render_tasks()
     {
         if (detail::is_opengl_disabled())
             return;
 
-        for (auto* internal : *(_internal->tasks))
+        for (auto* internal : detail::render_area_get_sorted_tasks(_internal))
         {
             auto task = RenderTask(internal);
             task.render();
         }
     }
 
+    void RenderArea::set_depth_test_enabled(bool b)
+    {
+        if (detail::is_opengl_disabled())
+            return;
+
+        _internal->depth_test_enabled = b;
+        gtk_gl_area_set_has_depth_buffer(GTK_GL_AREA(operator NativeWidget()), b);
+        queue_render();
+    }
+
+    bool RenderArea::get_depth_test_enabled() const
+    {
+        if (detail::is_opengl_disabled())
+            return false;
+
+        return _internal->depth_test_enabled;
+    }
+
+    void RenderArea::set_render_statistics_enabled(bool b)
+    {
+        if (detail::is_opengl_disabled())
+            return;
+
+        if (b == (_internal->profiler != nullptr))
+            return;
+
+        make_current();
+        if (b)
+            _internal->profiler = detail::render_profiler_new();
+        else
+        {
+            detail::render_profiler_free(_internal->profiler);
+            _internal->profiler = nullptr;
+        }
+    }
+
+    bool RenderArea::get_render_statistics_enabled() const
+    {
+        if (detail::is_opengl_disabled())
+            return false;
+
+        return _internal->profiler != nullptr;
+    }
+
+    RenderStatistics RenderArea::get_render_statistics() const
+    {
+        if (detail::is_opengl_disabled() or _internal->profiler == nullptr)
+            return RenderStatistics();
+
+        return _internal->profiler->statistics;
+    }
+
+    ImmediateDraw RenderArea::get_immediate_draw()
+    {
+        if (detail::is_opengl_disabled())
+            return ImmediateDraw(nullptr);
+
+        return ImmediateDraw(_internal->immediate_draw);
+    }
+
+    PostProcessChain RenderArea::get_post_process_chain()
+    {
+        if (detail::is_opengl_disabled())
+            return PostProcessChain(nullptr);
+
+        return PostProcessChain(_internal->post_process_chain);
+    }
+
+    RenderGraph RenderArea::get_render_graph()
+    {
+        if (detail::is_opengl_disabled())
+            return RenderGraph(nullptr);
+
+        return RenderGraph(_internal->render_graph);
+    }
+
     void RenderArea::queue_render()
     {
         if (detail::is_opengl_disabled())
             return;
 
+        auto* pacer = _internal->frame_pacer;
+        if (pacer->enabled)
+        {
+            if (pacer->render_pending)
+            {
+                pacer->n_merged_renders += 1;
+                return;
+            }
+
+            detail::make_opengl_context_current();
+            if (detail::frame_pacer_is_gpu_behind(pacer))
+            {
+                // re-checked once per display frame, the render is issued as soon as the gpu caught up
+                pacer->render_pending = true;
+                if (pacer->tick_id == 0)
+                    pacer->tick_id = gtk_widget_add_tick_callback(GTK_WIDGET(_internal->native), (GtkTickCallback) on_frame_pacing_tick, _internal, nullptr);
+
+                return;
+            }
+        }
+
         gtk_gl_area_queue_render(GTK_GL_AREA(operator NativeWidget()));
         gtk_widget_queue_draw(GTK_WIDGET(GTK_GL_AREA(operator NativeWidget())));
     }
 
+    gboolean RenderArea::on_frame_pacing_tick(GtkWidget* widget, GdkFrameClock* clock, detail::RenderAreaInternal* internal)
+    {
+        auto* pacer = internal->frame_pacer;
+
+        gint64 refresh_interval = 0;
+        gdk_frame_clock_get_refresh_info(clock, gdk_frame_clock_get_frame_time(clock), &refresh_interval, nullptr);
+        if (refresh_interval > 0)
+            pacer->refresh_interval_us = refresh_interval;
+
+        if (not pacer->enabled or not pacer->render_pending)
+        {
+            pacer->tick_id = 0;
+            return G_SOURCE_REMOVE;
+        }
+
+        detail::make_opengl_context_current();
+        if (detail::frame_pacer_is_gpu_behind(pacer))
+        {
+            pacer->n_skipped_frames += 1;
+            return G_SOURCE_CONTINUE;
+        }
+
+        // stays pending until on_render, such that further requests keep being merged
+        gtk_gl_area_queue_render(GTK_GL_AREA(widget));
+        gtk_widget_queue_draw(widget);
+
+        pacer->tick_id = 0;
+        return G_SOURCE_REMOVE;
+    }
+
+    void RenderArea::set_frame_pacing_enabled(bool b)
+    {
+        if (detail::is_opengl_disabled())
+            return;
+
+        auto* pacer = _internal->frame_pacer;
+        if (pacer->enabled == b)
+            return;
+
+        pacer->enabled = b;
+        if (not b)
+        {
+            if (pacer->fence != nullptr)
+            {
+                make_current();
+                glDeleteSync(pacer->fence);
+                pacer->fence = nullptr;
+            }
+
+            if (pacer->render_pending)
+            {
+                pacer->render_pending = false;
+                gtk_gl_area_queue_render(_internal->native);
+            }
+        }
+
+        auto* clock = gtk_widget_get_frame_clock(GTK_WIDGET(_internal->native));
+        if (clock != nullptr)
+        {
+            gint64 refresh_interval = 0;
+            gdk_frame_clock_get_refresh_info(clock, gdk_frame_clock_get_frame_time(clock), &refresh_interval, nullptr);
+            if (refresh_interval > 0)
+                pacer->refresh_interval_us = refresh_interval;
+        }
+    }
+
+    bool RenderArea::get_frame_pacing_enabled() const
+    {
+        if (detail::is_opengl_disabled())
+            return false;
+
+        return _internal->frame_pacer->enabled;
+    }
+
+    void RenderArea::set_frame_budget(Time budget)
+    {
+        if (detail::is_opengl_disabled())
+            return;
+
+        _internal->frame_pacer->budget_override_us = std::max<int64_t>(0, budget.as_microseconds());
+    }
+
+    Time RenderArea::get_frame_budget() const
+    {
+        if (detail::is_opengl_disabled())
+            return microseconds(0);
+
+        return microseconds(detail::frame_pacer_get_budget_us(_internal->frame_pacer));
+    }
+
+    FramePacingStatistics RenderArea::get_frame_pacing_statistics() const
+    {
+        if (detail::is_opengl_disabled() or not _internal->frame_pacer->enabled)
+            return FramePacingStatistics();
+
+        auto* pacer = _internal->frame_pacer;
+        auto out = FramePacingStatistics();
+        out.frame_budget = microseconds(detail::frame_pacer_get_budget_us(pacer));
+        out.average_frame_time = microseconds(pacer->average_frame_time_us);
+        out.n_merged_renders = pacer->n_merged_renders;
+        out.n_skipped_frames = pacer->n_skipped_frames;
+        out.quality_level = pacer->quality_level;
+        return out;
+    }
+
+    void RenderArea::set_adaptive_quality_callback_impl(uint64_t n_levels, std::function<void(uint64_t)> f)
+    {
+        if (detail::is_opengl_disabled())
+            return;
+
+        if (n_levels == 0)
+        {
+            log::critical("In RenderArea::set_adaptive_quality_callback: number of quality levels has to be at least 1", MOUSETRAP_DOMAIN);
+            return;
+        }
+
+        auto* pacer = _internal->frame_pacer;
+        delete pacer->quality_callback;
+        pacer->quality_callback = new std::function<void(uint64_t)>(f);
+        pacer->n_quality_levels = n_levels;
+        pacer->quality_level = n_levels - 1;
+        pacer->n_frames_over_budget = 0;
+        pacer->n_frames_under_budget = 0;
+    }
+
+    void RenderArea::clear_adaptive_quality_callback()
+    {
+        if (detail::is_opengl_disabled())
+            return;
+
+        auto* pacer = _internal->frame_pacer;
+        delete pacer->quality_callback;
+        pacer->quality_callback = nullptr;
+        pacer->n_quality_levels = 0;
+        pacer->quality_level = 0;
+    }
+
+    uint64_t RenderArea::get_quality_level() const
+    {
+        if (detail::is_opengl_disabled())
+            return 0;
+
+        return _internal->frame_pacer->quality_level;
+    }
+
+    void RenderArea::set_anti_aliasing_quality(AntiAliasingQuality quality)
+    {
+        if (detail::is_opengl_disabled())
+            return;
+
+        auto n_samples = (int32_t) quality;
+        if (n_samples == (int32_t) get_anti_aliasing_quality())
+            return;
+
+        make_current();
+        _internal->apply_msaa = n_samples > 0;
+
+        // buffers are kept when disabling, such that toggling back is cheap
+        if (n_samples > 0)
+        {
+            if (_internal->render_texture == nullptr)
+                detail::render_area_internal_initialize_msaa(_internal, n_samples);
+            else
+                ((detail::MultisampledRenderTextureInternal*) _internal->render_texture->get_internal())->n_samples = n_samples;
+
+            if (_internal->size.x > 0 and _internal->size.y > 0)
+                _internal->render_texture->create(_internal->size.x, _internal->size.y);
+        }
+
+        queue_render();
+    }
+
+    AntiAliasingQuality RenderArea::get_anti_aliasing_quality() const
+    {
+        if (detail::is_opengl_disabled() or not _internal->apply_msaa)
+            return AntiAliasingQuality::OFF;
+
+        return (AntiAliasingQuality) ((detail::MultisampledRenderTextureInternal*) _internal->render_texture->get_internal())->n_samples;
+    }
+
     void RenderArea::make_current()
     {
         if (detail::is_opengl_disabled())
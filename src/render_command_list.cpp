@@ -0,0 +1,191 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/18/26
+//
+
+#include <mousetrap/gl_common.hpp>
+#if MOUSETRAP_ENABLE_OPENGL_COMPONENT
+
+#include <mousetrap/render_command_list.hpp>
+#include <mousetrap/render_area.hpp>
+#include <mousetrap/log.hpp>
+
+#include <algorithm>
+
+namespace mousetrap
+{
+    RenderCommandList::RenderCommandList()
+    {}
+
+    RenderCommandList::~RenderCommandList()
+    {
+        clear();
+    }
+
+    void RenderCommandList::add_task(const RenderTask& task)
+    {
+        auto* internal = (detail::RenderTaskInternal*) task.operator GObject*();
+        if (internal == nullptr)
+            return;
+
+        g_object_ref(internal);
+        _commands.push_back({internal, false, GLTransform(), 0, 0});
+    }
+
+    void RenderCommandList::add_task(const RenderTask& task, const GLTransform& transform)
+    {
+        auto* internal = (detail::RenderTaskInternal*) task.operator GObject*();
+        if (internal == nullptr)
+            return;
+
+        g_object_ref(internal);
+        _commands.push_back({internal, true, transform, 0, 0});
+    }
+
+    void RenderCommandList::add_triangles(const Vertex* vertices, uint64_t n_vertices)
+    {
+        if (n_vertices % 3 != 0)
+        {
+            log::critical("In RenderCommandList::add_triangles: number of vertices is not a multiple of 3", MOUSETRAP_DOMAIN);
+            n_vertices -= n_vertices % 3;
+        }
+
+        if (n_vertices == 0)
+            return;
+
+        // consecutive triangle commands of the same job are merged into one draw call
+        if (_commands.size() > _segment_begin and _commands.back().task == nullptr)
+            _commands.back().n_vertices += n_vertices;
+        else
+            _commands.push_back({nullptr, false, GLTransform(), _vertices.size(), n_vertices});
+
+        // conversion happens here, on the preparing thread, so the main thread only has to copy
+        _vertices.reserve(_vertices.size() + n_vertices);
+        for (uint64_t i = 0; i < n_vertices; ++i)
+        {
+            auto& v = vertices[i];
+            auto position = to_gl_position(v.position);
+            _vertices.push_back(detail::VertexInfo{
+                {position.x, position.y, position.z},
+                {v.color.r, v.color.g, v.color.b, v.color.a},
+                {v.texture_coordinates.x, v.texture_coordinates.y}
+            });
+        }
+    }
+
+    void RenderCommandList::add_triangles(const std::vector<Vertex>& vertices)
+    {
+        add_triangles(vertices.data(), vertices.size());
+    }
+
+    uint64_t RenderCommandList::get_n_commands() const
+    {
+        return _commands.size();
+    }
+
+    void RenderCommandList::clear()
+    {
+        for (auto& command : _commands)
+            if (command.task != nullptr)
+                g_object_unref(command.task);
+
+        _commands.clear();
+        _vertices.clear();
+        _segments.clear();
+        _segment_begin = 0;
+    }
+
+    namespace detail
+    {
+        RenderCommandSubmitter* render_command_submitter_new()
+        {
+            detail::make_opengl_context_current();
+
+            auto* self = new RenderCommandSubmitter();
+            self->buffer = streaming_vertex_buffer_new(1 << 14);
+            self->shader = new Shader();
+            return self;
+        }
+
+        void render_command_submitter_free(RenderCommandSubmitter* self)
+        {
+            if (self == nullptr)
+                return;
+
+            streaming_vertex_buffer_free(self->buffer);
+            delete self->shader;
+            delete self;
+        }
+
+        void render_command_submitter_submit(RenderCommandSubmitter* self, const std::vector<RenderCommandList*>& lists)
+        {
+            // lists are per thread, order is restored through the job index of each segment, so output is deterministic regardless of scheduling
+            self->segments.clear();
+            self->n_draw_calls = 0;
+            self->n_vertices = 0;
+            uint64_t n_vertices = 0;
+            for (auto* list : lists)
+            {
+                self->segments.insert(self->segments.end(), list->_segments.begin(), list->_segments.end());
+                n_vertices += list->_vertices.size();
+            }
+
+            std::sort(self->segments.begin(), self->segments.end(), [](const RenderCommandSegment& a, const RenderCommandSegment& b){
+                return a.job_index < b.job_index;
+            });
+
+            if (n_vertices > 0)
+                streaming_vertex_buffer_begin_frame(self->buffer, n_vertices);
+
+            auto identity = GLTransform();
+            for (auto& segment : self->segments)
+            {
+                auto* list = segment.list;
+                for (uint64_t i = segment.begin; i < segment.end; ++i)
+                {
+                    auto& command = list->_commands.at(i);
+                    if (command.task != nullptr)
+                    {
+                        if (command.task->_shape->is_visible)
+                        {
+                            self->n_draw_calls += 1;
+                            self->n_vertices += command.task->_shape->geometry->indices->size();
+                        }
+
+                        if (command.override_transform)
+                        {
+                            auto before = command.task->_transform;
+                            command.task->_transform = command.transform;
+                            RenderTask(command.task).render();
+                            command.task->_transform = before;
+                        }
+                        else
+                            RenderTask(command.task).render();
+
+                        continue;
+                    }
+
+                    auto first = streaming_vertex_buffer_write(self->buffer, list->_vertices.data() + command.first_vertex, command.n_vertices);
+
+                    auto* shader_internal = (ShaderInternal*) self->shader->get_internal();
+                    glUseProgram(self->shader->get_program_id());
+                    glUniformMatrix4fv(shader_internal->transform_location, 1, GL_FALSE, &(identity.transform[0][0]));
+                    glUniformMatrix4fv(shader_internal->model_transform_location, 1, GL_FALSE, &(identity.transform[0][0]));
+                    glUniform1i(shader_internal->texture_set_location, GL_FALSE);
+
+                    glBindVertexArray(self->buffer->vertex_array_id);
+                    glDrawArrays(GL_TRIANGLES, first, command.n_vertices);
+                    glBindVertexArray(0);
+
+                    self->n_draw_calls += 1;
+                    self->n_vertices += command.n_vertices;
+                    glUseProgram(0);
+                }
+            }
+
+            if (n_vertices > 0)
+                streaming_vertex_buffer_end_frame(self->buffer);
+        }
+    }
+}
+
+#endif // MOUSETRAP_ENABLE_OPENGL_COMPONENT
@@ -0,0 +1,448 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/18/26
+//
+
+#include <mousetrap/gl_common.hpp>
+#if MOUSETRAP_ENABLE_OPENGL_COMPONENT
+
+#include <mousetrap/render_graph.hpp>
+#include <mousetrap/log.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace mousetrap
+{
+    namespace detail
+    {
+        DECLARE_NEW_TYPE(RenderGraphInternal, render_graph_internal, RENDER_GRAPH_INTERNAL)
+
+        static void render_graph_internal_finalize(GObject* object)
+        {
+            auto* self = MOUSETRAP_RENDER_GRAPH_INTERNAL(object);
+            G_OBJECT_CLASS(render_graph_internal_parent_class)->finalize(object);
+
+            if (detail::is_opengl_disabled())
+                return;
+
+            for (auto& target : *self->targets)
+                delete target.texture;
+
+            delete self->resources;
+            delete self->passes;
+            delete self->targets;
+            delete self->order;
+        }
+
+        DEFINE_NEW_TYPE_TRIVIAL_INIT(RenderGraphInternal, render_graph_internal, RENDER_GRAPH_INTERNAL)
+        DEFINE_NEW_TYPE_TRIVIAL_CLASS_INIT(RenderGraphInternal, render_graph_internal, RENDER_GRAPH_INTERNAL)
+
+        RenderGraphInternal* render_graph_internal_new()
+        {
+            auto* self = (RenderGraphInternal*) g_object_new(render_graph_internal_get_type(), nullptr);
+            render_graph_internal_init(self);
+
+            if (detail::is_opengl_disabled())
+            {
+                log::critical("In render_graph_internal_new: Trying to instantiate mousetrap::RenderGraph, but the OpenGL component is disabled", MOUSETRAP_DOMAIN);
+                return self;
+            }
+
+            self->resources = new std::vector<RenderGraphResource>();
+            self->passes = new std::vector<RenderGraphPass>();
+            self->targets = new std::vector<RenderGraphTarget>();
+            self->order = new std::vector<uint64_t>();
+            self->is_dirty = false;
+            self->size = {0, 0};
+
+            // RenderGraph::BACKBUFFER
+            self->resources->push_back({false, {1, 1}, nullptr, -1});
+            return self;
+        }
+
+        static Vector2i render_graph_target_size(RenderGraphInternal* self, Vector2f relative_size)
+        {
+            return {
+                std::max<int>(1, std::round(self->size.x * relative_size.x)),
+                std::max<int>(1, std::round(self->size.y * relative_size.y))
+            };
+        }
+
+        static RenderTexture* render_graph_new_texture(RenderGraphInternal* self, Vector2f relative_size)
+        {
+            auto* out = new RenderTexture();
+            out->set_scale_mode(TextureScaleMode::LINEAR);
+
+            if (self->size.x > 0 and self->size.y > 0)
+            {
+                auto size = render_graph_target_size(self, relative_size);
+                out->create(size.x, size.y);
+            }
+
+            return out;
+        }
+
+        void render_graph_resize(RenderGraphInternal* self, Vector2i size)
+        {
+            if (detail::is_opengl_disabled() or size == self->size)
+                return;
+
+            self->size = size;
+            for (auto& target : *self->targets)
+            {
+                auto target_size = render_graph_target_size(self, target.relative_size);
+                target.texture->create(target_size.x, target_size.y);
+            }
+        }
+
+        enum RenderGraphVisitState : uint8_t
+        {
+            UNVISITED = 0,
+            VISITING = 1,
+            ACYCLIC = 2,
+            CYCLIC = 3
+        };
+
+        // depth-first search for cycles, runs before the order is emitted, such that a cycle reached from one root does not affect the state seen by other roots. Returns false if pass depends on a cycle
+        static bool render_graph_find_cycles(RenderGraphInternal* self, uint64_t pass_i, const std::vector<int64_t>& writers, std::vector<uint8_t>& state)
+        {
+            if (state.at(pass_i) == ACYCLIC)
+                return true;
+
+            if (state.at(pass_i) == CYCLIC)
+                return false;
+
+            auto& pass = self->passes->at(pass_i);
+            if (state.at(pass_i) == VISITING)
+            {
+                log::critical("In RenderGraph: pass `" + pass.name + "` depends on its own output, it will not be run", MOUSETRAP_DOMAIN);
+                return false;
+            }
+
+            state.at(pass_i) = VISITING;
+
+            bool is_acyclic = true;
+            for (auto input : pass.inputs)
+            {
+                auto writer = writers.at(input);
+                if (writer != -1 and not render_graph_find_cycles(self, writer, writers, state))
+                    is_acyclic = false;
+            }
+
+            state.at(pass_i) = is_acyclic ? ACYCLIC : CYCLIC;
+            return is_acyclic;
+        }
+
+        // depth-first visit, appends pass after all passes it depends on. Only called for passes that do not depend on a cycle
+        static void render_graph_visit(RenderGraphInternal* self, uint64_t pass_i, const std::vector<int64_t>& writers, std::vector<bool>& is_emitted)
+        {
+            if (is_emitted.at(pass_i))
+                return;
+
+            is_emitted.at(pass_i) = true;
+            for (auto input : self->passes->at(pass_i).inputs)
+            {
+                auto writer = writers.at(input);
+                if (writer != -1)
+                    render_graph_visit(self, writer, writers, is_emitted);
+            }
+
+            self->order->push_back(pass_i);
+        }
+
+        static void render_graph_compile(RenderGraphInternal* self)
+        {
+            auto& resources = *self->resources;
+            auto& passes = *self->passes;
+
+            // each resource other than the backbuffer has at most one writer
+            auto writers = std::vector<int64_t>(resources.size(), -1);
+            auto is_valid = std::vector<bool>(passes.size(), true);
+            for (uint64_t pass_i = 0; pass_i < passes.size(); ++pass_i)
+            {
+                auto output = passes.at(pass_i).output;
+                if (output == RenderGraph::BACKBUFFER)
+                    continue;
+
+                if (writers.at(output) != -1)
+                {
+                    log::critical("In RenderGraph: pass `" + passes.at(pass_i).name + "` writes to a resource already written by pass `" + passes.at(writers.at(output)).name + "`, it will not be run", MOUSETRAP_DOMAIN);
+                    is_valid.at(pass_i) = false;
+                    continue;
+                }
+
+                writers.at(output) = pass_i;
+            }
+
+            // passes writing to the backbuffer or an imported texture are roots, everything they do not depend on is culled. Roots that depend on a cycle are not run
+            auto is_root = std::vector<bool>(passes.size(), false);
+            auto state = std::vector<uint8_t>(passes.size(), UNVISITED);
+            for (uint64_t pass_i = 0; pass_i < passes.size(); ++pass_i)
+            {
+                auto& resource = resources.at(passes.at(pass_i).output);
+                if (is_valid.at(pass_i) and not resource.is_transient)
+                    is_root.at(pass_i) = render_graph_find_cycles(self, pass_i, writers, state);
+            }
+
+            self->order->clear();
+            auto is_emitted = std::vector<bool>(passes.size(), false);
+            for (uint64_t pass_i = 0; pass_i < passes.size(); ++pass_i)
+                if (is_root.at(pass_i))
+                    render_graph_visit(self, pass_i, writers, is_emitted);
+
+            // lifetime of each transient resource as [first, last] position in the execution order
+            auto first_use = std::vector<int64_t>(resources.size(), -1);
+            auto last_use = std::vector<int64_t>(resources.size(), -1);
+            for (uint64_t position = 0; position < self->order->size(); ++position)
+            {
+                auto& pass = passes.at(self->order->at(position));
+                if (first_use.at(pass.output) == -1)
+                    first_use.at(pass.output) = position;
+
+                last_use.at(pass.output) = position;
+
+                for (auto input : pass.inputs)
+                    last_use.at(input) = position;
+            }
+
+            auto transient = std::vector<uint64_t>();
+            for (uint64_t resource_i = 0; resource_i < resources.size(); ++resource_i)
+            {
+                auto& resource = resources.at(resource_i);
+                resource.target = -1;
+
+                if (not resource.is_transient or first_use.at(resource_i) == -1)
+                    continue;
+
+                transient.push_back(resource_i);
+            }
+
+            std::sort(transient.begin(), transient.end(), [&](uint64_t a, uint64_t b){
+                return first_use.at(a) < first_use.at(b);
+            });
+
+            // greedy interval allocation: a physical target is reused by the next resource of the same size whose lifetime starts after it was last read
+            auto unused = std::move(*self->targets);
+            self->targets->clear();
+            auto busy_until = std::vector<int64_t>();
+
+            for (auto resource_i : transient)
+            {
+                auto& resource = resources.at(resource_i);
+
+                int64_t target_i = -1;
+                for (uint64_t i = 0; i < self->targets->size(); ++i)
+                {
+                    if (self->targets->at(i).relative_size == resource.relative_size and busy_until.at(i) < first_use.at(resource_i))
+                    {
+                        target_i = i;
+                        break;
+                    }
+                }
+
+                if (target_i == -1)
+                {
+                    auto it = std::find_if(unused.begin(), unused.end(), [&](const RenderGraphTarget& target){
+                        return target.relative_size == resource.relative_size;
+                    });
+
+                    if (it != unused.end())
+                    {
+                        self->targets->push_back(*it);
+                        unused.erase(it);
+                    }
+                    else
+                        self->targets->push_back({render_graph_new_texture(self, resource.relative_size), resource.relative_size});
+
+                    target_i = self->targets->size() - 1;
+                    busy_until.push_back(-1);
+                }
+
+                resource.target = target_i;
+                busy_until.at(target_i) = last_use.at(resource_i);
+            }
+
+            for (auto& target : unused)
+                delete target.texture;
+
+            self->is_dirty = false;
+        }
+
+        static const RenderTexture* render_graph_get_texture(RenderGraphInternal* self, uint64_t resource_i)
+        {
+            auto& resource = self->resources->at(resource_i);
+            if (resource.imported != nullptr)
+                return resource.imported;
+
+            if (resource.target != -1)
+                return self->targets->at(resource.target).texture;
+
+            return nullptr;
+        }
+
+        uint64_t render_graph_execute(RenderGraphInternal* self)
+        {
+            if (detail::is_opengl_disabled() or self->passes->empty() or self->size.x == 0 or self->size.y == 0)
+                return 0;
+
+            if (self->is_dirty)
+                render_graph_compile(self);
+
+            GLint backbuffer;
+            GLint backbuffer_viewport[4];
+            glGetIntegerv(GL_FRAMEBUFFER_BINDING, &backbuffer);
+            glGetIntegerv(GL_VIEWPORT, backbuffer_viewport);
+
+            for (auto pass_i : *self->order)
+            {
+                auto& pass = self->passes->at(pass_i);
+                auto* output = render_graph_get_texture(self, pass.output);
+
+                for (uint64_t i = 0; i < pass.inputs.size(); ++i)
+                    pass.context.inputs[i] = render_graph_get_texture(self, pass.inputs.at(i));
+
+                if (output != nullptr)
+                {
+                    output->bind_as_render_target();
+                    pass.context.output_size = output->get_size();
+
+                    if (self->resources->at(pass.output).is_transient)
+                    {
+                        glClearColor(0, 0, 0, 0);
+                        glClear(GL_COLOR_BUFFER_BIT);
+                    }
+                }
+                else
+                    pass.context.output_size = {backbuffer_viewport[2], backbuffer_viewport[3]};
+
+                pass.f(pass.context);
+
+                if (output != nullptr)
+                    output->unbind_as_render_target();
+            }
+
+            glBindFramebuffer(GL_FRAMEBUFFER, backbuffer);
+            glViewport(backbuffer_viewport[0], backbuffer_viewport[1], backbuffer_viewport[2], backbuffer_viewport[3]);
+            return self->order->size();
+        }
+    }
+
+    RenderGraph::RenderGraph(detail::RenderGraphInternal* internal)
+    {
+        if (detail::is_opengl_disabled())
+        {
+            _internal = nullptr;
+            return;
+        }
+
+        _internal = g_object_ref(internal);
+    }
+
+    RenderGraph::~RenderGraph()
+    {
+        if (not detail::is_opengl_disabled())
+            g_object_unref(_internal);
+    }
+
+    NativeObject RenderGraph::get_internal() const
+    {
+        if (detail::is_opengl_disabled())
+            return nullptr;
+
+        return G_OBJECT(_internal);
+    }
+
+    RenderGraph::operator NativeObject() const
+    {
+        return get_internal();
+    }
+
+    RenderGraph::ResourceID RenderGraph::create_target(Vector2f relative_size)
+    {
+        if (detail::is_opengl_disabled())
+            return BACKBUFFER;
+
+        _internal->resources->push_back({true, relative_size, nullptr, -1});
+        _internal->is_dirty = true;
+        return _internal->resources->size() - 1;
+    }
+
+    RenderGraph::ResourceID RenderGraph::import_render_texture(const RenderTexture& texture)
+    {
+        if (detail::is_opengl_disabled())
+            return BACKBUFFER;
+
+        _internal->resources->push_back({false, {1, 1}, &texture, -1});
+        _internal->is_dirty = true;
+        return _internal->resources->size() - 1;
+    }
+
+    uint64_t RenderGraph::add_pass_impl(const std::string& name, const std::vector<ResourceID>& inputs, ResourceID output, std::function<void(const RenderGraphPassContext&)> f)
+    {
+        if (detail::is_opengl_disabled())
+            return 0;
+
+        auto n_resources = _internal->resources->size();
+        if (output >= n_resources)
+        {
+            log::critical("In RenderGraph::add_pass: output of pass `" + name + "` is not a resource of this graph", MOUSETRAP_DOMAIN);
+            return _internal->passes->size();
+        }
+
+        for (auto input : inputs)
+        {
+            if (input == BACKBUFFER or input >= n_resources)
+            {
+                log::critical("In RenderGraph::add_pass: input of pass `" + name + "` is not a readable resource of this graph", MOUSETRAP_DOMAIN);
+                return _internal->passes->size();
+            }
+        }
+
+        auto pass = detail::RenderGraphPass{name, inputs, output, f, RenderGraphPassContext()};
+        pass.context.inputs.resize(inputs.size(), nullptr);
+
+        _internal->passes->push_back(std::move(pass));
+        _internal->is_dirty = true;
+        return _internal->passes->size() - 1;
+    }
+
+    void RenderGraph::clear()
+    {
+        if (detail::is_opengl_disabled())
+            return;
+
+        _internal->passes->clear();
+        _internal->resources->resize(1);
+        _internal->order->clear();
+
+        for (auto& target : *_internal->targets)
+            delete target.texture;
+
+        _internal->targets->clear();
+        _internal->is_dirty = false;
+    }
+
+    uint64_t RenderGraph::get_n_active_passes() const
+    {
+        if (detail::is_opengl_disabled())
+            return 0;
+
+        if (_internal->is_dirty)
+            detail::render_graph_compile(_internal);
+
+        return _internal->order->size();
+    }
+
+    uint64_t RenderGraph::get_n_allocated_targets() const
+    {
+        if (detail::is_opengl_disabled())
+            return 0;
+
+        if (_internal->is_dirty)
+            detail::render_graph_compile(_internal);
+
+        return _internal->targets->size();
+    }
+}
+
+#endif // MOUSETRAP_ENABLE_OPENGL_COMPONENT
@@ -146,6 +146,26 @@ namespace mousetrap
         set_current_blend_mode(BlendMode::NORMAL);
     }
 
+    void RenderTask::set_z_index(int32_t z_index)
+    {
+        if (detail::is_opengl_disabled())
+            return;
+
+        if (_internal->_z_index == z_index)
+            return;
+
+        _internal->_z_index = z_index;
+        detail::RenderTaskInternal::z_index_generation += 1;
+    }
+
+    int32_t RenderTask::get_z_index() const
+    {
+        if (detail::is_opengl_disabled())
+            return 0;
+
+        return _internal->_z_index;
+    }
+
     void RenderTask::set_uniform_float(const std::string& uniform_name, float value)
     {
         if (detail::is_opengl_disabled())
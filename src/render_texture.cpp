@@ -100,6 +100,10 @@ namespace mousetrap
 
         _internal->framebuffer_handle = other._internal->framebuffer_handle;
         other._internal->framebuffer_handle = 0;
+
+        // the framebuffer carries the attachment of other, force it to be set again on the next bind
+        _internal->attached_texture = 0;
+        other._internal->attached_texture = 0;
     }
 
     RenderTexture& RenderTexture::operator=(RenderTexture&& other)
@@ -112,6 +116,10 @@ namespace mousetrap
 
         _internal->framebuffer_handle = other._internal->framebuffer_handle;
         other._internal->framebuffer_handle = 0;
+
+        // the framebuffer carries the attachment of other, force it to be set again on the next bind
+        _internal->attached_texture = 0;
+        other._internal->attached_texture = 0;
         return *this;
     }
 
@@ -123,11 +131,26 @@ namespace mousetrap
         constexpr auto ATTACHMENT = GL_COLOR_ATTACHMENT5;
 
         glGetIntegerv(GL_FRAMEBUFFER_BINDING, &_internal->before_buffer);
+        glGetIntegerv(GL_VIEWPORT, _internal->before_viewport);
 
         glBindFramebuffer(GL_FRAMEBUFFER, _internal->framebuffer_handle);
-        glFramebufferTexture2D(GL_FRAMEBUFFER, ATTACHMENT, GL_TEXTURE_2D, get_native_handle(), 0);
-        GLenum DrawBuffers[1] = {ATTACHMENT};
-        glDrawBuffers(1, DrawBuffers);
+
+        // attachment and draw buffers are framebuffer state, only update them if the texture object itself changed
+        // get_native_handle is overridden to return the framebuffer, attach the texture itself
+        // names may be reused after a texture was deleted, so the generation of the handle is compared as well
+        auto texture = Texture::get_native_handle();
+        auto handle_generation = ((detail::TextureInternal*) Texture::operator GObject*())->handle_generation;
+        if (texture != _internal->attached_texture or handle_generation != _internal->attached_handle_generation)
+        {
+            glFramebufferTexture2D(GL_FRAMEBUFFER, ATTACHMENT, GL_TEXTURE_2D, texture, 0);
+            GLenum DrawBuffers[1] = {ATTACHMENT};
+            glDrawBuffers(1, DrawBuffers);
+            _internal->attached_texture = texture;
+            _internal->attached_handle_generation = handle_generation;
+        }
+
+        auto size = get_size();
+        glViewport(0, 0, size.x, size.y);
     }
 
     void RenderTexture::unbind_as_render_target() const
@@ -136,6 +159,7 @@ namespace mousetrap
             return;
 
         glBindFramebuffer(GL_FRAMEBUFFER, _internal->before_buffer);
+        glViewport(_internal->before_viewport[0], _internal->before_viewport[1], _internal->before_viewport[2], _internal->before_viewport[3]);
     }
 
     RenderTexture::operator GObject*() const
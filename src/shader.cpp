@@ -43,6 +43,21 @@ namespace mousetrap
 
         DEFINE_NEW_TYPE_TRIVIAL_CLASS_INIT(ShaderInternal, shader_internal, SHADER_INTERNAL)
 
+        static void shader_internal_update_uniform_locations(ShaderInternal* self)
+        {
+            if (self->program_id == 0)
+            {
+                self->transform_location = -1;
+                self->model_transform_location = -1;
+                self->texture_set_location = -1;
+                return;
+            }
+
+            self->transform_location = glGetUniformLocation(self->program_id, "_transform");
+            self->model_transform_location = glGetUniformLocation(self->program_id, "_model_transform");
+            self->texture_set_location = glGetUniformLocation(self->program_id, "_texture_set");
+        }
+
         static ShaderInternal* shader_internal_new()
         {
             auto* self = (ShaderInternal*) g_object_new(shader_internal_get_type(), nullptr);
@@ -57,6 +72,7 @@ namespace mousetrap
             self->program_id = detail::ShaderInternal::noop_program_id;
             self->fragment_shader_id = detail::ShaderInternal::noop_fragment_shader_id;
             self->vertex_shader_id = detail::ShaderInternal::noop_vertex_shader_id;
+            shader_internal_update_uniform_locations(self);
 
             return self;
         }
@@ -121,6 +137,7 @@ namespace mousetrap
             _internal->vertex_shader_id = compile_shader(code, type);
 
         _internal->program_id = link_program(_internal->fragment_shader_id, _internal->vertex_shader_id);
+        detail::shader_internal_update_uniform_locations(_internal);
 
         if (
         (type == ShaderType::FRAGMENT and _internal->fragment_shader_id == 0) or
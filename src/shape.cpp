@@ -13,37 +13,85 @@
 
 #include <iostream>
 #include <sstream>
+#include <limits>
 
 namespace mousetrap
 {
     namespace detail
     {
-        DECLARE_NEW_TYPE(ShapeInternal, shape_internal, SHAPE_INTERNAL)
+        DECLARE_NEW_TYPE(ShapeGeometryInternal, shape_geometry_internal, SHAPE_GEOMETRY_INTERNAL)
 
-        static void shape_internal_finalize(GObject* object)
+        static void shape_geometry_internal_finalize(GObject* object)
         {
-            auto* self = MOUSETRAP_SHAPE_INTERNAL(object);
-            G_OBJECT_CLASS(shape_internal_parent_class)->finalize(object);
+            auto* self = MOUSETRAP_SHAPE_GEOMETRY_INTERNAL(object);
+            G_OBJECT_CLASS(shape_geometry_internal_parent_class)->finalize(object);
 
             if (detail::is_opengl_disabled())
                 return;
 
+            // vertex arrays are not shared between contexts, they have to be deleted in the one they were created in
+            detail::make_opengl_context_current();
+
             if (self->vertex_array_id != 0)
                 glDeleteVertexArrays(1, &self->vertex_array_id);
 
             if (self->vertex_buffer_id != 0)
                 glDeleteBuffers(1, &self->vertex_buffer_id);
 
-            delete self->color;
+            if (self->element_buffer_id != 0)
+                glDeleteBuffers(1, &self->element_buffer_id);
+
             delete self->vertices;
             delete self->indices;
             delete self->vertex_data;
         }
 
+        DEFINE_NEW_TYPE_TRIVIAL_INIT(ShapeGeometryInternal, shape_geometry_internal, SHAPE_GEOMETRY_INTERNAL)
+        DEFINE_NEW_TYPE_TRIVIAL_CLASS_INIT(ShapeGeometryInternal, shape_geometry_internal, SHAPE_GEOMETRY_INTERNAL)
+
+        static ShapeGeometryInternal* shape_geometry_internal_new()
+        {
+            auto* self = (ShapeGeometryInternal*) g_object_new(shape_geometry_internal_get_type(), nullptr);
+            shape_geometry_internal_init(self);
+
+            detail::make_opengl_context_current();
+
+            glGenVertexArrays(1, &self->vertex_array_id);
+            glGenBuffers(1, &self->vertex_buffer_id);
+            glGenBuffers(1, &self->element_buffer_id);
+
+            self->render_type = GL_TRIANGLE_STRIP;
+            self->shape_type = ShapeType::UNKNOWN;
+
+            self->vertices = new std::vector<Vertex>();
+            self->indices = new std::vector<int>();
+            self->vertex_data = new std::vector<VertexInfo>();
+
+            return self;
+        }
+
+        DECLARE_NEW_TYPE(ShapeInternal, shape_internal, SHAPE_INTERNAL)
+
+        static void shape_internal_finalize(GObject* object)
+        {
+            auto* self = MOUSETRAP_SHAPE_INTERNAL(object);
+            G_OBJECT_CLASS(shape_internal_parent_class)->finalize(object);
+
+            if (detail::is_opengl_disabled())
+                return;
+
+            if (self->geometry != nullptr)
+                g_object_unref(self->geometry);
+
+            delete self->color;
+            delete self->model_transform;
+        }
+
         DEFINE_NEW_TYPE_TRIVIAL_INIT(ShapeInternal, shape_internal, SHAPE_INTERNAL)
         DEFINE_NEW_TYPE_TRIVIAL_CLASS_INIT(ShapeInternal, shape_internal, SHAPE_INTERNAL)
 
-        static ShapeInternal* shape_internal_new()
+        /// @param geometry geometry to share, if nullptr, a new, empty geometry is allocated
+        static ShapeInternal* shape_internal_new(ShapeGeometryInternal* geometry = nullptr)
         {
             auto* self = (ShapeInternal*) g_object_new(shape_internal_get_type(), nullptr);
             shape_internal_init(self);
@@ -51,21 +99,22 @@ namespace mousetrap
             if (detail::is_opengl_disabled())
             {
                 log::critical("In shape_internal_new: Trying to instantiate mousetrap::Shape, but the OpenGL component is disabled", MOUSETRAP_DOMAIN);
+                self->geometry = nullptr;
                 return self;
             }
 
-            gdk_gl_context_make_current(detail::GL_CONTEXT);
-
-            glGenVertexArrays(1, &self->vertex_array_id);
-            glGenBuffers(1, &self->vertex_buffer_id);
+            if (geometry == nullptr)
+                self->geometry = shape_geometry_internal_new();
+            else
+            {
+                self->geometry = geometry;
+                g_object_ref(self->geometry);
+            }
 
             self->color = new RGBA(1, 1, 1, 1);
             self->is_visible = true;
-            self->render_type = GL_TRIANGLE_STRIP;
-
-            self->vertices = new std::vector<Vertex>();
-            self->indices = new std::vector<int>();
-            self->vertex_data = new std::vector<VertexInfo>();
+            self->has_color_override = false;
+            self->model_transform = new GLTransform();
             self->texture = nullptr;
 
             return self;
@@ -84,7 +133,8 @@ namespace mousetrap
 
     Shape::~Shape()
     {
-        if (not detail::is_opengl_disabled())
+        // _internal is nullptr after this shape was moved from
+        if (not detail::is_opengl_disabled() and _internal != nullptr)
             g_object_unref(_internal);
     }
 
@@ -96,15 +146,11 @@ namespace mousetrap
             return;
         }
 
-        if (G_IS_OBJECT(_internal))
-            g_object_unref(_internal);
-
         _internal = internal;
         g_object_ref(_internal);
     }
 
     Shape::Shape(const Shape& other)
-        : Shape()
     {
         if (detail::is_opengl_disabled())
         {
@@ -112,18 +158,12 @@ namespace mousetrap
             return;
         }
 
-        glGenVertexArrays(1, &_internal->vertex_array_id);
-        glGenBuffers(1, &_internal->vertex_buffer_id);
-
-        _internal->vertex_data = other._internal->vertex_data;
-        _internal->color = other._internal->color;
+        _internal = detail::shape_internal_new(other._internal->geometry);
+        *_internal->color = *other._internal->color;
+        _internal->has_color_override = other._internal->has_color_override;
         _internal->is_visible = other._internal->is_visible;
-        _internal->render_type = other._internal->render_type;
-        _internal->vertices = other._internal->vertices;
-        _internal->indices = other._internal->indices;
         _internal->texture = other._internal->texture;
-
-        update_data(true, true, true);
+        *_internal->model_transform = *other._internal->model_transform;
     }
 
     Shape& Shape::operator=(const Shape& other)
@@ -137,25 +177,23 @@ namespace mousetrap
         if (&other == this)
             return *this;
 
-        g_object_ref(other._internal);
+        if (_internal == nullptr)
+            _internal = detail::shape_internal_new();
 
-        glGenVertexArrays(1, &_internal->vertex_array_id);
-        glGenBuffers(1, &_internal->vertex_buffer_id);
+        g_object_ref(other._internal->geometry);
+        g_object_unref(_internal->geometry);
+        _internal->geometry = other._internal->geometry;
 
-        _internal->vertex_data = other._internal->vertex_data;
-        _internal->color = other._internal->color;
+        *_internal->color = *other._internal->color;
+        _internal->has_color_override = other._internal->has_color_override;
         _internal->is_visible = other._internal->is_visible;
-        _internal->render_type = other._internal->render_type;
-        _internal->vertices = other._internal->vertices;
-        _internal->indices = other._internal->indices;
         _internal->texture = other._internal->texture;
+        *_internal->model_transform = *other._internal->model_transform;
 
-        update_data();
         return *this;
     }
 
     Shape::Shape(Shape&& other) noexcept
-        : Shape()
     {
         if (detail::is_opengl_disabled())
         {
@@ -163,22 +201,8 @@ namespace mousetrap
             return;
         }
 
-        _internal->vertex_array_id = other._internal->vertex_array_id;
-        _internal->vertex_buffer_id = other._internal->vertex_buffer_id;
-
-        _internal->vertex_data = (other._internal->vertex_data);
-        _internal->color = (other._internal->color);
-        _internal->is_visible = (other._internal->is_visible);
-        _internal->render_type = (other._internal->render_type);
-        _internal->vertices = (other._internal->vertices);
-        _internal->indices = (other._internal->indices);
-        _internal->texture = (other._internal->texture);
-
-        other._internal->vertex_buffer_id = 0;
-        other._internal->vertex_array_id = 0;
+        _internal = other._internal;
         other._internal = nullptr;
-
-        update_data();
     }
 
     Shape& Shape::operator=(Shape&& other) noexcept
@@ -189,22 +213,14 @@ namespace mousetrap
             return *this;
         }
 
-        g_object_ref(other._internal);
-
-        _internal->vertex_array_id = other._internal->vertex_array_id;
-        _internal->vertex_buffer_id = other._internal->vertex_buffer_id;
-
-        _internal->vertex_data = (other._internal->vertex_data);
-        _internal->color = (other._internal->color);
-        _internal->is_visible = (other._internal->is_visible);
-        _internal->render_type = (other._internal->render_type);
-        _internal->vertices = (other._internal->vertices);
-        _internal->indices = (other._internal->indices);
-        _internal->texture = (other._internal->texture);
+        if (&other == this)
+            return *this;
 
-        other._internal->vertex_buffer_id = 0;
-        other._internal->vertex_array_id = 0;
+        if (_internal != nullptr)
+            g_object_unref(_internal);
 
+        _internal = other._internal;
+        other._internal = nullptr;
         return *this;
     }
 
@@ -213,7 +229,7 @@ namespace mousetrap
         if (detail::is_opengl_disabled())
             return 0;
 
-        return _internal->vertex_array_id;
+        return _internal->geometry->vertex_array_id;
     }
 
     NativeObject Shape::get_internal() const
@@ -229,13 +245,13 @@ namespace mousetrap
         if (detail::is_opengl_disabled())
             return;
 
-        _internal->vertex_data->clear();
-        _internal->vertex_data->reserve(_internal->vertices->size());
+        _internal->geometry->vertex_data->clear();
+        _internal->geometry->vertex_data->reserve(_internal->geometry->vertices->size());
 
-        for (auto &v : *_internal->vertices)
+        for (auto &v : *_internal->geometry->vertices)
         {
-            _internal->vertex_data->emplace_back();
-            auto &data = _internal->vertex_data->back();
+            _internal->geometry->vertex_data->emplace_back();
+            auto &data = _internal->geometry->vertex_data->back();
 
             auto as_gl_position = to_gl_position(v.position);
 
@@ -252,17 +268,61 @@ namespace mousetrap
             data._texture_coordinates[1] = v.texture_coordinates[1];
         }
 
+        // element buffer binding is part of the vertex array state, it stays bound after the vertex array is unbound
+        glBindVertexArray(_internal->geometry->vertex_array_id);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _internal->geometry->element_buffer_id);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, _internal->geometry->indices->size() * sizeof(int), _internal->geometry->indices->data(), GL_STATIC_DRAW);
+        glBindVertexArray(0);
+
         update_data(true, true, true);
     }
 
+    void Shape::make_geometry_unique(bool copy_data)
+    {
+        if (detail::is_opengl_disabled())
+            return;
+
+        auto* current = _internal->geometry;
+        const bool is_shared = g_atomic_int_get(&G_OBJECT(current)->ref_count) > 1;
+
+        if (is_shared)
+        {
+            // geometry is shared with another shape, detach before modifying it
+            _internal->geometry = detail::shape_geometry_internal_new();
+
+            if (copy_data)
+            {
+                *_internal->geometry->vertices = *current->vertices;
+                *_internal->geometry->indices = *current->indices;
+                _internal->geometry->render_type = current->render_type;
+                _internal->geometry->shape_type = current->shape_type;
+            }
+
+            g_object_unref(current);
+        }
+
+        // once the geometry is owned, a color set while it was shared is written to the vertices. If the data is not copied, the caller rebuilds the vertices with the shapes color
+        const bool bake_color = _internal->has_color_override and copy_data;
+        _internal->has_color_override = false;
+
+        if (bake_color)
+            for (auto& v : *_internal->geometry->vertices)
+                v.color = *_internal->color;
+
+        if (is_shared and copy_data)
+            initialize();
+        else if (bake_color)
+            update_color();
+    }
+
     void Shape::update_data(bool update_position, bool update_color, bool update_tex_coords) const
     {
         if (detail::is_opengl_disabled())
             return;
 
-        glBindVertexArray(_internal->vertex_array_id);
-        glBindBuffer(GL_ARRAY_BUFFER, _internal->vertex_buffer_id);
-        glBufferData(GL_ARRAY_BUFFER, _internal->vertex_data->size() * sizeof(struct detail::VertexInfo), _internal->vertex_data->data(), GL_STATIC_DRAW);
+        glBindVertexArray(_internal->geometry->vertex_array_id);
+        glBindBuffer(GL_ARRAY_BUFFER, _internal->geometry->vertex_buffer_id);
+        glBufferData(GL_ARRAY_BUFFER, _internal->geometry->vertex_data->size() * sizeof(struct detail::VertexInfo), _internal->geometry->vertex_data->data(), GL_STATIC_DRAW);
 
         if (update_position)
         {
@@ -312,10 +372,10 @@ namespace mousetrap
         if (detail::is_opengl_disabled())
             return;
 
-        for (uint64_t i = 0; i < _internal->vertices->size(); ++i)
+        for (uint64_t i = 0; i < _internal->geometry->vertices->size(); ++i)
         {
-            auto& v = _internal->vertices->at(i);
-            auto& data = _internal->vertex_data->at(i);
+            auto& v = _internal->geometry->vertices->at(i);
+            auto& data = _internal->geometry->vertex_data->at(i);
 
             auto as_gl_position = to_gl_position(v.position);
 
@@ -332,10 +392,10 @@ namespace mousetrap
         if (detail::is_opengl_disabled())
             return;
 
-        for (uint64_t i = 0; i < _internal->vertices->size(); ++i)
+        for (uint64_t i = 0; i < _internal->geometry->vertices->size(); ++i)
         {
-            auto& v = _internal->vertices->at(i);
-            auto& data = _internal->vertex_data->at(i);
+            auto& v = _internal->geometry->vertices->at(i);
+            auto& data = _internal->geometry->vertex_data->at(i);
 
             data._color[0] = v.color.r;
             data._color[1] = v.color.g;
@@ -351,10 +411,10 @@ namespace mousetrap
         if (detail::is_opengl_disabled())
             return;
 
-        for (uint64_t i = 0; i < _internal->vertices->size(); ++i)
+        for (uint64_t i = 0; i < _internal->geometry->vertices->size(); ++i)
         {
-            auto& v = _internal->vertices->at(i);
-            auto& data = _internal->vertex_data->at(i);
+            auto& v = _internal->geometry->vertices->at(i);
+            auto& data = _internal->geometry->vertex_data->at(i);
 
             data._texture_coordinates[0] = v.texture_coordinates[0];
             data._texture_coordinates[1] = v.texture_coordinates[1];
@@ -372,15 +432,42 @@ namespace mousetrap
             return;
 
         glUseProgram(shader.get_program_id());
-        glUniformMatrix4fv(shader.get_uniform_location("_transform"), 1, GL_FALSE, &(transform.transform[0][0]));
 
-        glUniform1i(shader.get_uniform_location("_texture_set"), _internal->texture != nullptr ? GL_TRUE : GL_FALSE);
+        // locations are cached by the shader when its program is linked
+        auto* shader_internal = (detail::ShaderInternal*) shader.get_internal();
+
+        // shaders that do not declare `_model_transform` receive the combined transform instead
+        if (shader_internal->model_transform_location != -1)
+        {
+            glUniformMatrix4fv(shader_internal->transform_location, 1, GL_FALSE, &(transform.transform[0][0]));
+            glUniformMatrix4fv(shader_internal->model_transform_location, 1, GL_FALSE, &(_internal->model_transform->transform[0][0]));
+        }
+        else
+        {
+            auto combined = transform.combine_with(*_internal->model_transform);
+            glUniformMatrix4fv(shader_internal->transform_location, 1, GL_FALSE, &(combined.transform[0][0]));
+        }
+
+        glUniform1i(shader_internal->texture_set_location, _internal->texture != nullptr ? GL_TRUE : GL_FALSE);
 
         if (_internal->texture != nullptr)
             _internal->texture->bind();
 
-        glBindVertexArray(_internal->vertex_array_id);
-        glDrawElements(_internal->render_type, _internal->indices->size(), GL_UNSIGNED_INT, _internal->indices->data());
+        glBindVertexArray(_internal->geometry->vertex_array_id);
+
+        // with the attribute array disabled, every vertex receives the constant attribute value
+        auto color_location = Shader::get_vertex_color_location();
+        if (_internal->has_color_override)
+        {
+            auto& color = *_internal->color;
+            glDisableVertexAttribArray(color_location);
+            glVertexAttrib4f(color_location, color.r, color.g, color.b, color.a);
+        }
+
+        glDrawElements(_internal->geometry->render_type, _internal->geometry->indices->size(), GL_UNSIGNED_INT, nullptr);
+
+        if (_internal->has_color_override)
+            glEnableVertexAttribArray(color_location);
 
         if (_internal->texture != nullptr)
             _internal->texture->unbind();
@@ -424,14 +511,16 @@ namespace mousetrap
         if (detail::is_opengl_disabled())
             return;
 
-        _internal->vertices->clear();
-        _internal->indices->clear();
+        make_geometry_unique(false);
+
+        _internal->geometry->vertices->clear();
+        _internal->geometry->indices->clear();
 
-        _internal->vertices->push_back(Vertex(p.x, p.y, *_internal->color));
-        _internal->indices->push_back(0);
+        _internal->geometry->vertices->push_back(Vertex(p.x, p.y, *_internal->color));
+        _internal->geometry->indices->push_back(0);
 
-        _internal->render_type = GL_POINTS;
-        _internal->shape_type = detail::ShapeType::POINT;
+        _internal->geometry->render_type = GL_POINTS;
+        _internal->geometry->shape_type = detail::ShapeType::POINT;
         initialize();
     }
 
@@ -440,18 +529,20 @@ namespace mousetrap
         if (detail::is_opengl_disabled())
             return;
 
-        _internal->vertices->clear();
-        _internal->indices->clear();
+        make_geometry_unique(false);
+
+        _internal->geometry->vertices->clear();
+        _internal->geometry->indices->clear();
 
         for (uint64_t i = 0; i < points.size(); ++i)
         {
             auto p = points.at(i);
-            _internal->vertices->push_back(Vertex(p.x, p.y, *_internal->color));
-            _internal->indices->push_back(i);
+            _internal->geometry->vertices->push_back(Vertex(p.x, p.y, *_internal->color));
+            _internal->geometry->indices->push_back(i);
         }
 
-        _internal->render_type = GL_POINTS;
-        _internal->shape_type = detail::ShapeType::POINTS;
+        _internal->geometry->render_type = GL_POINTS;
+        _internal->geometry->shape_type = detail::ShapeType::POINTS;
         initialize();
     }
 
@@ -460,16 +551,18 @@ namespace mousetrap
         if (detail::is_opengl_disabled())
             return;
 
-        *_internal->vertices =
+        make_geometry_unique(false);
+
+        *_internal->geometry->vertices =
         {
             Vertex(a.x, a.y, *_internal->color),
             Vertex(b.x, b.y, *_internal->color),
             Vertex(c.x, c.y, *_internal->color)
         };
 
-        *_internal->indices = {0, 1, 2};
-        _internal->render_type = GL_TRIANGLES;
-        _internal->shape_type = detail::ShapeType::TRIANGLE;
+        *_internal->geometry->indices = {0, 1, 2};
+        _internal->geometry->render_type = GL_TRIANGLES;
+        _internal->geometry->shape_type = detail::ShapeType::TRIANGLE;
         initialize();
     }
 
@@ -478,7 +571,9 @@ namespace mousetrap
         if (detail::is_opengl_disabled())
             return;
 
-        *_internal->vertices =
+        make_geometry_unique(false);
+
+        *_internal->geometry->vertices =
         {
             Vertex(top_left.x, top_left.y, *_internal->color),
             Vertex(top_left.x + size.x, top_left.y, *_internal->color),
@@ -486,14 +581,14 @@ namespace mousetrap
             Vertex(top_left.x, top_left.y - size.y, *_internal->color)
         };
 
-        _internal->vertices->at(0).texture_coordinates = {0, 0};
-        _internal->vertices->at(1).texture_coordinates = {1, 0};
-        _internal->vertices->at(2).texture_coordinates = {1, 1};
-        _internal->vertices->at(3).texture_coordinates = {0, 1};
+        _internal->geometry->vertices->at(0).texture_coordinates = {0, 0};
+        _internal->geometry->vertices->at(1).texture_coordinates = {1, 0};
+        _internal->geometry->vertices->at(2).texture_coordinates = {1, 1};
+        _internal->geometry->vertices->at(3).texture_coordinates = {0, 1};
 
-        *_internal->indices = {0, 1, 2, 3};
-        _internal->render_type = GL_TRIANGLE_FAN;
-        _internal->shape_type = detail::ShapeType::RECTANGLE;
+        *_internal->geometry->indices = {0, 1, 2, 3};
+        _internal->geometry->render_type = GL_TRIANGLE_FAN;
+        _internal->geometry->shape_type = detail::ShapeType::RECTANGLE;
         initialize();
     }
 
@@ -502,6 +597,8 @@ namespace mousetrap
         if (detail::is_opengl_disabled())
             return;
 
+        make_geometry_unique(false);
+
         float x = top_left.x;
         float y = top_left.y;
         float w = outer_size.x;
@@ -513,7 +610,7 @@ namespace mousetrap
             return Vertex(x, y, *_internal->color);
         };
 
-        *_internal->vertices =
+        *_internal->geometry->vertices =
         {
             v(x, y),
             v(x + w, y),
@@ -529,7 +626,7 @@ namespace mousetrap
             v(x + w, y - h)
         };
 
-        *_internal->indices = {
+        *_internal->geometry->indices = {
             0, 1, 5,
             0, 5, 2,
             4, 5, 9,
@@ -540,8 +637,8 @@ namespace mousetrap
             2, 7, 6
         };
 
-        _internal->render_type = GL_TRIANGLES;
-        _internal->shape_type = detail::ShapeType::RECTANGULAR_FRAME;
+        _internal->geometry->render_type = GL_TRIANGLES;
+        _internal->geometry->shape_type = detail::ShapeType::RECTANGULAR_FRAME;
         initialize();
     }
 
@@ -550,15 +647,17 @@ namespace mousetrap
         if (detail::is_opengl_disabled())
             return;
 
-        *_internal->vertices =
+        make_geometry_unique(false);
+
+        *_internal->geometry->vertices =
         {
             Vertex(a.x, a.y, *_internal->color),
             Vertex(b.x, b.y, *_internal->color)
         };
 
-        *_internal->indices = {0, 1};
-        _internal->render_type = GL_LINES;
-        _internal->shape_type = detail::ShapeType::LINE;
+        *_internal->geometry->indices = {0, 1};
+        _internal->geometry->render_type = GL_LINES;
+        _internal->geometry->shape_type = detail::ShapeType::LINE;
         initialize();
     }
 
@@ -567,19 +666,21 @@ namespace mousetrap
         if (detail::is_opengl_disabled())
             return;
 
-        _internal->vertices->clear();
+        make_geometry_unique(false);
+
+        _internal->geometry->vertices->clear();
         for (const auto& pair : in)
         {
-            _internal->vertices->emplace_back(pair.first.x, pair.first.y, *_internal->color);
-            _internal->vertices->emplace_back(pair.second.x, pair.second.y, *_internal->color);
+            _internal->geometry->vertices->emplace_back(pair.first.x, pair.first.y, *_internal->color);
+            _internal->geometry->vertices->emplace_back(pair.second.x, pair.second.y, *_internal->color);
         }
 
-        _internal->indices->clear();
-        for (uint64_t i = 0; i < _internal->vertices->size(); ++i)
-            _internal->indices->push_back(i);
+        _internal->geometry->indices->clear();
+        for (uint64_t i = 0; i < _internal->geometry->vertices->size(); ++i)
+            _internal->geometry->indices->push_back(i);
 
-        _internal->render_type = GL_LINES;
-        _internal->shape_type = detail::ShapeType::LINES;
+        _internal->geometry->render_type = GL_LINES;
+        _internal->geometry->shape_type = detail::ShapeType::LINES;
         initialize();
     }
 
@@ -595,7 +696,7 @@ namespace mousetrap
         }
 
         as_ellipse(center, radius, radius, n_outer_vertices);
-        _internal->shape_type = detail::ShapeType::CIRCLE;
+        _internal->geometry->shape_type = detail::ShapeType::CIRCLE;
     }
 
     void Shape::as_ellipse(Vector2f center, float x_radius, float y_radius, uint64_t n_outer_vertices)
@@ -603,6 +704,8 @@ namespace mousetrap
         if (detail::is_opengl_disabled())
             return;
 
+        make_geometry_unique(false);
+
         if (n_outer_vertices < 3)
         {
             log::critical("In Shape::as_ellipse: n_outer_vertices < 3");
@@ -611,27 +714,27 @@ namespace mousetrap
 
         const float step = 360.f / n_outer_vertices;
 
-        _internal->vertices->clear();
-        _internal->vertices->push_back(Vertex(center.x, center.y, *_internal->color));
+        _internal->geometry->vertices->clear();
+        _internal->geometry->vertices->push_back(Vertex(center.x, center.y, *_internal->color));
 
         for (float angle = 0; angle < 360; angle += step)
         {
             auto as_radians = angle * 3.141592 / 180.f;
-            _internal->vertices->emplace_back(
+            _internal->geometry->vertices->emplace_back(
                 center.x + cos(as_radians) * x_radius,
                 center.y + sin(as_radians) * y_radius,
                 *_internal->color
             );
         }
 
-        _internal->indices->clear();
-        for (uint64_t i = 0; i < _internal->vertices->size(); ++i)
-            _internal->indices->push_back(i);
+        _internal->geometry->indices->clear();
+        for (uint64_t i = 0; i < _internal->geometry->vertices->size(); ++i)
+            _internal->geometry->indices->push_back(i);
 
-        _internal->indices->push_back(1);
+        _internal->geometry->indices->push_back(1);
 
-        _internal->render_type = GL_TRIANGLE_FAN;
-        _internal->shape_type = detail::ShapeType::ELLIPSE;
+        _internal->geometry->render_type = GL_TRIANGLE_FAN;
+        _internal->geometry->shape_type = detail::ShapeType::ELLIPSE;
         initialize();
     }
 
@@ -641,7 +744,7 @@ namespace mousetrap
             return;
 
         as_elliptical_ring(center, outer_radius, outer_radius, thickness, thickness, n_outer_vertices);
-        _internal->shape_type = detail::ShapeType::CIRCULAR_RING;
+        _internal->geometry->shape_type = detail::ShapeType::CIRCULAR_RING;
     }
 
     void Shape::as_elliptical_ring(Vector2f center, float x_radius, float y_radius, float x_thickness, float y_thickness, uint64_t n_outer_vertices)
@@ -649,48 +752,50 @@ namespace mousetrap
         if (detail::is_opengl_disabled())
             return;
 
+        make_geometry_unique(false);
+
         const float step = 360.f / n_outer_vertices;
-        _internal->vertices->clear();
+        _internal->geometry->vertices->clear();
 
         for (float angle = 0; angle < 360; angle += step)
         {
             auto as_radians = angle * 3.141592 / 180.f;
-            _internal->vertices->emplace_back(
+            _internal->geometry->vertices->emplace_back(
                 center.x + cos(as_radians) * x_radius,
                 center.y + sin(as_radians) * y_radius,
                 *_internal->color
             );
 
-            _internal->vertices->emplace_back(
+            _internal->geometry->vertices->emplace_back(
                 center.x + cos(as_radians) * (x_radius - x_thickness),
                 center.y + sin(as_radians) * (y_radius - y_thickness),
                 *_internal->color
             );
         }
 
-        _internal->render_type = GL_TRIANGLES;
-        _internal->shape_type = detail::ShapeType::ELLIPTICAL_RING;
+        _internal->geometry->render_type = GL_TRIANGLES;
+        _internal->geometry->shape_type = detail::ShapeType::ELLIPTICAL_RING;
 
-        _internal->indices->clear();
+        _internal->geometry->indices->clear();
         for (uint64_t i = 0; i < n_outer_vertices - 1; ++i)
         {
             auto a = i * 2;
-            _internal->indices->push_back(a);
-            _internal->indices->push_back(a+2);
-            _internal->indices->push_back(a+3);
-            _internal->indices->push_back(a);
-            _internal->indices->push_back(a+1);
-            _internal->indices->push_back(a+3);
+            _internal->geometry->indices->push_back(a);
+            _internal->geometry->indices->push_back(a+2);
+            _internal->geometry->indices->push_back(a+3);
+            _internal->geometry->indices->push_back(a);
+            _internal->geometry->indices->push_back(a+1);
+            _internal->geometry->indices->push_back(a+3);
         }
 
-        auto a = _internal->vertices->size() - 2;
-        _internal->indices->push_back(a);
-        _internal->indices->push_back(0);
-        _internal->indices->push_back(1);
+        auto a = _internal->geometry->vertices->size() - 2;
+        _internal->geometry->indices->push_back(a);
+        _internal->geometry->indices->push_back(0);
+        _internal->geometry->indices->push_back(1);
 
-        _internal->indices->push_back(a);
-        _internal->indices->push_back(a+1);
-        _internal->indices->push_back(1);
+        _internal->geometry->indices->push_back(a);
+        _internal->geometry->indices->push_back(a+1);
+        _internal->geometry->indices->push_back(1);
 
         initialize();
     }
@@ -700,18 +805,20 @@ namespace mousetrap
         if (detail::is_opengl_disabled())
             return;
 
-        _internal->vertices->clear();
-        _internal->indices->clear();
+        make_geometry_unique(false);
+
+        _internal->geometry->vertices->clear();
+        _internal->geometry->indices->clear();
 
         uint64_t i = 0;
         for (auto& position : positions)
         {
-            _internal->vertices->emplace_back(position.x, position.y, *_internal->color);
-            _internal->indices->push_back(i++);
+            _internal->geometry->vertices->emplace_back(position.x, position.y, *_internal->color);
+            _internal->geometry->indices->push_back(i++);
         }
 
-        _internal->render_type = GL_LINE_STRIP;
-        _internal->shape_type = detail::ShapeType::LINE_STRIP;
+        _internal->geometry->render_type = GL_LINE_STRIP;
+        _internal->geometry->shape_type = detail::ShapeType::LINE_STRIP;
         initialize();
     }
 
@@ -720,20 +827,22 @@ namespace mousetrap
         if (detail::is_opengl_disabled())
             return;
 
-        _internal->vertices->clear();
-        _internal->indices->clear();
+        make_geometry_unique(false);
+
+        _internal->geometry->vertices->clear();
+        _internal->geometry->indices->clear();
 
         auto positions = sort_by_angle(positions_in);
 
         uint64_t i = 0;
         for (auto& position : positions)
         {
-            _internal->vertices->emplace_back(position.x, position.y, *_internal->color);
-            _internal->indices->push_back(i++);
+            _internal->geometry->vertices->emplace_back(position.x, position.y, *_internal->color);
+            _internal->geometry->indices->push_back(i++);
         }
 
-        _internal->render_type = GL_LINE_LOOP;
-        _internal->shape_type = detail::ShapeType::WIREFRAME;
+        _internal->geometry->render_type = GL_LINE_LOOP;
+        _internal->geometry->shape_type = detail::ShapeType::WIREFRAME;
         initialize();
     }
 
@@ -742,20 +851,49 @@ namespace mousetrap
         if (detail::is_opengl_disabled())
             return;
 
-        _internal->vertices->clear();
-        _internal->indices->clear();
+        make_geometry_unique(false);
+
+        _internal->geometry->vertices->clear();
+        _internal->geometry->indices->clear();
 
         auto positions = sort_by_angle(positions_in);
 
         uint64_t i = 0;
         for (auto& position : positions)
         {
-            _internal->vertices->emplace_back(position.x, position.y, *_internal->color);
-            _internal->indices->push_back(i++);
+            _internal->geometry->vertices->emplace_back(position.x, position.y, *_internal->color);
+            _internal->geometry->indices->push_back(i++);
         }
 
-        _internal->render_type = GL_TRIANGLE_FAN;
-        _internal->shape_type = detail::ShapeType::POLYGON;
+        _internal->geometry->render_type = GL_TRIANGLE_FAN;
+        _internal->geometry->shape_type = detail::ShapeType::POLYGON;
+        initialize();
+    }
+
+    void Shape::as_quads(const std::vector<Vertex>& vertices)
+    {
+        if (detail::is_opengl_disabled())
+            return;
+
+        make_geometry_unique(false);
+
+        if (vertices.size() % 4 != 0)
+            log::critical("In Shape::as_quads: number of vertices is not a multiple of 4, trailing vertices are ignored", MOUSETRAP_DOMAIN);
+
+        uint64_t n_quads = vertices.size() / 4;
+        *_internal->geometry->vertices = std::vector<Vertex>(vertices.begin(), vertices.begin() + n_quads * 4);
+
+        _internal->geometry->indices->clear();
+        _internal->geometry->indices->reserve(n_quads * 6);
+        for (uint64_t i = 0; i < n_quads; ++i)
+        {
+            int a = i * 4;
+            for (int index : {a, a + 1, a + 2, a, a + 2, a + 3})
+                _internal->geometry->indices->push_back(index);
+        }
+
+        _internal->geometry->render_type = GL_TRIANGLES;
+        _internal->geometry->shape_type = detail::ShapeType::QUADS;
         initialize();
     }
 
@@ -764,12 +902,14 @@ namespace mousetrap
         if (detail::is_opengl_disabled())
             return;
 
-        _internal->vertices->clear();
-        _internal->indices->clear();
+        make_geometry_unique(false);
+
+        _internal->geometry->vertices->clear();
+        _internal->geometry->indices->clear();
 
         std::vector<std::pair<Vector2f, Vector2f>> positions;
 
-        auto type = shape._internal->shape_type;
+        auto type = shape._internal->geometry->shape_type;
         using namespace detail;
         if (type == ShapeType::UNKNOWN)
         {
@@ -867,18 +1007,12 @@ namespace mousetrap
         }
         else if (type == ShapeType::RECTANGLE)
         {
-            auto aabb = shape.get_bounding_box();
-            float x = aabb.top_left.x;
-            float y = aabb.top_left.y;
-            float w = aabb.size.x;
-            float h = aabb.size.y;
-
-            positions = {
-                {{x, y}, {x + w, y}},
-                {{x + w, y}, {x + w, y - h}},
-                {{x + w, y - h}, {x, y - h}},
-                {{x, y - h}, {x, y}}
-            };
+            // corners instead of the bounding box, such that the outline of a rotated rectangle is rotated as well
+            for (uint64_t i = 0; i < 4; ++i)
+                positions.push_back({
+                    shape.get_vertex_position(i),
+                    shape.get_vertex_position((i + 1) % 4)
+                });
         }
         else if (type == ShapeType::CIRCLE or type == ShapeType::ELLIPSE)
         {
@@ -893,6 +1027,15 @@ namespace mousetrap
                 shape.get_vertex_position(1)
             });
         }
+        else if (type == ShapeType::QUADS)
+        {
+            for (uint64_t i = 0; i + 3 < shape.get_n_vertices(); i += 4)
+                for (uint64_t j = 0; j < 4; ++j)
+                    positions.push_back({
+                        shape.get_vertex_position(i + j),
+                        shape.get_vertex_position(i + (j + 1) % 4)
+                    });
+        }
         else if (type == ShapeType::POLYGON)
         {
             for (uint64_t i = 0; i < shape.get_n_vertices() - 1; ++i)
@@ -978,20 +1121,20 @@ namespace mousetrap
         float hue = 0;
         float hue_step = 1.f / positions.size();
 
-        _internal->vertices->clear();
+        _internal->geometry->vertices->clear();
 
         for (const auto& pair : positions)
         {
-            _internal->vertices->emplace_back(pair.first.x, pair.first.y, *_internal->color);
-            _internal->vertices->emplace_back(pair.second.x, pair.second.y, *_internal->color);
+            _internal->geometry->vertices->emplace_back(pair.first.x, pair.first.y, *_internal->color);
+            _internal->geometry->vertices->emplace_back(pair.second.x, pair.second.y, *_internal->color);
         }
 
-        _internal->indices->clear();
-        for (uint64_t i = 0; i < _internal->vertices->size(); ++i)
-            _internal->indices->push_back(i);
+        _internal->geometry->indices->clear();
+        for (uint64_t i = 0; i < _internal->geometry->vertices->size(); ++i)
+            _internal->geometry->indices->push_back(i);
 
-        _internal->render_type = GL_LINES;
-        _internal->shape_type = detail::ShapeType::OUTLINE;
+        _internal->geometry->render_type = GL_LINES;
+        _internal->geometry->shape_type = detail::ShapeType::OUTLINE;
         initialize();
     }
 
@@ -1000,15 +1143,16 @@ namespace mousetrap
         if (detail::is_opengl_disabled())
             return;
 
-        if (i > _internal->vertices->size())
+        if (i > _internal->geometry->vertices->size())
         {
             std::stringstream str;
-            str << "In mousetrap::Shape::set_vertex_internal->color: index " << i << " out of bounds for an object with " << _internal->vertices->size() << " vertices" <<  std::endl;
+            str << "In mousetrap::Shape::set_vertex_internal->color: index " << i << " out of bounds for an object with " << _internal->geometry->vertices->size() << " vertices" <<  std::endl;
             log::critical(str.str(), MOUSETRAP_DOMAIN);
             return;
         }
 
-        _internal->vertices->at(i).color = color;
+        make_geometry_unique();
+        _internal->geometry->vertices->at(i).color = color;
         update_color();
         update_data(false, true, false);
     }
@@ -1018,15 +1162,18 @@ namespace mousetrap
         if (detail::is_opengl_disabled())
             return RGBA(0, 0, 0, 0);
 
-        if (index > _internal->vertices->size())
+        if (index > _internal->geometry->vertices->size())
         {
             std::stringstream str;
-            str << "In mousetrap::Shape::get_vertex_internal->color: index " << index << " out of bounds for an object with " << _internal->vertices->size() << " vertices";
+            str << "In mousetrap::Shape::get_vertex_internal->color: index " << index << " out of bounds for an object with " << _internal->geometry->vertices->size() << " vertices";
             log::critical(str.str(), MOUSETRAP_DOMAIN);
 
             return RGBA(0, 0, 0, 0);
         }
-        return RGBA(_internal->vertices->at(index).color);
+        if (_internal->has_color_override)
+            return *_internal->color;
+
+        return RGBA(_internal->geometry->vertices->at(index).color);
     }
 
     void Shape::set_vertex_position(uint64_t i, Vector3f position)
@@ -1034,33 +1181,96 @@ namespace mousetrap
         if (detail::is_opengl_disabled())
             return;
 
-        if (i > _internal->vertices->size())
+        if (i > _internal->geometry->vertices->size())
         {
             std::stringstream str;
-            str << "[ERROR] In mousetrap::Shape::set_vertex_position: index " << i << " out of bounds for an object with " << _internal->vertices->size() << " vertices";
+            str << "[ERROR] In mousetrap::Shape::set_vertex_position: index " << i << " out of bounds for an object with " << _internal->geometry->vertices->size() << " vertices";
             log::critical(str.str(), MOUSETRAP_DOMAIN);
             return;
         }
 
-        _internal->vertices->at(i).position = position;
+        // position is given after the model transform, like the one returned by get_vertex_position
+        const auto& model_transform = _internal->model_transform->transform;
+        if (model_transform != glm::mat4x4(1) and glm::determinant(model_transform) != 0)
+        {
+            auto inverse = GLTransform();
+            inverse.transform = glm::inverse(model_transform);
+            position = inverse.apply_to(position);
+        }
+
+        make_geometry_unique();
+        _internal->geometry->vertices->at(i).position = position;
         update_position();
         update_data(true, false, false);
     }
 
+    void Shape::set_vertices(uint64_t first, const std::vector<Vertex>& vertices)
+    {
+        if (detail::is_opengl_disabled())
+            return;
+
+        if (first + vertices.size() > _internal->geometry->vertices->size())
+        {
+            std::stringstream str;
+            str << "In mousetrap::Shape::set_vertices: range [" << first << ", " << first + vertices.size() << ") out of bounds for an object with " << _internal->geometry->vertices->size() << " vertices";
+            log::critical(str.str(), MOUSETRAP_DOMAIN);
+            return;
+        }
+
+        if (vertices.empty())
+            return;
+
+        make_geometry_unique();
+
+        for (uint64_t i = 0; i < vertices.size(); ++i)
+        {
+            auto& v = vertices.at(i);
+            _internal->geometry->vertices->at(first + i) = v;
+
+            auto& data = _internal->geometry->vertex_data->at(first + i);
+            auto as_gl_position = to_gl_position(v.position);
+
+            data._position[0] = as_gl_position[0];
+            data._position[1] = as_gl_position[1];
+            data._position[2] = as_gl_position[2];
+
+            data._color[0] = v.color.r;
+            data._color[1] = v.color.g;
+            data._color[2] = v.color.b;
+            data._color[3] = v.color.a;
+
+            data._texture_coordinates[0] = v.texture_coordinates[0];
+            data._texture_coordinates[1] = v.texture_coordinates[1];
+        }
+
+        glBindBuffer(GL_ARRAY_BUFFER, _internal->geometry->vertex_buffer_id);
+        glBufferSubData(GL_ARRAY_BUFFER,
+            first * sizeof(detail::VertexInfo),
+            vertices.size() * sizeof(detail::VertexInfo),
+            _internal->geometry->vertex_data->data() + first
+        );
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
     Vector3f Shape::get_vertex_position(uint64_t i) const
     {
         if (detail::is_opengl_disabled())
             return Vector3f(0, 0, 0);
 
-        if (i > _internal->vertices->size())
+        if (i > _internal->geometry->vertices->size())
         {
             std::stringstream str;
-            str << "In mousetrap::Shape::get_vertex_position: index " << i << " out of bounds for an object with " << _internal->vertices->size() << " vertices";
+            str << "In mousetrap::Shape::get_vertex_position: index " << i << " out of bounds for an object with " << _internal->geometry->vertices->size() << " vertices";
             log::critical(str.str(), MOUSETRAP_DOMAIN);
             return Vector3f();
         }
 
-        return _internal->vertices->at(i).position;
+        auto model_transform = *_internal->model_transform;
+        const auto& position = _internal->geometry->vertices->at(i).position;
+        if (model_transform.transform == glm::mat4x4(1))
+            return position;
+
+        return model_transform.apply_to(position);
     }
 
     void Shape::set_vertex_texture_coordinate(uint64_t i, Vector2f coordinates)
@@ -1068,15 +1278,16 @@ namespace mousetrap
         if (detail::is_opengl_disabled())
             return;
 
-        if (i > _internal->vertices->size())
+        if (i > _internal->geometry->vertices->size())
         {
             std::stringstream str;
-            str << "In mousetrap::Shape::set_vertex_internal->texture_coordinate: index " << i << " out of bounds for an object with " << _internal->vertices->size() << " vertices";
+            str << "In mousetrap::Shape::set_vertex_internal->texture_coordinate: index " << i << " out of bounds for an object with " << _internal->geometry->vertices->size() << " vertices";
             log::critical(str.str(), MOUSETRAP_DOMAIN);
             return;
         }
 
-        _internal->vertices->at(i).texture_coordinates = coordinates;
+        make_geometry_unique();
+        _internal->geometry->vertices->at(i).texture_coordinates = coordinates;
         update_texture_coordinate();
         update_data(false, false, true);
     }
@@ -1086,13 +1297,13 @@ namespace mousetrap
         if (detail::is_opengl_disabled())
             return Vector2f(0, 0);
 
-        if (i > _internal->vertices->size())
+        if (i > _internal->geometry->vertices->size())
         {
-            std::cerr << "[ERROR] In mousetrap::Shape::get_vertex_position: index " << i << " out of bounds for an object with " << _internal->vertices->size() << " vertices" <<  std::endl;
+            std::cerr << "[ERROR] In mousetrap::Shape::get_vertex_position: index " << i << " out of bounds for an object with " << _internal->geometry->vertices->size() << " vertices" <<  std::endl;
             return Vector2f();
         }
 
-        return _internal->vertices->at(i).texture_coordinates;
+        return _internal->geometry->vertices->at(i).texture_coordinates;
     }
 
     uint64_t Shape::get_n_vertices() const
@@ -1100,7 +1311,7 @@ namespace mousetrap
         if (detail::is_opengl_disabled())
             return 0;
 
-        return _internal->vertices->size();
+        return _internal->geometry->vertices->size();
     }
 
     void Shape::set_color(RGBA color)
@@ -1110,7 +1321,15 @@ namespace mousetrap
 
         *_internal->color = color;
 
-        for (auto& v : *_internal->vertices)
+        // recoloring shared geometry would require a copy, the color is applied when rendering instead
+        if (g_atomic_int_get(&G_OBJECT(_internal->geometry)->ref_count) > 1)
+        {
+            _internal->has_color_override = true;
+            return;
+        }
+
+        _internal->has_color_override = false;
+        for (auto& v : *_internal->geometry->vertices)
             v.color = color;
 
         update_color();
@@ -1137,27 +1356,24 @@ namespace mousetrap
         if (detail::is_opengl_disabled())
             return Vector2f(0, 0);
 
-        static const auto negative_infinity = std::numeric_limits<float>::min();
-        static const auto positive_infinity = std::numeric_limits<float>::max();
-
-        Vector3f min = Vector3f(positive_infinity);
-        Vector3f max = Vector3f(negative_infinity);
+        auto aabb = get_bounding_box();
+        return Vector2f(
+            aabb.top_left.x + aabb.size.x / 2,
+            aabb.top_left.y - aabb.size.y / 2
+        );
+    }
 
-        for (auto& v : *_internal->vertices)
+    namespace detail
+    {
+        // offset in vertex space that moves the transformed shape by `offset`, the model transform is affine so only its linear part matters
+        static Vector2f shape_get_vertex_offset(const GLTransform& model_transform, Vector2f offset)
         {
-            min.x = std::min(min.x, v.position.x);
-            min.y = std::min(min.y, v.position.y);
-            min.z = std::min(min.z, v.position.z);
-            max.x = std::max(max.x, v.position.x);
-            max.y = std::max(max.y, v.position.y);
-            max.z = std::max(max.z, v.position.z);
-        }
+            auto linear = glm::mat2(model_transform.transform);
+            if (glm::determinant(linear) == 0)
+                return offset;
 
-        return Vector3f(
-        min.x + (max.x - min.x) / 2,
-        min.y + (max.y - min.y) / 2,
-        min.z + (max.z - min.z) / 2
-        );
+            return glm::inverse(linear) * offset;
+        }
     }
 
     void Shape::set_centroid(Vector2f position)
@@ -1165,15 +1381,9 @@ namespace mousetrap
         if (detail::is_opengl_disabled())
             return;
 
-        auto delta = position - get_centroid();
-        for (auto& v : *_internal->vertices)
-        {
-            v.position.x += delta.x;
-            v.position.y += delta.y;
-        }
-
-        update_position();
-        update_data(true, false, false);
+        auto transform = GLTransform();
+        transform.translate(detail::shape_get_vertex_offset(*_internal->model_transform, position - get_centroid()));
+        apply_transform(transform);
     }
 
     Rectangle Shape::get_bounding_box() const
@@ -1181,23 +1391,27 @@ namespace mousetrap
         if (detail::is_opengl_disabled())
             return mousetrap::Rectangle{{0, 0}, {0, 0}};
 
+        if (_internal->geometry->vertices->empty())
+            return mousetrap::Rectangle{{0, 0}, {0, 0}};
+
         float min_x = std::numeric_limits<float>::max();
         float min_y = std::numeric_limits<float>::max();
-        float min_z = std::numeric_limits<float>::max();
 
-        float max_x = std::numeric_limits<float>::min();
-        float max_y = std::numeric_limits<float>::min();
-        float max_z = std::numeric_limits<float>::min();
+        float max_x = std::numeric_limits<float>::lowest();
+        float max_y = std::numeric_limits<float>::lowest();
+
+        auto model_transform = *_internal->model_transform;
+        const bool is_identity = model_transform.transform == glm::mat4x4(1);
 
-        for (auto& v : *_internal->vertices)
+        for (auto& v : *_internal->geometry->vertices)
         {
-            min_x = std::min(min_x, v.position.x);
-            min_y = std::min(min_y, v.position.y);
-            min_z = std::min(min_z, v.position.z);
+            auto position = is_identity ? v.position : model_transform.apply_to(v.position);
 
-            max_x = std::max(max_x, v.position.x);
-            max_y = std::max(max_y, v.position.y);
-            max_z = std::max(max_z, v.position.z);
+            min_x = std::min(min_x, position.x);
+            min_y = std::min(min_y, position.y);
+
+            max_x = std::max(max_x, position.x);
+            max_y = std::max(max_y, position.y);
         }
 
         return mousetrap::Rectangle{
@@ -1227,15 +1441,37 @@ namespace mousetrap
         if (detail::is_opengl_disabled())
             return;
 
-        auto delta = position - get_bounding_box().top_left;
-        for (auto& v : *_internal->vertices)
-        {
-            v.position.x += delta.x;
-            v.position.y += delta.y;
-        }
+        auto transform = GLTransform();
+        transform.translate(detail::shape_get_vertex_offset(*_internal->model_transform, position - get_bounding_box().top_left));
+        apply_transform(transform);
+    }
 
-        update_position();
-        update_data(true, false, false);
+    void Shape::apply_transform(GLTransform transform)
+    {
+        if (detail::is_opengl_disabled())
+            return;
+
+        make_geometry_unique();
+
+        auto& vertices = *_internal->geometry->vertices;
+        auto& data = *_internal->geometry->vertex_data;
+
+        if (vertices.empty())
+            return;
+
+        // to_gl_position is the identity, so the transformed position can be written to the vertex data directly
+        detail::apply_transform_to_positions(
+            transform.transform,
+            &vertices.front().position.x, sizeof(Vertex),
+            &vertices.front().position.x, sizeof(Vertex),
+            data.size() == vertices.size() ? data.front()._position : nullptr, sizeof(detail::VertexInfo),
+            vertices.size()
+        );
+
+        if (data.size() != vertices.size())
+            initialize();
+        else
+            update_data(true, false, false);
     }
 
     void Shape::rotate(Angle angle, Vector2f origin)
@@ -1244,18 +1480,55 @@ namespace mousetrap
             return;
 
         auto transform = GLTransform();
-        //transform.translate({-1 * origin.x, -1 * origin.y});
         transform.rotate(angle, origin);
-        //transform.translate({origin.x, origin.y});
+        *_internal->model_transform = transform.combine_with(*_internal->model_transform);
+    }
 
-        for (auto& v : *_internal->vertices)
-        {
-            auto pos = v.position;
-            v.position = transform.apply_to(pos);
-        }
+    void Shape::translate(Vector2f offset)
+    {
+        if (detail::is_opengl_disabled())
+            return;
 
-        update_position();
-        update_data(true, false, false);
+        auto transform = GLTransform();
+        transform.translate(offset);
+        *_internal->model_transform = transform.combine_with(*_internal->model_transform);
+    }
+
+    void Shape::scale(float x_scale, float y_scale, Vector2f origin)
+    {
+        if (detail::is_opengl_disabled())
+            return;
+
+        auto transform = GLTransform();
+        transform.translate(origin);
+        transform.scale(x_scale, y_scale);
+        transform.translate(-origin);
+        *_internal->model_transform = transform.combine_with(*_internal->model_transform);
+    }
+
+    void Shape::set_model_transform(GLTransform transform)
+    {
+        if (detail::is_opengl_disabled())
+            return;
+
+        *_internal->model_transform = transform;
+    }
+
+    GLTransform Shape::get_model_transform() const
+    {
+        if (detail::is_opengl_disabled())
+            return GLTransform();
+
+        return *_internal->model_transform;
+    }
+
+    void Shape::bake_transform()
+    {
+        if (detail::is_opengl_disabled())
+            return;
+
+        apply_transform(*_internal->model_transform);
+        _internal->model_transform->reset();
     }
 
     const TextureObject* Shape::get_texture() const
@@ -1383,6 +1656,13 @@ namespace mousetrap
         return out;
     }
 
+    Shape Shape::Quads(const std::vector<Vertex>& vertices)
+    {
+        auto out = Shape();
+        out.as_quads(vertices);
+        return out;
+    }
+
     Shape Shape::Outline(const Shape& shape)
     {
         auto out = Shape();
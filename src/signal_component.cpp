@@ -10,6 +10,7 @@ DEFINE_NEW_TYPE_TRIVIAL_INIT(HasSignal##CamelCase##Internal, has_signal_##snake_
 static void has_signal_##snake_case##_internal_finalize(GObject* object) \
 { \
     auto* self = MOUSETRAP_HAS_SIGNAL_##CAPS_CASE##_INTERNAL(object); \
+    self->function.reset(); \
     G_OBJECT_CLASS(has_signal_##snake_case##_internal_parent_class)->finalize(object); \
 } \
 \
@@ -0,0 +1,329 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/18/26
+//
+
+#include <mousetrap/gl_common.hpp>
+#if MOUSETRAP_ENABLE_OPENGL_COMPONENT
+
+#include <mousetrap/text_shape.hpp>
+#include <mousetrap/log.hpp>
+
+namespace mousetrap
+{
+    namespace detail
+    {
+        DECLARE_NEW_TYPE(TextShapeInternal, text_shape_internal, TEXT_SHAPE_INTERNAL)
+
+        static void text_shape_internal_finalize(GObject* object)
+        {
+            auto* self = MOUSETRAP_TEXT_SHAPE_INTERNAL(object);
+            G_OBJECT_CLASS(text_shape_internal_parent_class)->finalize(object);
+
+            if (detail::is_opengl_disabled())
+                return;
+
+            delete self->shape;
+            delete self->vertices;
+            delete self->labels;
+            delete self->quads;
+            g_object_unref(self->atlas);
+        }
+
+        DEFINE_NEW_TYPE_TRIVIAL_INIT(TextShapeInternal, text_shape_internal, TEXT_SHAPE_INTERNAL)
+        DEFINE_NEW_TYPE_TRIVIAL_CLASS_INIT(TextShapeInternal, text_shape_internal, TEXT_SHAPE_INTERNAL)
+
+        static TextShapeInternal* text_shape_internal_new(GlyphAtlasInternal* atlas, Vector2f viewport_size)
+        {
+            auto* self = (TextShapeInternal*) g_object_new(text_shape_internal_get_type(), nullptr);
+            text_shape_internal_init(self);
+
+            self->atlas = g_object_ref(atlas);
+            self->shape = new Shape();
+            self->viewport_size = viewport_size;
+            self->vertices = new std::vector<Vertex>();
+            self->labels = new std::map<uint64_t, TextLabel>();
+            self->quads = new std::vector<GlyphQuad>();
+
+            self->shape->set_texture(atlas->texture);
+            return self;
+        }
+
+        static uint64_t text_shape_round_capacity(uint64_t n_quads)
+        {
+            // slack so small edits, like a changing counter, stay in place
+            return std::max<uint64_t>(8, ((n_quads + n_quads / 4) + 7) / 8 * 8);
+        }
+
+        // write self->quads, which holds the layout of label, into self->vertices starting at label.first_quad, padding up to label.capacity with degenerate quads
+        static void text_shape_write_label(TextShapeInternal* self, TextLabel& label)
+        {
+            label.n_quads = self->quads->size();
+            auto pixel_to_gl = Vector2f(2.f / self->viewport_size.x, -2.f / self->viewport_size.y);
+
+            auto* out = self->vertices->data() + label.first_quad * 4;
+            for (uint64_t i = 0; i < label.capacity; ++i)
+            {
+                auto* v = out + i * 4;
+                if (i >= label.n_quads)
+                {
+                    for (uint64_t j = 0; j < 4; ++j)
+                        v[j] = Vertex(0, 0, RGBA(0, 0, 0, 0));
+
+                    continue;
+                }
+
+                auto& quad = self->quads->at(i);
+                auto top_left = label.position + quad.top_left * pixel_to_gl;
+                auto bottom_right = label.position + (quad.top_left + quad.size) * pixel_to_gl;
+                auto uv_top_left = quad.texture_top_left;
+                auto uv_bottom_right = quad.texture_top_left + quad.texture_size;
+
+                v[0] = Vertex(top_left.x, top_left.y, label.color);
+                v[0].texture_coordinates = {uv_top_left.x, uv_top_left.y};
+
+                v[1] = Vertex(bottom_right.x, top_left.y, label.color);
+                v[1].texture_coordinates = {uv_bottom_right.x, uv_top_left.y};
+
+                v[2] = Vertex(bottom_right.x, bottom_right.y, label.color);
+                v[2].texture_coordinates = {uv_bottom_right.x, uv_bottom_right.y};
+
+                v[3] = Vertex(top_left.x, bottom_right.y, label.color);
+                v[3].texture_coordinates = {uv_top_left.x, uv_bottom_right.y};
+            }
+        }
+
+        // assign new, packed slots to all labels and re-upload the entire buffer
+        static void text_shape_rebuild(TextShapeInternal* self)
+        {
+            uint64_t n_quads = 0;
+            for (auto& pair : *self->labels)
+            {
+                auto& label = pair.second;
+                label.first_quad = n_quads;
+                label.capacity = text_shape_round_capacity(label.n_quads);
+                n_quads += label.capacity;
+            }
+
+            self->vertices->resize(n_quads * 4, Vertex(0, 0, RGBA(0, 0, 0, 0)));
+            for (auto& pair : *self->labels)
+            {
+                glyph_atlas_layout(self->atlas, pair.second.text, *self->quads);
+                text_shape_write_label(self, pair.second);
+            }
+
+            self->n_quads_used = n_quads;
+            self->n_quads_allocated = n_quads;
+            self->shape->as_quads(*self->vertices);
+        }
+
+        // upload the quads of one label, unused quads of the buffer stay degenerate
+        static void text_shape_upload_label(TextShapeInternal* self, const TextLabel& label)
+        {
+            auto first = self->vertices->begin() + label.first_quad * 4;
+            self->shape->set_vertices(label.first_quad * 4, std::vector<Vertex>(first, first + label.capacity * 4));
+        }
+
+        // re-layout one label, only uploads the labels range unless it outgrew its slot
+        static void text_shape_update_label(TextShapeInternal* self, TextLabel& label)
+        {
+            glyph_atlas_layout(self->atlas, label.text, *self->quads);
+            if (self->quads->size() > label.capacity)
+            {
+                label.n_quads = self->quads->size();
+                text_shape_rebuild(self);
+                return;
+            }
+
+            text_shape_write_label(self, label);
+            text_shape_upload_label(self, label);
+        }
+
+        // upload only the quads holding glyphs of one label, padding quads stay degenerate
+        static void text_shape_upload_glyphs(TextShapeInternal* self, const TextLabel& label)
+        {
+            if (label.n_quads == 0)
+                return;
+
+            auto first = self->vertices->begin() + label.first_quad * 4;
+            self->shape->set_vertices(label.first_quad * 4, std::vector<Vertex>(first, first + label.n_quads * 4));
+        }
+
+        static TextLabel* text_shape_get_label(TextShapeInternal* self, uint64_t id, const std::string& scope)
+        {
+            auto it = self->labels->find(id);
+            if (it == self->labels->end())
+            {
+                log::critical("In TextShape::" + scope + ": no label with id " + std::to_string(id), MOUSETRAP_DOMAIN);
+                return nullptr;
+            }
+
+            return &it->second;
+        }
+    }
+
+    TextShape::TextShape(GlyphAtlas& atlas, Vector2f viewport_size)
+    {
+        if (detail::is_opengl_disabled())
+        {
+            _internal = nullptr;
+            return;
+        }
+
+        _internal = detail::text_shape_internal_new((detail::GlyphAtlasInternal*) atlas.get_internal(), viewport_size);
+        g_object_ref(_internal);
+    }
+
+    TextShape::TextShape(detail::TextShapeInternal* internal)
+    {
+        if (detail::is_opengl_disabled())
+        {
+            _internal = nullptr;
+            return;
+        }
+
+        _internal = g_object_ref(internal);
+    }
+
+    TextShape::~TextShape()
+    {
+        if (not detail::is_opengl_disabled())
+            g_object_unref(_internal);
+    }
+
+    NativeObject TextShape::get_internal() const
+    {
+        if (detail::is_opengl_disabled())
+            return nullptr;
+
+        return G_OBJECT(_internal);
+    }
+
+    TextShape::operator NativeObject() const
+    {
+        return get_internal();
+    }
+
+    uint64_t TextShape::add_label(const std::string& text, Vector2f top_left, RGBA color)
+    {
+        if (detail::is_opengl_disabled())
+            return 0;
+
+        auto id = _internal->current_id++;
+        auto& label = _internal->labels->insert({id, detail::TextLabel{text, top_left, color}}).first->second;
+
+        // new labels are appended, existing labels keep their slots
+        detail::glyph_atlas_layout(_internal->atlas, text, *_internal->quads);
+        label.n_quads = _internal->quads->size();
+        label.first_quad = _internal->n_quads_used;
+        label.capacity = detail::text_shape_round_capacity(label.n_quads);
+
+        _internal->n_quads_used += label.capacity;
+
+        // the buffer is only reallocated once it is full, otherwise only the new label is uploaded
+        if (_internal->n_quads_used > _internal->n_quads_allocated)
+        {
+            _internal->n_quads_allocated = std::max(_internal->n_quads_used, 2 * _internal->n_quads_allocated);
+            _internal->vertices->resize(_internal->n_quads_allocated * 4, Vertex(0, 0, RGBA(0, 0, 0, 0)));
+
+            detail::text_shape_write_label(_internal, label);
+            _internal->shape->as_quads(*_internal->vertices);
+        }
+        else
+        {
+            detail::text_shape_write_label(_internal, label);
+            detail::text_shape_upload_label(_internal, label);
+        }
+
+        return id;
+    }
+
+    void TextShape::set_label_text(uint64_t id, const std::string& text)
+    {
+        if (detail::is_opengl_disabled())
+            return;
+
+        auto* label = detail::text_shape_get_label(_internal, id, "set_label_text");
+        if (label == nullptr or label->text == text)
+            return;
+
+        label->text = text;
+        detail::text_shape_update_label(_internal, *label);
+    }
+
+    void TextShape::set_label_position(uint64_t id, Vector2f top_left)
+    {
+        if (detail::is_opengl_disabled())
+            return;
+
+        auto* label = detail::text_shape_get_label(_internal, id, "set_label_position");
+        if (label == nullptr)
+            return;
+
+        // the layout does not depend on the position, so the existing quads are translated instead
+        auto offset = top_left - label->position;
+        label->position = top_left;
+
+        auto* v = _internal->vertices->data() + label->first_quad * 4;
+        for (uint64_t i = 0; i < label->n_quads * 4; ++i)
+        {
+            v[i].position.x += offset.x;
+            v[i].position.y += offset.y;
+        }
+
+        detail::text_shape_upload_glyphs(_internal, *label);
+    }
+
+    void TextShape::set_label_color(uint64_t id, RGBA color)
+    {
+        if (detail::is_opengl_disabled())
+            return;
+
+        auto* label = detail::text_shape_get_label(_internal, id, "set_label_color");
+        if (label == nullptr)
+            return;
+
+        label->color = color;
+
+        auto* v = _internal->vertices->data() + label->first_quad * 4;
+        for (uint64_t i = 0; i < label->n_quads * 4; ++i)
+            v[i].color = color;
+
+        detail::text_shape_upload_glyphs(_internal, *label);
+    }
+
+    void TextShape::remove_label(uint64_t id)
+    {
+        if (detail::is_opengl_disabled())
+            return;
+
+        if (detail::text_shape_get_label(_internal, id, "remove_label") == nullptr)
+            return;
+
+        _internal->labels->erase(id);
+        detail::text_shape_rebuild(_internal);
+    }
+
+    uint64_t TextShape::get_n_labels() const
+    {
+        if (detail::is_opengl_disabled())
+            return 0;
+
+        return _internal->labels->size();
+    }
+
+    void TextShape::set_viewport_size(Vector2f viewport_size)
+    {
+        if (detail::is_opengl_disabled())
+            return;
+
+        _internal->viewport_size = viewport_size;
+        detail::text_shape_rebuild(_internal);
+    }
+
+    const Shape& TextShape::get_shape() const
+    {
+        return *_internal->shape;
+    }
+}
+
+#endif // MOUSETRAP_ENABLE_OPENGL_COMPONENT
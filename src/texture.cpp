@@ -7,8 +7,11 @@
 #if MOUSETRAP_ENABLE_OPENGL_COMPONENT
 
 #include <iostream>
+#include <mutex>
 #include <mousetrap/texture.hpp>
 #include <mousetrap/render_area.hpp>
+#include <mousetrap/raw_image.hpp>
+#include <mousetrap/image_cache.hpp>
 
 namespace mousetrap
 {
@@ -48,9 +51,320 @@ namespace mousetrap
             self->wrap_mode = TextureWrapMode::REPEAT;
             self->scale_mode = TextureScaleMode::NEAREST;
             self->size = new Vector2i(0, 0);
+            self->n_levels = 1;
+            self->load_generation = 0;
 
             return self;
         }
+
+        /// @brief upload pixbuf into texture, the pixbufs rows are 4-byte aligned, which matches GL_UNPACK_ALIGNMENT
+        /// @brief set mipmap range and swizzle of the bound texture to match the storage it was just given. Called by every upload path, such that state of a previous, for example single-channel or mipmapped, upload does not carry over
+        static void texture_set_storage_parameters(GLenum transfer_format, uint64_t n_levels)
+        {
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, n_levels - 1);
+
+            // single-channel textures are sampled as grayscale, same as mousetrap::Image::get_pixel
+            GLint swizzle[4] = {GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA};
+            if (transfer_format == GL_RED)
+            {
+                swizzle[1] = GL_RED;
+                swizzle[2] = GL_RED;
+                swizzle[3] = GL_ONE;
+            }
+            glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+        }
+
+        static void texture_upload_pixbuf(GLNativeHandle handle, GdkPixbuf* pixbuf)
+        {
+            glActiveTexture(GL_TEXTURE0 + 0);
+            glBindTexture(GL_TEXTURE_2D, handle);
+
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            glTexImage2D(GL_TEXTURE_2D,
+                 0,
+                 GL_RGBA16F,
+                 gdk_pixbuf_get_width(pixbuf),
+                 gdk_pixbuf_get_height(pixbuf),
+                 0,
+                 gdk_pixbuf_get_has_alpha(pixbuf) ? GL_RGBA : GL_RGB,
+                 GL_UNSIGNED_BYTE,
+                 gdk_pixbuf_read_pixels(pixbuf)
+            );
+
+            texture_set_storage_parameters(gdk_pixbuf_get_has_alpha(pixbuf) ? GL_RGBA : GL_RGB, 1);
+            glBindTexture(GL_TEXTURE_2D, 0);
+        }
+
+        /// @brief get sized internal format, pixel transfer format and type matching the storage of an image. 8-bit RGBA is expanded into 16-bit floats, all other formats are uploaded as is
+        static void texture_get_transfer_format(ImageFormat format, uint64_t n_channels, GLenum& internal_format, GLenum& transfer_format, GLenum& type)
+        {
+            if (format == ImageFormat::RGBA32F)
+            {
+                internal_format = GL_RGBA32F;
+                transfer_format = GL_RGBA;
+                type = GL_FLOAT;
+            }
+            else if (format == ImageFormat::R8)
+            {
+                internal_format = GL_R8;
+                transfer_format = GL_RED;
+                type = GL_UNSIGNED_BYTE;
+            }
+            else if (format == ImageFormat::R32F)
+            {
+                internal_format = GL_R32F;
+                transfer_format = GL_RED;
+                type = GL_FLOAT;
+            }
+            else
+            {
+                internal_format = GL_RGBA16F;
+                transfer_format = n_channels == 4 ? GL_RGBA : GL_RGB;
+                type = GL_UNSIGNED_BYTE;
+            }
+        }
+
+        uint64_t texture_get_n_bytes(TextureInternal* internal)
+        {
+            glBindTexture(GL_TEXTURE_2D, internal->native_handle);
+
+            GLint internal_format = 0;
+            glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT, &internal_format);
+
+            uint64_t pixel_size;
+            if (internal_format == GL_RGBA32F)
+                pixel_size = 4 * sizeof(float);
+            else if (internal_format == GL_RGBA16F)
+                pixel_size = 4 * sizeof(uint16_t);
+            else if (internal_format == GL_R32F)
+                pixel_size = sizeof(float);
+            else if (internal_format == GL_R8)
+                pixel_size = 1;
+            else
+                pixel_size = 4;
+
+            uint64_t n_bytes = 0;
+            for (uint64_t level = 0; level < internal->n_levels; ++level)
+            {
+                GLint width = 0, height = 0;
+                glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_WIDTH, &width);
+                glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_HEIGHT, &height);
+                n_bytes += uint64_t(width) * uint64_t(height) * pixel_size;
+            }
+
+            glBindTexture(GL_TEXTURE_2D, 0);
+            return n_bytes;
+        }
+
+        /// @brief upload all levels of a raw file straight from the mapped file, does nothing if the file is not a raw file
+        /// @return true if the file was uploaded, false otherwise
+        static bool texture_upload_raw(TextureInternal* internal, const std::string& path)
+        {
+            if (not raw_image_has_magic(path))
+                return false;
+
+            auto raw = RawImageFile();
+            if (not raw_image_open(path, raw))
+            {
+                log::critical("In texture_upload_raw: file \"" + path + "\" is not a valid raw image, it is truncated or was written by a different version", MOUSETRAP_DOMAIN);
+                return false;
+            }
+
+            internal->load_generation += 1;
+            internal->n_levels = raw.header->n_levels;
+
+            const auto format = ImageFormat(raw.header->format);
+            GLenum internal_format, transfer_format, type;
+            texture_get_transfer_format(format, image_format_get_n_channels(format), internal_format, transfer_format, type);
+
+            glActiveTexture(GL_TEXTURE0 + 0);
+            glBindTexture(GL_TEXTURE_2D, internal->native_handle);
+
+            // rows are tightly packed, the driver reads the pages of the mapped file directly
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            for (uint64_t level = 0; level < internal->n_levels; ++level)
+            {
+                uint64_t width, height;
+                const auto* pixels = raw_image_get_level(raw, level, width, height);
+                glTexImage2D(GL_TEXTURE_2D, level, internal_format, width, height, 0, transfer_format, type, pixels);
+            }
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+            texture_set_storage_parameters(transfer_format, internal->n_levels);
+
+            *internal->size = {raw.header->width, raw.header->height};
+            glBindTexture(GL_TEXTURE_2D, 0);
+
+            raw_image_close(raw);
+            return true;
+        }
+
+        // secondary context sharing objects with GL_CONTEXT, only ever current on one worker thread at a time
+        static GdkGLContext* TEXTURE_UPLOAD_CONTEXT = nullptr;
+        static std::mutex TEXTURE_UPLOAD_CONTEXT_MUTEX;
+
+        static GdkGLContext* texture_get_upload_context()
+        {
+            static bool initialized = false;
+            if (initialized)
+                return TEXTURE_UPLOAD_CONTEXT;
+
+            initialized = true;
+
+            // headless contexts have no GdkGLContext to share with, uploads happen on the main thread instead
+            if (detail::GL_CONTEXT == nullptr)
+                return nullptr;
+
+            GError* error = nullptr;
+            auto* context = gdk_display_create_gl_context(gdk_gl_context_get_display(detail::GL_CONTEXT), &error);
+            if (error == nullptr)
+            {
+                gdk_gl_context_set_required_version(context, 3, 3);
+                gdk_gl_context_realize(context, &error);
+            }
+
+            if (error != nullptr)
+            {
+                log::warning(std::string("In texture_get_upload_context: Unable to create shared upload context, textures will be uploaded on the main thread: ") + error->message, MOUSETRAP_DOMAIN);
+                g_error_free(error);
+
+                if (context != nullptr)
+                    g_object_unref(context);
+
+                // gdk_gl_context_realize made the new context current
+                detail::make_opengl_context_current();
+                return nullptr;
+            }
+
+            detail::make_opengl_context_current();
+            TEXTURE_UPLOAD_CONTEXT = context;
+            return TEXTURE_UPLOAD_CONTEXT;
+        }
+
+        struct TextureLoadTask
+        {
+            std::string path;
+            std::function<void(Texture&, bool)> on_done;
+            uint64_t generation = 0;
+            GdkGLContext* upload_context = nullptr;
+
+            GdkPixbuf* pixbuf = nullptr;
+            std::string error_message;
+
+            GLNativeHandle handle = 0;
+            GLsync fence = nullptr;
+            Vector2i size = {0, 0};
+        };
+
+        static void texture_load_task_free(TextureLoadTask* self)
+        {
+            if (self->pixbuf != nullptr)
+                g_object_unref(self->pixbuf);
+
+            // still set if the texture did not take over the handle, because the load was superseded or the OpenGL component is disabled
+            if ((self->handle != 0 or self->fence != nullptr) and self->upload_context != nullptr)
+            {
+                auto lock = std::lock_guard(TEXTURE_UPLOAD_CONTEXT_MUTEX);
+                gdk_gl_context_make_current(self->upload_context);
+
+                if (self->fence != nullptr)
+                    glDeleteSync(self->fence);
+
+                if (self->handle != 0)
+                    glDeleteTextures(1, &self->handle);
+
+                gdk_gl_context_clear_current();
+                if (not detail::is_opengl_disabled())
+                    detail::make_opengl_context_current();
+            }
+
+            delete self;
+        }
+
+        static void texture_load_task_run(GTask* task, gpointer, TextureLoadTask* self, GCancellable*)
+        {
+            // shared with the cache, only ever read from
+            GError* error = nullptr;
+            self->pixbuf = image_cache_get_pixbuf(self->path, &error);
+
+            if (error != nullptr)
+            {
+                self->error_message = error->message;
+                g_error_free(error);
+                self->pixbuf = nullptr;
+            }
+
+            if (self->pixbuf != nullptr and self->upload_context != nullptr)
+            {
+                auto lock = std::lock_guard(TEXTURE_UPLOAD_CONTEXT_MUTEX);
+                gdk_gl_context_make_current(self->upload_context);
+
+                glGenTextures(1, &self->handle);
+                texture_upload_pixbuf(self->handle, self->pixbuf);
+                self->size = {gdk_pixbuf_get_width(self->pixbuf), gdk_pixbuf_get_height(self->pixbuf)};
+
+                // the main thread waits on this fence before the first use of the texture
+                self->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+                glFlush();
+
+                gdk_gl_context_clear_current();
+
+                g_object_unref(self->pixbuf);
+                self->pixbuf = nullptr;
+            }
+
+            g_task_return_boolean(task, self->handle != 0 or self->pixbuf != nullptr);
+        }
+
+        static void texture_load_task_finish(GObject* object, GAsyncResult* result, gpointer)
+        {
+            auto* internal = MOUSETRAP_TEXTURE_INTERNAL(object);
+            auto* self = (TextureLoadTask*) g_task_get_task_data(G_TASK(result));
+            bool success = g_task_propagate_boolean(G_TASK(result), nullptr);
+
+            // the handle is released by texture_load_task_free
+            if (detail::is_opengl_disabled())
+                return;
+
+            detail::make_opengl_context_current();
+
+            if (self->fence != nullptr)
+            {
+                // gpu-side wait, does not block the main thread
+                glWaitSync(self->fence, 0, GL_TIMEOUT_IGNORED);
+                glDeleteSync(self->fence);
+                self->fence = nullptr;
+            }
+
+            // the handle is released by texture_load_task_free
+            if (self->generation != internal->load_generation)
+                return;
+
+            if (self->handle != 0)
+            {
+                if (internal->native_handle != 0)
+                    glDeleteTextures(1, &internal->native_handle);
+
+                internal->native_handle = self->handle;
+                internal->handle_generation += 1;
+                *internal->size = self->size;
+                self->handle = 0;
+            }
+            else if (self->pixbuf != nullptr)
+            {
+                texture_upload_pixbuf(internal->native_handle, self->pixbuf);
+                *internal->size = {gdk_pixbuf_get_width(self->pixbuf), gdk_pixbuf_get_height(self->pixbuf)};
+            }
+            else
+                log::critical("In Texture::create_from_file_async: Unable to load file at `" + self->path + "`: " + self->error_message, MOUSETRAP_DOMAIN);
+
+            if (self->on_done)
+            {
+                auto texture = Texture(internal);
+                self->on_done(texture, success);
+            }
+        }
     }
     
     Texture::Texture()
@@ -121,6 +435,9 @@ namespace mousetrap
         if (detail::is_opengl_disabled())
             return;
 
+        _internal->load_generation += 1;
+        _internal->n_levels = 1;
+
         glActiveTexture(GL_TEXTURE0 + 0);
         glBindTexture(GL_TEXTURE_2D, _internal->native_handle);
 
@@ -136,6 +453,7 @@ namespace mousetrap
              nullptr
         );
 
+        detail::texture_set_storage_parameters(GL_RGBA, 1);
         *_internal->size = {width, height};
     }
 
@@ -144,11 +462,65 @@ namespace mousetrap
         if (detail::is_opengl_disabled())
             return false;
 
-        auto image = Image();
-        auto out = image.create_from_file(path);
+        if (detail::texture_upload_raw(_internal, path))
+            return true;
 
-        create_from_image(image);
-        return out;
+        // the cached pixbuf is uploaded as is, it is never modified so there is no need to copy it into an Image first
+        GError* error = nullptr;
+        auto* pixbuf = detail::image_cache_get_pixbuf(path, &error);
+        if (error != nullptr)
+        {
+            log::critical("In Texture::create_from_file: unable to open file \"" + path + "\": " + error->message, MOUSETRAP_DOMAIN);
+            g_error_free(error);
+            return false;
+        }
+
+        _internal->load_generation += 1;
+        _internal->n_levels = 1;
+        detail::texture_upload_pixbuf(_internal->native_handle, pixbuf);
+        *_internal->size = {gdk_pixbuf_get_width(pixbuf), gdk_pixbuf_get_height(pixbuf)};
+
+        g_object_unref(pixbuf);
+        return true;
+    }
+
+    void Texture::create_from_file_async_impl(const std::string& path, std::function<void(Texture&, bool)> on_done)
+    {
+        if (detail::is_opengl_disabled())
+            return;
+
+        // raw files are not decoded, so there is nothing to move off the main thread
+        if (detail::texture_upload_raw(_internal, path))
+        {
+            if (on_done)
+                on_done(*this, true);
+
+            return;
+        }
+
+        // placeholder until the upload finished
+        static const uint8_t transparent[4] = {0, 0, 0, 0};
+        _internal->load_generation += 1;
+        _internal->n_levels = 1;
+
+        glActiveTexture(GL_TEXTURE0 + 0);
+        glBindTexture(GL_TEXTURE_2D, _internal->native_handle);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, transparent);
+        detail::texture_set_storage_parameters(GL_RGBA, 1);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        *_internal->size = {1, 1};
+
+        auto* task_data = new detail::TextureLoadTask();
+        task_data->path = path;
+        task_data->on_done = std::move(on_done);
+        task_data->generation = _internal->load_generation;
+        task_data->upload_context = detail::texture_get_upload_context();
+
+        // GTask keeps a reference to the internal until texture_load_task_finish ran
+        auto* task = g_task_new(G_OBJECT(_internal), nullptr, (GAsyncReadyCallback) detail::texture_load_task_finish, nullptr);
+        g_task_set_task_data(task, task_data, (GDestroyNotify) detail::texture_load_task_free);
+        g_task_run_in_thread(task, (GTaskThreadFunc) detail::texture_load_task_run);
+        g_object_unref(task);
     }
 
     Texture::Texture(Texture&& other) noexcept
@@ -165,6 +537,9 @@ namespace mousetrap
 
         other._internal->native_handle = 0;
         *other._internal->size = {0, 0};
+
+        _internal->handle_generation += 1;
+        other._internal->handle_generation += 1;
     }
 
     Texture& Texture::operator=(Texture&& other) noexcept
@@ -182,6 +557,9 @@ namespace mousetrap
         other._internal->native_handle = 0;
         *other._internal->size = {0, 0};
 
+        _internal->handle_generation += 1;
+        other._internal->handle_generation += 1;
+
         return *this;
     }
 
@@ -193,26 +571,72 @@ namespace mousetrap
         glActiveTexture(GL_TEXTURE0 + 0);
         glBindTexture(GL_TEXTURE_2D, _internal->native_handle);
 
+        _internal->load_generation += 1;
+        _internal->n_levels = 1;
+
         if (image.get_size().x == 0 or image.get_size().y == 0)
             log::critical(MOUSETRAP_DOMAIN, "In Texture::create_from_image: image has invalid size, make sure the image is initialized correctly before creating a texture");
 
-        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
-        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        GLenum internal_format, transfer_format, type;
+        detail::texture_get_transfer_format(image.get_format(), image.get_n_channels(), internal_format, transfer_format, type);
+
+        // pixbuf rows are 4-byte aligned, rows of all other formats are tightly packed
+        glPixelStorei(GL_UNPACK_ALIGNMENT, image.get_format() == ImageFormat::RGBA8 ? 4 : 1);
 
         glTexImage2D(GL_TEXTURE_2D,
              0,
-             GL_RGBA16F,
+             internal_format,
              image.get_size().x,
-            image.get_size().y,
+             image.get_size().y,
              0,
-             gdk_pixbuf_get_has_alpha(image.operator GdkPixbuf *()) ? GL_RGBA : GL_RGB,
-             GL_UNSIGNED_BYTE,
+             transfer_format,
+             type,
              image.data()
         );
 
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        detail::texture_set_storage_parameters(transfer_format, 1);
+
         *_internal->size = image.get_size();
     }
 
+    void Texture::set_region(uint64_t x, uint64_t y, const Image& image)
+    {
+        if (detail::is_opengl_disabled())
+            return;
+
+        auto size = image.get_size();
+        if (size.x == 0 or size.y == 0)
+            return;
+
+        if (x + size.x > uint64_t(_internal->size->x) or y + size.y > uint64_t(_internal->size->y))
+        {
+            log::critical("In Texture::set_region: region is out of bounds for a texture of size " + std::to_string(_internal->size->x) + "x" + std::to_string(_internal->size->y), MOUSETRAP_DOMAIN);
+            return;
+        }
+
+        glActiveTexture(GL_TEXTURE0 + 0);
+        glBindTexture(GL_TEXTURE_2D, _internal->native_handle);
+
+        GLenum internal_format, transfer_format, type;
+        detail::texture_get_transfer_format(image.get_format(), image.get_n_channels(), internal_format, transfer_format, type);
+
+        // row length is in pixels, so it can only express the rowstride if it is a multiple of the pixel size
+        auto pixel_size = image.get_n_channels() * detail::image_format_get_value_size(image.get_format());
+        auto rowstride = image.get_rowstride();
+        bool use_row_length = rowstride % pixel_size == 0;
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, use_row_length ? 1 : 4);
+        if (use_row_length)
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, rowstride / pixel_size);
+
+        glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, size.x, size.y, transfer_format, type, image.data());
+
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
     void Texture::bind(uint64_t texture_unit) const
     {
         if (detail::is_opengl_disabled())
@@ -241,7 +665,11 @@ namespace mousetrap
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, (GLint) _internal->wrap_mode);
         }
 
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, (GLint) _internal->scale_mode);
+        GLint min_filter = (GLint) _internal->scale_mode;
+        if (_internal->n_levels > 1)
+            min_filter = _internal->scale_mode == TextureScaleMode::LINEAR ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_NEAREST;
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, min_filter);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, (GLint) _internal->scale_mode);
     }
 
@@ -324,6 +752,29 @@ namespace mousetrap
         return out;
     }
 
+    Image Texture::download(ImageFormat format) const
+    {
+        if (detail::is_opengl_disabled())
+            return Image();
+
+        if (format == ImageFormat::RGBA8)
+            return download();
+
+        auto out = Image();
+        out.create(_internal->size->x, _internal->size->y, format);
+
+        GLenum internal_format, transfer_format, type;
+        detail::texture_get_transfer_format(format, out.get_n_channels(), internal_format, transfer_format, type);
+
+        glBindTexture(GL_TEXTURE_2D, _internal->native_handle);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glGetTexImage(GL_TEXTURE_2D, 0, transfer_format, type, out.data());
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        return out;
+    }
+
     Texture::operator GObject*() const
     {
         if (detail::is_opengl_disabled())
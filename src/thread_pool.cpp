@@ -0,0 +1,219 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/18/26
+//
+
+#include <mousetrap/thread_pool.hpp>
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <algorithm>
+#include <memory>
+
+namespace mousetrap
+{
+    namespace detail
+    {
+        struct ThreadPoolChunk
+        {
+            uint64_t begin;
+            uint64_t end;
+        };
+
+        struct ThreadPoolQueue
+        {
+            std::mutex mutex;
+            std::deque<ThreadPoolChunk> chunks;
+        };
+
+        struct ThreadPool
+        {
+            uint64_t n_threads;
+
+            // queues.at(0) belongs to the calling thread, queues.at(i) to worker i
+            std::vector<ThreadPoolQueue*> queues;
+            std::vector<std::thread> workers;
+
+            // serializes parallel_for, callers that fail to acquire it run sequentially instead
+            std::mutex job_mutex;
+
+            std::mutex wake_mutex;
+            std::condition_variable wake;
+            uint64_t generation = 0;
+            bool shutdown = false;
+
+            std::mutex done_mutex;
+            std::condition_variable done;
+            std::atomic<uint64_t> n_remaining{0};
+
+            const std::function<void(uint64_t, uint64_t)>* f = nullptr;
+
+            ~ThreadPool()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(wake_mutex);
+                    shutdown = true;
+                }
+                wake.notify_all();
+
+                for (auto& worker : workers)
+                    worker.join();
+
+                for (auto* queue : queues)
+                    delete queue;
+            }
+        };
+
+        static thread_local bool IS_POOL_WORKER = false;
+
+        static bool thread_pool_pop(ThreadPool* self, uint64_t thread_i, ThreadPoolChunk& out)
+        {
+            // own queue from the back, most recently pushed chunks are likely still in cache
+            {
+                auto* queue = self->queues.at(thread_i);
+                std::lock_guard<std::mutex> lock(queue->mutex);
+                if (not queue->chunks.empty())
+                {
+                    out = queue->chunks.back();
+                    queue->chunks.pop_back();
+                    return true;
+                }
+            }
+
+            // steal from the front of other queues
+            for (uint64_t offset = 1; offset < self->n_threads; ++offset)
+            {
+                auto* queue = self->queues.at((thread_i + offset) % self->n_threads);
+                std::lock_guard<std::mutex> lock(queue->mutex);
+                if (not queue->chunks.empty())
+                {
+                    out = queue->chunks.front();
+                    queue->chunks.pop_front();
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        static void thread_pool_work(ThreadPool* self, uint64_t thread_i)
+        {
+            ThreadPoolChunk chunk;
+            while (thread_pool_pop(self, thread_i, chunk))
+            {
+                for (uint64_t i = chunk.begin; i < chunk.end; ++i)
+                    (*self->f)(i, thread_i);
+
+                if (self->n_remaining.fetch_sub(1) == 1)
+                {
+                    std::lock_guard<std::mutex> lock(self->done_mutex);
+                    self->done.notify_all();
+                }
+            }
+        }
+
+        static void thread_pool_worker_main(ThreadPool* self, uint64_t thread_i)
+        {
+            IS_POOL_WORKER = true;
+            uint64_t seen_generation = 0;
+
+            while (true)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(self->wake_mutex);
+                    self->wake.wait(lock, [&](){
+                        return self->shutdown or self->generation != seen_generation;
+                    });
+
+                    if (self->shutdown)
+                        return;
+
+                    seen_generation = self->generation;
+                }
+
+                thread_pool_work(self, thread_i);
+            }
+        }
+
+        ThreadPool* thread_pool_get_default()
+        {
+            static auto* pool = [](){
+                auto* out = new ThreadPool();
+                out->n_threads = std::max<uint64_t>(1, std::thread::hardware_concurrency());
+
+                for (uint64_t i = 0; i < out->n_threads; ++i)
+                    out->queues.push_back(new ThreadPoolQueue());
+
+                for (uint64_t i = 1; i < out->n_threads; ++i)
+                    out->workers.emplace_back(thread_pool_worker_main, out, i);
+
+                return out;
+            }();
+
+            // joined at exit, so workers never outlive the pool
+            static auto guard = std::unique_ptr<ThreadPool>(pool);
+            return pool;
+        }
+
+        uint64_t thread_pool_get_n_threads(ThreadPool* self)
+        {
+            return self->n_threads;
+        }
+
+        void thread_pool_parallel_for(ThreadPool* self, uint64_t n, const std::function<void(uint64_t, uint64_t)>& f, uint64_t grain)
+        {
+            if (n == 0)
+                return;
+
+            grain = std::max<uint64_t>(grain, 1);
+
+            auto run_sequential = [&](){
+                for (uint64_t i = 0; i < n; ++i)
+                    f(i, 0);
+            };
+
+            if (self->n_threads == 1 or n <= grain or IS_POOL_WORKER)
+            {
+                run_sequential();
+                return;
+            }
+
+            std::unique_lock<std::mutex> job_lock(self->job_mutex, std::try_to_lock);
+            if (not job_lock.owns_lock())
+            {
+                run_sequential();
+                return;
+            }
+
+            // distribute chunks round-robin, threads that finish early steal the remainder
+            uint64_t n_chunks = (n + grain - 1) / grain;
+            self->f = &f;
+            self->n_remaining = n_chunks;
+
+            for (uint64_t chunk_i = 0; chunk_i < n_chunks; ++chunk_i)
+            {
+                auto* queue = self->queues.at(chunk_i % self->n_threads);
+                std::lock_guard<std::mutex> lock(queue->mutex);
+                queue->chunks.push_back({chunk_i * grain, std::min(n, (chunk_i + 1) * grain)});
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(self->wake_mutex);
+                self->generation += 1;
+            }
+            self->wake.notify_all();
+
+            thread_pool_work(self, 0);
+
+            std::unique_lock<std::mutex> lock(self->done_mutex);
+            self->done.wait(lock, [&](){
+                return self->n_remaining.load() == 0;
+            });
+
+            self->f = nullptr;
+        }
+    }
+}
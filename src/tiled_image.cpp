@@ -0,0 +1,448 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/18/26
+//
+
+#include <mousetrap/tiled_image.hpp>
+#include <mousetrap/thread_pool.hpp>
+#include <mousetrap/log.hpp>
+
+#include <mutex>
+#include <memory>
+#include <algorithm>
+#include <vector>
+
+namespace mousetrap
+{
+    namespace detail
+    {
+        DECLARE_NEW_TYPE(TiledImageInternal, tiled_image_internal, TILED_IMAGE_INTERNAL)
+
+        static void tiled_image_internal_finalize(GObject* object)
+        {
+            auto* self = MOUSETRAP_TILED_IMAGE_INTERNAL(object);
+            G_OBJECT_CLASS(tiled_image_internal_parent_class)->finalize(object);
+
+            delete self->decode;
+            delete self->tiles;
+            delete self->lru;
+            delete self->queue;
+            delete self->queued;
+            delete self->in_flight;
+            delete self->listeners;
+        }
+
+        DEFINE_NEW_TYPE_TRIVIAL_INIT(TiledImageInternal, tiled_image_internal, TILED_IMAGE_INTERNAL)
+        DEFINE_NEW_TYPE_TRIVIAL_CLASS_INIT(TiledImageInternal, tiled_image_internal, TILED_IMAGE_INTERNAL)
+
+        static TiledImageInternal* tiled_image_internal_new()
+        {
+            auto* self = (TiledImageInternal*) g_object_new(tiled_image_internal_get_type(), nullptr);
+            tiled_image_internal_init(self);
+
+            self->width = 0;
+            self->height = 0;
+            self->n_levels = 0;
+            self->decode = new std::function<bool(uint64_t, uint64_t, uint64_t, Image&)>();
+            self->tiles = new std::unordered_map<uint64_t, TiledImageTile>();
+            self->lru = new std::list<uint64_t>();
+            self->memory_budget = uint64_t(256) << 20;
+            self->memory_usage = 0;
+            self->queue = new std::deque<uint64_t>();
+            self->queued = new std::unordered_set<uint64_t>();
+            self->in_flight = new std::unordered_set<uint64_t>();
+            self->max_n_in_flight = thread_pool_get_n_threads(thread_pool_get_default());
+            self->generation = 0;
+            self->listeners = new std::unordered_map<void*, std::function<void(uint64_t, uint64_t, uint64_t)>>();
+            return self;
+        }
+
+        uint64_t tiled_image_key(uint64_t level, uint64_t x, uint64_t y)
+        {
+            // 24 bits per tile coordinate are enough for 2^32 pixels along each axis
+            return (level << 48) | (y << 24) | x;
+        }
+
+        void tiled_image_unpack_key(uint64_t key, uint64_t& level, uint64_t& x, uint64_t& y)
+        {
+            constexpr uint64_t mask = (uint64_t(1) << 24) - 1;
+            level = key >> 48;
+            y = (key >> 24) & mask;
+            x = key & mask;
+        }
+
+        void tiled_image_add_listener(TiledImageInternal* self, void* owner, std::function<void(uint64_t, uint64_t, uint64_t)> f)
+        {
+            self->listeners->insert_or_assign(owner, std::move(f));
+        }
+
+        void tiled_image_remove_listener(TiledImageInternal* self, void* owner)
+        {
+            self->listeners->erase(owner);
+        }
+
+        static void tiled_image_evict(TiledImageInternal* self)
+        {
+            // the most recently used tile is always kept, even if it alone exceeds the budget
+            while (self->memory_usage > self->memory_budget and self->lru->size() > 1)
+            {
+                auto key = self->lru->back();
+                self->lru->pop_back();
+
+                auto it = self->tiles->find(key);
+                self->memory_usage -= it->second.n_bytes;
+                self->tiles->erase(it);
+            }
+        }
+
+        struct TiledImageDecodeTask
+        {
+            uint64_t key;
+            uint64_t generation;
+
+            // copied, such that a call to create while the task runs does not invalidate it
+            std::function<bool(uint64_t, uint64_t, uint64_t, Image&)> decode;
+            Image result;
+        };
+
+        static void tiled_image_decode_task_free(TiledImageDecodeTask* self)
+        {
+            delete self;
+        }
+
+        static void tiled_image_decode_task_run(GTask* task, gpointer, TiledImageDecodeTask* self, GCancellable*)
+        {
+            uint64_t level, x, y;
+            tiled_image_unpack_key(self->key, level, x, y);
+            bool success = self->decode(level, x, y, self->result);
+            g_task_return_boolean(task, success and self->result.get_size().x > 0 and self->result.get_size().y > 0);
+        }
+
+        static void tiled_image_start_decodes(TiledImageInternal* self);
+
+        static void tiled_image_decode_task_finish(GObject* object, GAsyncResult* result, gpointer)
+        {
+            auto* self = MOUSETRAP_TILED_IMAGE_INTERNAL(object);
+            auto* task = (TiledImageDecodeTask*) g_task_get_task_data(G_TASK(result));
+            bool success = g_task_propagate_boolean(G_TASK(result), nullptr);
+
+            self->in_flight->erase(task->key);
+
+            if (task->generation != self->generation)
+            {
+                tiled_image_start_decodes(self);
+                return;
+            }
+
+            if (success and self->tiles->find(task->key) == self->tiles->end())
+            {
+                uint64_t n_bytes = task->result.get_data_size();
+                self->lru->push_front(task->key);
+                self->tiles->emplace(task->key, TiledImageTile{std::move(task->result), n_bytes, self->lru->begin()});
+                self->memory_usage += n_bytes;
+                tiled_image_evict(self);
+
+                uint64_t level, x, y;
+                tiled_image_unpack_key(task->key, level, x, y);
+
+                // copy, listeners may unregister themselves while being invoked
+                auto listeners = *self->listeners;
+                for (auto& pair : listeners)
+                    pair.second(level, x, y);
+            }
+            else if (not success)
+            {
+                uint64_t level, x, y;
+                tiled_image_unpack_key(task->key, level, x, y);
+                log::critical("In TiledImage: unable to decode tile " + std::to_string(x) + " " + std::to_string(y) + " of level " + std::to_string(level), MOUSETRAP_DOMAIN);
+            }
+
+            tiled_image_start_decodes(self);
+        }
+
+        static void tiled_image_start_decodes(TiledImageInternal* self)
+        {
+            while (self->in_flight->size() < self->max_n_in_flight and not self->queue->empty())
+            {
+                // most recent request first
+                auto key = self->queue->back();
+                self->queue->pop_back();
+                self->queued->erase(key);
+
+                if (self->tiles->find(key) != self->tiles->end() or self->in_flight->find(key) != self->in_flight->end())
+                    continue;
+
+                self->in_flight->insert(key);
+
+                auto* task_data = new TiledImageDecodeTask();
+                task_data->key = key;
+                task_data->generation = self->generation;
+                task_data->decode = *self->decode;
+
+                // GTask keeps a reference to the internal until tiled_image_decode_task_finish ran
+                auto* task = g_task_new(G_OBJECT(self), nullptr, (GAsyncReadyCallback) tiled_image_decode_task_finish, nullptr);
+                g_task_set_task_data(task, task_data, (GDestroyNotify) tiled_image_decode_task_free);
+                g_task_run_in_thread(task, (GTaskThreadFunc) tiled_image_decode_task_run);
+                g_object_unref(task);
+            }
+        }
+    }
+
+    TiledImage::TiledImage()
+    {
+        _internal = detail::tiled_image_internal_new();
+        g_object_ref(_internal);
+    }
+
+    TiledImage::TiledImage(detail::TiledImageInternal* internal)
+    {
+        _internal = g_object_ref(internal);
+    }
+
+    TiledImage::~TiledImage()
+    {
+        g_object_unref(_internal);
+    }
+
+    NativeObject TiledImage::get_internal() const
+    {
+        return G_OBJECT(_internal);
+    }
+
+    TiledImage::operator GObject*() const
+    {
+        return G_OBJECT(_internal);
+    }
+
+    void TiledImage::create_impl(uint64_t width, uint64_t height, std::function<bool(uint64_t, uint64_t, uint64_t, Image&)> f)
+    {
+        _internal->generation += 1;
+        _internal->width = width;
+        _internal->height = height;
+
+        // halve until the longer side fits into a single tile
+        uint64_t longest = std::max(width, height);
+        _internal->n_levels = 1;
+        while (((longest + (uint64_t(1) << (_internal->n_levels - 1)) - 1) >> (_internal->n_levels - 1)) > tile_size)
+            _internal->n_levels += 1;
+
+        *_internal->decode = std::move(f);
+        _internal->tiles->clear();
+        _internal->lru->clear();
+        _internal->memory_usage = 0;
+        _internal->queue->clear();
+        _internal->queued->clear();
+
+        // decodes of the previous generation still count towards the limit until they finished
+    }
+
+    bool TiledImage::create_from_file(const std::string& path)
+    {
+        int width = 0;
+        int height = 0;
+        if (gdk_pixbuf_get_file_info(path.c_str(), &width, &height) == nullptr)
+        {
+            log::critical("In TiledImage::create_from_file: unable to open file \"" + path + "\"", MOUSETRAP_DOMAIN);
+            return false;
+        }
+
+        // GdkPixbuf cannot decode parts of a file, so every level has to fit into memory as a whole
+        uint64_t n_bytes = 0;
+        uint64_t n_levels = 0;
+        for (uint64_t level_width = width, level_height = height;; ++n_levels)
+        {
+            n_bytes += level_width * level_height * 4;
+            if (std::max(level_width, level_height) <= tile_size)
+            {
+                n_levels += 1;
+                break;
+            }
+
+            level_width = std::max<uint64_t>(1, (level_width + 1) / 2);
+            level_height = std::max<uint64_t>(1, (level_height + 1) / 2);
+        }
+
+        if (n_bytes > _internal->memory_budget)
+        {
+            log::critical("In TiledImage::create_from_file: decoding file \"" + path + "\" of size " + std::to_string(width) + "x" + std::to_string(height) + " requires " + std::to_string(n_bytes) + " bytes, which exceeds the memory budget of " + std::to_string(_internal->memory_budget) + " bytes", MOUSETRAP_DOMAIN);
+            return false;
+        }
+
+        // decoded levels, shared between worker threads. Each level is decoded at most once, by whichever worker requests it first, and kept until the decoder is replaced
+        struct LevelCache
+        {
+            LevelCache(uint64_t n)
+                : once(new std::once_flag[n]), levels(n)
+            {}
+
+            std::unique_ptr<std::once_flag[]> once;
+            std::vector<std::unique_ptr<Image>> levels;
+        };
+
+        auto cache = std::make_shared<LevelCache>(n_levels);
+
+        create_impl(width, height, [cache, path, n_levels, width = uint64_t(width), height = uint64_t(height)](uint64_t level, uint64_t tile_x, uint64_t tile_y, Image& out) -> bool {
+
+            if (level >= n_levels)
+                return false;
+
+            // other workers requesting the same level block until it is decoded
+            std::call_once(cache->once[level], [&]() {
+                uint64_t level_width = std::max<uint64_t>(1, (width + (uint64_t(1) << level) - 1) >> level);
+                uint64_t level_height = std::max<uint64_t>(1, (height + (uint64_t(1) << level) - 1) >> level);
+
+                GError* error = nullptr;
+                auto* pixbuf = gdk_pixbuf_new_from_file_at_scale(path.c_str(), level_width, level_height, FALSE, &error);
+                if (error != nullptr)
+                {
+                    g_error_free(error);
+                    return;
+                }
+
+                cache->levels.at(level) = std::make_unique<Image>(detail::image_new_from_pixbuf(pixbuf));
+                g_object_unref(pixbuf);
+            });
+
+            // written exactly once inside call_once, which synchronizes with all callers
+            auto* decoded = cache->levels.at(level).get();
+            if (decoded == nullptr)
+                return false;
+
+            out = decoded->as_cropped(-int(tile_x * tile_size), -int(tile_y * tile_size),
+                std::min<uint64_t>(tile_size, decoded->get_size().x - tile_x * tile_size),
+                std::min<uint64_t>(tile_size, decoded->get_size().y - tile_y * tile_size)
+            );
+            return true;
+        });
+
+        return true;
+    }
+
+    void TiledImage::create_from_image(const Image& image)
+    {
+        auto size = image.get_size();
+
+        // precompute all levels by repeatedly halving, each level is filtered from the previous one
+        auto levels = std::make_shared<std::vector<Image>>();
+        levels->push_back(image);
+        while (std::max(levels->back().get_size().x, levels->back().get_size().y) > int(tile_size))
+        {
+            auto& previous = levels->back();
+            auto next = previous.as_scaled(
+                std::max<uint64_t>(1, (previous.get_size().x + 1) / 2),
+                std::max<uint64_t>(1, (previous.get_size().y + 1) / 2),
+                InterpolationType::BOX
+            );
+            levels->push_back(std::move(next));
+        }
+
+        create_impl(size.x, size.y, [levels](uint64_t level, uint64_t tile_x, uint64_t tile_y, Image& out) -> bool {
+            if (level >= levels->size())
+                return false;
+
+            auto& source = levels->at(level);
+            out = source.as_cropped(-int(tile_x * tile_size), -int(tile_y * tile_size),
+                std::min<uint64_t>(tile_size, source.get_size().x - tile_x * tile_size),
+                std::min<uint64_t>(tile_size, source.get_size().y - tile_y * tile_size)
+            );
+            return true;
+        });
+    }
+
+    uint64_t TiledImage::get_n_levels() const
+    {
+        return _internal->n_levels;
+    }
+
+    Vector2ui TiledImage::get_size(uint64_t level) const
+    {
+        if (level >= _internal->n_levels)
+        {
+            log::critical("In TiledImage::get_size: level " + std::to_string(level) + " is out of range for an image with " + std::to_string(_internal->n_levels) + " levels", MOUSETRAP_DOMAIN);
+            return {0, 0};
+        }
+
+        return {
+            std::max<uint64_t>(1, (_internal->width + (uint64_t(1) << level) - 1) >> level),
+            std::max<uint64_t>(1, (_internal->height + (uint64_t(1) << level) - 1) >> level)
+        };
+    }
+
+    Vector2ui TiledImage::get_n_tiles(uint64_t level) const
+    {
+        auto size = get_size(level);
+        return {
+            (size.x + tile_size - 1) / tile_size,
+            (size.y + tile_size - 1) / tile_size
+        };
+    }
+
+    Rectangle TiledImage::get_tile_region(uint64_t level, uint64_t tile_x, uint64_t tile_y) const
+    {
+        auto size = get_size(level);
+        float x = tile_x * tile_size;
+        float y = tile_y * tile_size;
+        return Rectangle{
+            {x, y},
+            {std::min<float>(tile_size, size.x - x), std::min<float>(tile_size, size.y - y)}
+        };
+    }
+
+    const Image* TiledImage::get_tile(uint64_t level, uint64_t tile_x, uint64_t tile_y)
+    {
+        auto it = _internal->tiles->find(detail::tiled_image_key(level, tile_x, tile_y));
+        if (it == _internal->tiles->end())
+            return nullptr;
+
+        _internal->lru->splice(_internal->lru->begin(), *_internal->lru, it->second.lru_position);
+        return &it->second.image;
+    }
+
+    void TiledImage::request_tile(uint64_t level, uint64_t tile_x, uint64_t tile_y)
+    {
+        if (level >= _internal->n_levels)
+            return;
+
+        auto n_tiles = get_n_tiles(level);
+        if (tile_x >= n_tiles.x or tile_y >= n_tiles.y)
+            return;
+
+        auto key = detail::tiled_image_key(level, tile_x, tile_y);
+        if (_internal->tiles->find(key) != _internal->tiles->end() or _internal->in_flight->find(key) != _internal->in_flight->end())
+            return;
+
+        if (_internal->queued->find(key) != _internal->queued->end())
+        {
+            // move to the back, such that it is served next
+            auto it = std::find(_internal->queue->begin(), _internal->queue->end(), key);
+            if (it != _internal->queue->end())
+                _internal->queue->erase(it);
+        }
+        else
+            _internal->queued->insert(key);
+
+        _internal->queue->push_back(key);
+        detail::tiled_image_start_decodes(_internal);
+    }
+
+    void TiledImage::clear_requests()
+    {
+        _internal->queue->clear();
+        _internal->queued->clear();
+    }
+
+    void TiledImage::set_memory_budget(uint64_t n_bytes)
+    {
+        _internal->memory_budget = n_bytes;
+        detail::tiled_image_evict(_internal);
+    }
+
+    uint64_t TiledImage::get_memory_budget() const
+    {
+        return _internal->memory_budget;
+    }
+
+    uint64_t TiledImage::get_memory_usage() const
+    {
+        return _internal->memory_usage;
+    }
+}
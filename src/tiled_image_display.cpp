@@ -0,0 +1,494 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/18/26
+//
+
+#include <mousetrap/gl_common.hpp>
+#if MOUSETRAP_ENABLE_OPENGL_COMPONENT
+
+#include <mousetrap/tiled_image_display.hpp>
+#include <mousetrap/log.hpp>
+
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+namespace mousetrap
+{
+    namespace detail
+    {
+        // the atlas grows up to 16x16 tiles of 256x256 pixels
+        static constexpr uint64_t tiled_image_display_atlas_max_n_slots_per_row = 16;
+        static constexpr uint64_t tiled_image_display_no_key = std::numeric_limits<uint64_t>::max();
+
+        // uploads are spread across frames, such that a view jump does not stall a single frame
+        static constexpr uint64_t tiled_image_display_max_n_uploads_per_update = 16;
+
+        DECLARE_NEW_TYPE(TiledImageDisplayInternal, tiled_image_display_internal, TILED_IMAGE_DISPLAY_INTERNAL)
+
+        static void tiled_image_display_internal_finalize(GObject* object)
+        {
+            auto* self = MOUSETRAP_TILED_IMAGE_DISPLAY_INTERNAL(object);
+            G_OBJECT_CLASS(tiled_image_display_internal_parent_class)->finalize(object);
+
+            if (self->image != nullptr)
+            {
+                tiled_image_remove_listener(self->image, self);
+                g_object_unref(self->image);
+            }
+
+            delete self->slot_keys;
+            delete self->slot_last_used;
+            delete self->key_to_slot;
+
+            if (detail::is_opengl_disabled())
+                return;
+
+            detail::make_opengl_context_current();
+            delete self->task;
+            delete self->shape;
+            delete self->atlas;
+        }
+
+        DEFINE_NEW_TYPE_TRIVIAL_INIT(TiledImageDisplayInternal, tiled_image_display_internal, TILED_IMAGE_DISPLAY_INTERNAL)
+        DEFINE_NEW_TYPE_TRIVIAL_CLASS_INIT(TiledImageDisplayInternal, tiled_image_display_internal, TILED_IMAGE_DISPLAY_INTERNAL)
+
+        static TiledImageDisplayInternal* tiled_image_display_internal_new(GtkGLArea* native)
+        {
+            auto* self = (TiledImageDisplayInternal*) g_object_new(tiled_image_display_internal_get_type(), nullptr);
+            tiled_image_display_internal_init(self);
+
+            self->native = native;
+            self->image = nullptr;
+            self->image_generation = 0;
+
+            self->atlas = nullptr;
+            self->atlas_n_slots_per_row = 0;
+            self->slot_keys = new std::vector<uint64_t>();
+            self->slot_last_used = new std::vector<uint64_t>();
+            self->key_to_slot = new std::unordered_map<uint64_t, uint64_t>();
+            self->frame = 0;
+            self->pending_update = 0;
+
+            self->center = {0, 0};
+            self->zoom = 1;
+            self->drag_start_center = {0, 0};
+            self->cursor_position = {0, 0};
+
+            // the atlas is only allocated once tiles are about to be uploaded, see tiled_image_display_reserve_slots
+            self->shape = new Shape();
+            self->shape->as_quads({});
+            self->task = new RenderTask(*self->shape);
+
+            return self;
+        }
+
+        static void tiled_image_display_clear_slots(TiledImageDisplayInternal* self)
+        {
+            std::fill(self->slot_keys->begin(), self->slot_keys->end(), tiled_image_display_no_key);
+            std::fill(self->slot_last_used->begin(), self->slot_last_used->end(), 0);
+            self->key_to_slot->clear();
+        }
+
+        // grows the atlas such that it holds at least n_slots tiles, which drops all resident tiles. Returns false if it cannot grow any further
+        static bool tiled_image_display_reserve_slots(TiledImageDisplayInternal* self, uint64_t n_slots)
+        {
+            if (self->slot_keys->size() >= n_slots)
+                return true;
+
+            GLint max_texture_size = 0;
+            glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_texture_size);
+            uint64_t max_n_slots_per_row = std::clamp<uint64_t>(max_texture_size / TiledImage::tile_size, 1, tiled_image_display_atlas_max_n_slots_per_row);
+
+            uint64_t n_slots_per_row = std::max<uint64_t>(self->atlas_n_slots_per_row, 1);
+            while (n_slots_per_row * n_slots_per_row < n_slots and n_slots_per_row < max_n_slots_per_row)
+                n_slots_per_row *= 2;
+
+            n_slots_per_row = std::min(n_slots_per_row, max_n_slots_per_row);
+            if (n_slots_per_row == self->atlas_n_slots_per_row)
+                return false;
+
+            // allocated as 8-bit, a 16-bit float atlas would occupy twice the memory for no gain in precision
+            uint64_t atlas_size = n_slots_per_row * TiledImage::tile_size;
+            GLNativeHandle handle = 0;
+            glGenTextures(1, &handle);
+            glBindTexture(GL_TEXTURE_2D, handle);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, atlas_size, atlas_size, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            glBindTexture(GL_TEXTURE_2D, 0);
+
+            delete self->atlas;
+            self->atlas = new Texture(handle);
+            self->atlas->set_scale_mode(TextureScaleMode::LINEAR);
+            self->atlas->set_wrap_mode(TextureWrapMode::STRETCH);
+            self->shape->set_texture(self->atlas);
+
+            self->atlas_n_slots_per_row = n_slots_per_row;
+            self->slot_keys->assign(n_slots_per_row * n_slots_per_row, tiled_image_display_no_key);
+            self->slot_last_used->assign(n_slots_per_row * n_slots_per_row, 0);
+            self->key_to_slot->clear();
+            return true;
+        }
+
+        static Vector2f tiled_image_display_slot_origin(TiledImageDisplayInternal* self, uint64_t slot)
+        {
+            return {
+                float((slot % self->atlas_n_slots_per_row) * TiledImage::tile_size),
+                float((slot / self->atlas_n_slots_per_row) * TiledImage::tile_size)
+            };
+        }
+
+        // returns slot of a tile, uploading it if it is decoded but not resident. Returns false if the tile is not available yet
+        static bool tiled_image_display_acquire_slot(TiledImageDisplayInternal* self, TiledImage& image, uint64_t level, uint64_t x, uint64_t y, uint64_t& n_uploads, uint64_t& out)
+        {
+            auto key = tiled_image_key(level, x, y);
+            auto it = self->key_to_slot->find(key);
+            if (it != self->key_to_slot->end())
+            {
+                self->slot_last_used->at(it->second) = self->frame;
+                image.get_tile(level, x, y);
+                out = it->second;
+                return true;
+            }
+
+            if (n_uploads >= tiled_image_display_max_n_uploads_per_update or self->atlas == nullptr)
+                return false;
+
+            auto* tile = image.get_tile(level, x, y);
+            if (tile == nullptr)
+                return false;
+
+            // least recently used slot that is not needed for the current frame
+            uint64_t slot = 0;
+            uint64_t oldest = std::numeric_limits<uint64_t>::max();
+            for (uint64_t i = 0; i < self->slot_keys->size(); ++i)
+            {
+                if (self->slot_keys->at(i) == tiled_image_display_no_key)
+                {
+                    slot = i;
+                    oldest = 0;
+                    break;
+                }
+
+                if (self->slot_last_used->at(i) < oldest)
+                {
+                    slot = i;
+                    oldest = self->slot_last_used->at(i);
+                }
+            }
+
+            if (oldest == self->frame)
+                return false;
+
+            if (self->slot_keys->at(slot) != tiled_image_display_no_key)
+                self->key_to_slot->erase(self->slot_keys->at(slot));
+
+            auto origin = tiled_image_display_slot_origin(self, slot);
+            self->atlas->set_region(origin.x, origin.y, *tile);
+            n_uploads += 1;
+
+            self->slot_keys->at(slot) = key;
+            self->slot_last_used->at(slot) = self->frame;
+            self->key_to_slot->insert({key, slot});
+            out = slot;
+            return true;
+        }
+    }
+
+    TiledImageDisplay::TiledImageDisplay()
+        : RenderArea()
+    {
+        if (detail::is_opengl_disabled())
+            return;
+
+        auto* native = GTK_GL_AREA(operator NativeWidget());
+        _display_internal = detail::tiled_image_display_internal_new(native);
+        detail::attach_ref_to(G_OBJECT(native), _display_internal);
+
+        add_render_task(*_display_internal->task);
+
+        _display_internal->drag = GTK_GESTURE_DRAG(gtk_gesture_drag_new());
+        _display_internal->scroll = GTK_EVENT_CONTROLLER_SCROLL(gtk_event_controller_scroll_new(GTK_EVENT_CONTROLLER_SCROLL_VERTICAL));
+        _display_internal->motion = GTK_EVENT_CONTROLLER_MOTION(gtk_event_controller_motion_new());
+
+        g_signal_connect(native, "resize", G_CALLBACK(on_resize), _display_internal);
+        g_signal_connect(_display_internal->drag, "drag-begin", G_CALLBACK(on_drag_begin), _display_internal);
+        g_signal_connect(_display_internal->drag, "drag-update", G_CALLBACK(on_drag_update), _display_internal);
+        g_signal_connect(_display_internal->scroll, "scroll", G_CALLBACK(on_scroll), _display_internal);
+        g_signal_connect(_display_internal->motion, "motion", G_CALLBACK(on_motion), _display_internal);
+
+        gtk_widget_add_controller(GTK_WIDGET(native), GTK_EVENT_CONTROLLER(_display_internal->drag));
+        gtk_widget_add_controller(GTK_WIDGET(native), GTK_EVENT_CONTROLLER(_display_internal->scroll));
+        gtk_widget_add_controller(GTK_WIDGET(native), GTK_EVENT_CONTROLLER(_display_internal->motion));
+    }
+
+    TiledImageDisplay::~TiledImageDisplay()
+    {}
+
+    void TiledImageDisplay::set_tiled_image(const TiledImage& image)
+    {
+        if (detail::is_opengl_disabled())
+            return;
+
+        auto* self = _display_internal;
+        if (self->image != nullptr)
+        {
+            detail::tiled_image_remove_listener(self->image, self);
+            g_object_unref(self->image);
+        }
+
+        self->image = (detail::TiledImageInternal*) image.operator GObject*();
+        g_object_ref(self->image);
+        self->image_generation = self->image->generation;
+
+        // tiles decode in the background, redraw as soon as one arrives
+        detail::tiled_image_add_listener(self->image, self, [self](uint64_t, uint64_t, uint64_t){
+            update(self);
+        });
+
+        detail::tiled_image_display_clear_slots(self);
+        fit_to_widget();
+    }
+
+    void TiledImageDisplay::set_view(Vector2f center, float zoom)
+    {
+        if (detail::is_opengl_disabled())
+            return;
+
+        if (not (zoom > 0))
+        {
+            log::critical("In TiledImageDisplay::set_view: zoom has to be larger than 0", MOUSETRAP_DOMAIN);
+            return;
+        }
+
+        _display_internal->center = center;
+        _display_internal->zoom = zoom;
+        update(_display_internal);
+    }
+
+    Vector2f TiledImageDisplay::get_view_center() const
+    {
+        if (detail::is_opengl_disabled())
+            return {0, 0};
+
+        return _display_internal->center;
+    }
+
+    float TiledImageDisplay::get_zoom() const
+    {
+        if (detail::is_opengl_disabled())
+            return 1;
+
+        return _display_internal->zoom;
+    }
+
+    void TiledImageDisplay::pan(Vector2f offset)
+    {
+        if (detail::is_opengl_disabled())
+            return;
+
+        set_view(_display_internal->center - offset / _display_internal->zoom, _display_internal->zoom);
+    }
+
+    void TiledImageDisplay::zoom(float factor, Vector2f anchor)
+    {
+        if (detail::is_opengl_disabled())
+            return;
+
+        auto* self = _display_internal;
+        Vector2f widget_center = {
+            gtk_widget_get_width(GTK_WIDGET(self->native)) * 0.5f,
+            gtk_widget_get_height(GTK_WIDGET(self->native)) * 0.5f
+        };
+
+        // image pixel below the anchor before and after zooming has to be the same
+        auto anchor_pixel = self->center + (anchor - widget_center) / self->zoom;
+        float zoom = self->zoom * factor;
+        set_view(anchor_pixel - (anchor - widget_center) / zoom, zoom);
+    }
+
+    void TiledImageDisplay::fit_to_widget()
+    {
+        if (detail::is_opengl_disabled())
+            return;
+
+        auto* self = _display_internal;
+        if (self->image == nullptr or self->image->width == 0 or self->image->height == 0)
+            return;
+
+        float width = std::max(1, gtk_widget_get_width(GTK_WIDGET(self->native)));
+        float height = std::max(1, gtk_widget_get_height(GTK_WIDGET(self->native)));
+        set_view(
+            {self->image->width * 0.5f, self->image->height * 0.5f},
+            std::min(width / self->image->width, height / self->image->height)
+        );
+    }
+
+    void TiledImageDisplay::update(detail::TiledImageDisplayInternal* self)
+    {
+        if (self->image == nullptr)
+            return;
+
+        float width = gtk_widget_get_width(GTK_WIDGET(self->native));
+        float height = gtk_widget_get_height(GTK_WIDGET(self->native));
+        if (width <= 0 or height <= 0)
+            return;
+
+        detail::make_opengl_context_current();
+
+        auto image = TiledImage(self->image);
+        if (self->image_generation != self->image->generation)
+        {
+            self->image_generation = self->image->generation;
+            detail::tiled_image_display_clear_slots(self);
+        }
+
+        self->frame += 1;
+
+        std::vector<Vertex> vertices;
+        if (image.get_n_levels() == 0)
+        {
+            self->shape->as_quads(vertices);
+            gtk_gl_area_queue_render(self->native);
+            return;
+        }
+
+        // level whose resolution is closest to the screen resolution
+        const int64_t n_levels = image.get_n_levels();
+        const uint64_t level = std::clamp<int64_t>(std::round(std::log2(1.f / self->zoom)), 0, n_levels - 1);
+        const float level_scale = float(uint64_t(1) << level);
+
+        // visible region, in pixels of the level
+        const Vector2f top_left = (self->center - Vector2f(width, height) * 0.5f / self->zoom) / level_scale;
+        const Vector2f bottom_right = (self->center + Vector2f(width, height) * 0.5f / self->zoom) / level_scale;
+
+        const auto n_tiles = image.get_n_tiles(level);
+        const float tile_size = TiledImage::tile_size;
+        const int64_t x_begin = std::max<int64_t>(0, std::floor(top_left.x / tile_size));
+        const int64_t y_begin = std::max<int64_t>(0, std::floor(top_left.y / tile_size));
+        const int64_t x_end = std::min<int64_t>(n_tiles.x, std::floor(bottom_right.x / tile_size) + 1);
+        const int64_t y_end = std::min<int64_t>(n_tiles.y, std::floor(bottom_right.y / tile_size) + 1);
+
+        // visible tiles plus as many again for coarser fallbacks and tiles that were just scrolled past
+        detail::tiled_image_display_reserve_slots(self, 2 * (x_end - x_begin) * (y_end - y_begin));
+
+        // requests are served most recent first, so the surrounding ring is requested before the visible tiles
+        image.clear_requests();
+        for (int64_t y = y_begin - 1; y <= y_end; ++y)
+            for (int64_t x = x_begin - 1; x <= x_end; ++x)
+                if ((x < x_begin or x >= x_end or y < y_begin or y >= y_end) and x >= 0 and y >= 0)
+                    image.request_tile(level, x, y);
+
+        auto to_gl = [&](Vector2f level_pixel) -> Vector2f {
+            auto widget = (level_pixel * level_scale - self->center) * self->zoom + Vector2f(width, height) * 0.5f;
+            return {widget.x / width * 2 - 1, 1 - widget.y / height * 2};
+        };
+
+        const float atlas_size = self->atlas_n_slots_per_row * TiledImage::tile_size;
+        uint64_t n_uploads = 0;
+
+        for (int64_t y = y_begin; y < y_end; ++y)
+        {
+            for (int64_t x = x_begin; x < x_end; ++x)
+            {
+                auto region = image.get_tile_region(level, x, y);
+
+                // fall back to the closest coarser level that is available, covering the same region with fewer pixels
+                uint64_t slot = 0;
+                uint64_t source_level = level;
+                bool found = false;
+                for (; source_level < uint64_t(n_levels); ++source_level)
+                {
+                    auto shift = source_level - level;
+                    if (detail::tiled_image_display_acquire_slot(self, image, source_level, x >> shift, y >> shift, n_uploads, slot))
+                    {
+                        found = true;
+                        break;
+                    }
+
+                    image.request_tile(source_level, x >> shift, y >> shift);
+                }
+
+                if (not found)
+                    continue;
+
+                auto shift = source_level - level;
+                auto source_region = image.get_tile_region(source_level, x >> shift, y >> shift);
+                auto slot_origin = detail::tiled_image_display_slot_origin(self, slot);
+
+                // texel coordinates inside the atlas, inset by half a texel so linear filtering does not bleed into neighboring slots
+                auto to_uv = [&](Vector2f level_pixel) -> Vector2f {
+                    auto texel = level_pixel / float(uint64_t(1) << shift) - source_region.top_left;
+                    texel.x = std::clamp(texel.x, 0.5f, source_region.size.x - 0.5f);
+                    texel.y = std::clamp(texel.y, 0.5f, source_region.size.y - 0.5f);
+                    return (texel + slot_origin) / atlas_size;
+                };
+
+                const Vector2f corners[4] = {
+                    region.top_left,
+                    {region.top_left.x + region.size.x, region.top_left.y},
+                    region.top_left + region.size,
+                    {region.top_left.x, region.top_left.y + region.size.y}
+                };
+
+                for (auto& corner : corners)
+                {
+                    auto position = to_gl(corner);
+                    auto vertex = Vertex(position.x, position.y, RGBA(1, 1, 1, 1));
+                    vertex.texture_coordinates = to_uv(corner);
+                    vertices.push_back(vertex);
+                }
+            }
+        }
+
+        self->shape->as_quads(vertices);
+        gtk_gl_area_queue_render(self->native);
+
+        // tiles that are already decoded do not notify a listener, so the remaining uploads have to be scheduled here
+        if (n_uploads >= detail::tiled_image_display_max_n_uploads_per_update and self->pending_update == 0)
+            self->pending_update = g_idle_add_full(G_PRIORITY_DEFAULT_IDLE, (GSourceFunc) on_pending_update, g_object_ref(self), g_object_unref);
+    }
+
+    gboolean TiledImageDisplay::on_pending_update(detail::TiledImageDisplayInternal* self)
+    {
+        self->pending_update = 0;
+        update(self);
+        return G_SOURCE_REMOVE;
+    }
+
+    void TiledImageDisplay::on_resize(GtkGLArea*, gint, gint, detail::TiledImageDisplayInternal* self)
+    {
+        update(self);
+    }
+
+    void TiledImageDisplay::on_drag_begin(GtkGestureDrag*, double, double, detail::TiledImageDisplayInternal* self)
+    {
+        self->drag_start_center = self->center;
+    }
+
+    void TiledImageDisplay::on_drag_update(GtkGestureDrag*, double x, double y, detail::TiledImageDisplayInternal* self)
+    {
+        self->center = self->drag_start_center - Vector2f(x, y) / self->zoom;
+        update(self);
+    }
+
+    gboolean TiledImageDisplay::on_scroll(GtkEventControllerScroll*, double, double dy, detail::TiledImageDisplayInternal* self)
+    {
+        Vector2f widget_center = {
+            gtk_widget_get_width(GTK_WIDGET(self->native)) * 0.5f,
+            gtk_widget_get_height(GTK_WIDGET(self->native)) * 0.5f
+        };
+
+        auto anchor = self->cursor_position;
+        auto anchor_pixel = self->center + (anchor - widget_center) / self->zoom;
+        self->zoom *= std::pow(1.1f, -float(dy));
+        self->center = anchor_pixel - (anchor - widget_center) / self->zoom;
+        update(self);
+        return TRUE;
+    }
+
+    void TiledImageDisplay::on_motion(GtkEventControllerMotion*, double x, double y, detail::TiledImageDisplayInternal* self)
+    {
+        self->cursor_position = {x, y};
+    }
+}
+
+#endif // MOUSETRAP_ENABLE_OPENGL_COMPONENT
@@ -341,6 +341,12 @@ namespace mousetrap
 
     void Widget::set_cursor_from_image(const Image& image, Vector2i offset)
     {
+        if (image.get_format() != ImageFormat::RGBA8)
+        {
+            set_cursor_from_image(image.as_format(ImageFormat::RGBA8), offset);
+            return;
+        }
+
         auto* texture = gdk_texture_new_for_pixbuf(image.operator GdkPixbuf *());
         auto* cursor = gdk_cursor_new_from_texture(texture, offset.x, offset.y, nullptr);
         gtk_widget_set_cursor(operator NativeWidget(), cursor);
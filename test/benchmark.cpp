@@ -0,0 +1,540 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/18/26
+//
+// micro benchmarks for the CPU-side hot paths of mousetrap, none of these require a display
+//
+
+#include <mousetrap.hpp>
+#include <mousetrap/thread_pool.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <iomanip>
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace mousetrap;
+
+// run `f` `n_repeats` times, return the fastest run in milliseconds
+template<typename Function_t>
+double benchmark(Function_t f, uint64_t n_repeats = 10)
+{
+    double best = std::numeric_limits<double>::max();
+    for (uint64_t i = 0; i < n_repeats; ++i)
+    {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    return best;
+}
+
+void report(const std::string& name, double baseline_ms, double optimized_ms)
+{
+    std::cout << std::left << std::setw(48) << name
+              << std::right << std::setw(10) << std::fixed << std::setprecision(3) << baseline_ms << " ms"
+              << std::setw(10) << optimized_ms << " ms"
+              << std::setw(8) << std::setprecision(2) << baseline_ms / optimized_ms << "x" << std::endl;
+}
+
+void report_throughput(const std::string& name, double n_megapixels, double ms)
+{
+    auto n_threads = detail::thread_pool_get_n_threads(detail::thread_pool_get_default());
+    auto megapixels_per_second = n_megapixels / (ms / 1000);
+    std::cout << std::left << std::setw(48) << name
+              << std::right << std::setw(10) << std::fixed << std::setprecision(1) << megapixels_per_second << " MP/s"
+              << std::setw(10) << megapixels_per_second / n_threads << " MP/s per core (" << n_threads << " threads)" << std::endl;
+}
+
+// optimized kernels are checked against their scalar baselines, any mismatch fails the run
+static bool all_checks_passed = true;
+
+void check(const std::string& name, double max_error, double tolerance)
+{
+    bool passed = max_error <= tolerance;
+    all_checks_passed = all_checks_passed and passed;
+    std::cout << std::left << std::setw(48) << ("  " + name)
+              << std::right << std::setw(13) << std::scientific << std::setprecision(2) << max_error
+              << (passed ? "  ok" : "  FAILED") << std::fixed << std::endl;
+}
+
+#if MOUSETRAP_ENABLE_OPENGL_COMPONENT
+void benchmark_transform_positions()
+{
+    constexpr uint64_t n_vertices = 1000000;
+
+    auto vertices = std::vector<Vertex>();
+    vertices.reserve(n_vertices);
+    for (uint64_t i = 0; i < n_vertices; ++i)
+        vertices.emplace_back(float(i % 1024) / 1024, float(i / 1024) / 1024, RGBA(1, 1, 1, 1));
+
+    auto data = std::vector<detail::VertexInfo>(n_vertices);
+
+    auto transform = GLTransform();
+    transform.rotate(degrees(1), {0.5, 0.5});
+
+    // compared once on the initial positions, the benchmarks below transform them in place
+    double max_error = 0;
+    detail::apply_transform_to_positions(
+        transform.transform,
+        &vertices.front().position.x, sizeof(Vertex),
+        data.front()._position, sizeof(detail::VertexInfo),
+        nullptr, 0,
+        n_vertices
+    );
+    for (uint64_t i = 0; i < n_vertices; ++i)
+    {
+        auto expected = transform.apply_to(vertices[i].position);
+        for (uint64_t c = 0; c < 3; ++c)
+            max_error = std::max<double>(max_error, std::abs(data[i]._position[c] - expected[c]));
+    }
+
+    auto scalar = benchmark([&](){
+        for (uint64_t i = 0; i < n_vertices; ++i)
+        {
+            auto& v = vertices[i];
+            v.position = transform.apply_to(v.position);
+            data[i]._position[0] = v.position.x;
+            data[i]._position[1] = v.position.y;
+            data[i]._position[2] = v.position.z;
+        }
+    });
+
+    auto vectorized = benchmark([&](){
+        detail::apply_transform_to_positions(
+            transform.transform,
+            &vertices.front().position.x, sizeof(Vertex),
+            &vertices.front().position.x, sizeof(Vertex),
+            data.front()._position, sizeof(detail::VertexInfo),
+            n_vertices
+        );
+    });
+
+    report("transform 1M vertices", scalar, vectorized);
+    check("vectorized vs scalar positions", max_error, 1e-5);
+}
+#endif
+
+void benchmark_image_transforms()
+{
+    // 8K UHD
+    constexpr uint64_t width = 7680;
+    constexpr uint64_t height = 4320;
+
+    auto image = Image(width, height, RGBA(0.25, 0.5, 0.75, 1));
+
+    // baselines are the previous per-pixel implementations, run once since they are slow
+    auto fill_baseline = benchmark([&](){
+        for (uint64_t x = 0; x < width; ++x)
+            for (uint64_t y = 0; y < height; ++y)
+                image.set_pixel(x, y, RGBA(1, 0, 1, 1));
+    }, 1);
+    auto fill_optimized = benchmark([&](){
+        image.fill(RGBA(1, 0, 1, 1));
+    });
+    report("fill 8K image", fill_baseline, fill_optimized);
+
+    auto crop_baseline = benchmark([&](){
+        auto out = Image(width / 2, height / 2);
+        for (uint64_t y = 0; y < height / 2; ++y)
+            for (uint64_t x = 0; x < width / 2; ++x)
+                out.set_pixel(x, y, image.get_pixel(x + width / 4, y + height / 4));
+    }, 1);
+    auto crop_optimized = benchmark([&](){
+        auto out = image.as_cropped(-int(width / 4), -int(height / 4), width / 2, height / 2);
+    });
+    report("crop 8K image to 4K", crop_baseline, crop_optimized);
+
+    auto flip_baseline = benchmark([&](){
+        auto out = Image(width, height);
+        for (uint64_t x = 0; x < width; ++x)
+            for (uint64_t y = 0; y < height; ++y)
+                out.set_pixel(width - x - 1, height - y - 1, image.get_pixel(x, y));
+    }, 1);
+    auto flip_optimized = benchmark([&](){
+        auto out = image.as_flipped(true, true);
+    });
+    report("flip 8K image along both axes", flip_baseline, flip_optimized);
+
+    // every pixel distinct, such that a wrongly transposed block is detected
+    image.for_each_pixel_parallel([](RGBA& pixel, uint64_t x, uint64_t y){
+        pixel = RGBA(float(x % 256) / 255, float(y % 256) / 255, float((x / 256 + y / 256) % 256) / 255, 1);
+    });
+
+    auto rotated_baseline = Image();
+    auto rotate_baseline = benchmark([&](){
+        auto out = Image(height, width);
+        for (uint64_t y = 0; y < height; ++y)
+            for (uint64_t x = 0; x < width; ++x)
+                out.set_pixel(height - 1 - y, x, image.get_pixel(x, y));
+        rotated_baseline = out;
+    }, 1);
+    auto rotated_optimized = Image();
+    auto rotate_optimized = benchmark([&](){
+        rotated_optimized = image.as_rotated_90();
+    });
+    report("rotate 8K image by 90 degrees", rotate_baseline, rotate_optimized);
+
+    uint64_t n_mismatched_rows = 0;
+    for (uint64_t y = 0; y < width; ++y)
+    {
+        auto* expected = static_cast<const uint8_t*>(rotated_baseline.data()) + y * rotated_baseline.get_rowstride();
+        auto* actual = static_cast<const uint8_t*>(rotated_optimized.data()) + y * rotated_optimized.get_rowstride();
+        n_mismatched_rows += std::memcmp(expected, actual, height * 4) != 0;
+    }
+    check("transposed vs per-pixel rotation, rows", n_mismatched_rows, 0);
+}
+
+// filters of Image::as_scaled, evaluated directly in two dimensions in double precision
+static double reference_filter(InterpolationType type, double x)
+{
+    x = std::abs(x);
+    if (type == InterpolationType::LANCZOS)
+    {
+        if (x < 1e-8)
+            return 1;
+
+        if (x >= 3)
+            return 0;
+
+        const double pi_x = 3.14159265358979323846 * x;
+        return 3 * std::sin(pi_x) * std::sin(pi_x / 3) / (pi_x * pi_x);
+    }
+    else if (type == InterpolationType::BICUBIC)
+    {
+        constexpr double a = -0.5;
+        if (x < 1)
+            return ((a + 2) * x - (a + 3)) * x * x + 1;
+        else if (x < 2)
+            return ((a * x - 5 * a) * x + 8 * a) * x - 4 * a;
+        else
+            return 0;
+    }
+    else
+        return x <= 0.5 ? 1 : 0;
+}
+
+// normalized weights of the input pixels [first[i], first[i] + weights[i].size()) contributing to output pixel i
+static void reference_weights(uint64_t in_size, uint64_t out_size, InterpolationType type, std::vector<int64_t>& first, std::vector<std::vector<double>>& weights)
+{
+    const double scale = double(in_size) / double(out_size);
+    const double filter_scale = std::max(scale, 1.0);
+    const double support = (type == InterpolationType::LANCZOS ? 3 : type == InterpolationType::BICUBIC ? 2 : 0.5) * filter_scale;
+    const int64_t max_n = int64_t(std::ceil(support)) * 2 + 1;
+
+    first.resize(out_size);
+    weights.resize(out_size);
+    for (uint64_t i = 0; i < out_size; ++i)
+    {
+        const double center = (i + 0.5) * scale;
+        int64_t begin = std::max<int64_t>(0, int64_t(center - support + 0.5));
+        int64_t end = std::min<int64_t>(std::min<int64_t>(in_size, int64_t(center + support + 0.5)), begin + max_n);
+
+        double sum = 0;
+        weights[i].clear();
+        for (int64_t j = begin; j < end; ++j)
+        {
+            weights[i].push_back(reference_filter(type, (j - center + 0.5) / filter_scale));
+            sum += weights[i].back();
+        }
+
+        if (sum != 0)
+            for (auto& weight : weights[i])
+                weight /= sum;
+
+        first[i] = begin;
+    }
+}
+
+// largest difference of any channel between Image::as_scaled and the reference, in premultiplied alpha like as_scaled
+static double resampling_max_error(const Image& image, uint64_t out_width, uint64_t out_height, InterpolationType type)
+{
+    const uint64_t in_width = image.get_size().x;
+    const uint64_t in_height = image.get_size().y;
+
+    auto in = std::vector<RGBA>(in_width * in_height);
+    for (uint64_t y = 0; y < in_height; ++y)
+        for (uint64_t x = 0; x < in_width; ++x)
+            in[y * in_width + x] = image.get_pixel(x, y);
+
+    std::vector<int64_t> first_x, first_y;
+    std::vector<std::vector<double>> weights_x, weights_y;
+    reference_weights(in_width, out_width, type, first_x, weights_x);
+    reference_weights(in_height, out_height, type, first_y, weights_y);
+
+    auto out = image.as_scaled(out_width, out_height, type);
+
+    double max_error = 0;
+    for (uint64_t y = 0; y < out_height; ++y)
+    {
+        for (uint64_t x = 0; x < out_width; ++x)
+        {
+            double sum[4] = {0, 0, 0, 0};
+            for (uint64_t j = 0; j < weights_y[y].size(); ++j)
+            {
+                for (uint64_t i = 0; i < weights_x[x].size(); ++i)
+                {
+                    const auto& pixel = in[(first_y[y] + j) * in_width + (first_x[x] + i)];
+                    const double weight = weights_y[y][j] * weights_x[x][i];
+                    sum[0] += weight * pixel.r * pixel.a;
+                    sum[1] += weight * pixel.g * pixel.a;
+                    sum[2] += weight * pixel.b * pixel.a;
+                    sum[3] += weight * pixel.a;
+                }
+            }
+
+            const double factor = sum[3] > 1.0 / 512.0 ? 1.0 / sum[3] : 0;
+            const double expected[4] = {
+                std::clamp(sum[0] * factor, 0.0, 1.0),
+                std::clamp(sum[1] * factor, 0.0, 1.0),
+                std::clamp(sum[2] * factor, 0.0, 1.0),
+                std::clamp(sum[3], 0.0, 1.0)
+            };
+
+            const auto actual = out.get_pixel(x, y);
+            const double actual_values[4] = {actual.r, actual.g, actual.b, actual.a};
+            for (uint64_t c = 0; c < 4; ++c)
+                max_error = std::max(max_error, std::abs(actual_values[c] - expected[c]));
+        }
+    }
+
+    return max_error;
+}
+
+void benchmark_image_resampling()
+{
+    // typical 24 megapixel camera image, thumbnailed to 300x200
+    constexpr uint64_t width = 6000;
+    constexpr uint64_t height = 4000;
+    constexpr double n_megapixels = width * height / 1e6;
+
+    auto image = Image(width, height);
+    image.for_each_pixel_parallel([](RGBA& pixel, uint64_t x, uint64_t y){
+        pixel = RGBA(float(x % 256) / 255, float(y % 256) / 255, 0.5, 1);
+    });
+
+    auto hyperbolic = benchmark([&](){
+        auto out = image.as_scaled(300, 200, InterpolationType::HYPERBOLIC);
+    }, 3);
+    auto lanczos = benchmark([&](){
+        auto out = image.as_scaled(300, 200, InterpolationType::LANCZOS);
+    }, 3);
+    report("thumbnail 24MP, gdk hyperbolic vs lanczos", hyperbolic, lanczos);
+    report_throughput("thumbnail 24MP, lanczos", n_megapixels, lanczos);
+
+    auto bicubic = benchmark([&](){
+        auto out = image.as_scaled(300, 200, InterpolationType::BICUBIC);
+    }, 3);
+    report_throughput("thumbnail 24MP, bicubic", n_megapixels, bicubic);
+
+    auto tiles = benchmark([&](){
+        auto out = image.as_scaled(300, 200, InterpolationType::TILES);
+    }, 3);
+    auto box = benchmark([&](){
+        auto out = image.as_scaled(300, 200, InterpolationType::BOX);
+    }, 3);
+    report("thumbnail 24MP, gdk tiles vs integer box", tiles, box);
+    report_throughput("thumbnail 24MP, integer box", n_megapixels, box);
+
+    auto bilinear_three_quarters = benchmark([&](){
+        auto out = image.as_scaled(width / 4 * 3, height / 4 * 3, InterpolationType::BILINEAR);
+    }, 3);
+    auto lanczos_three_quarters = benchmark([&](){
+        auto out = image.as_scaled(width / 4 * 3, height / 4 * 3, InterpolationType::LANCZOS);
+    }, 3);
+    report("scale 24MP by 0.75, gdk bilinear vs lanczos", bilinear_three_quarters, lanczos_three_quarters);
+    report_throughput("scale 24MP by 0.75, lanczos", n_megapixels, lanczos_three_quarters);
+
+    // small image with varying alpha, such that premultiplication is covered as well. One step of an 8-bit channel is tolerated for rounding
+    auto small = Image(640, 480);
+    small.for_each_pixel_parallel([](RGBA& pixel, uint64_t x, uint64_t y){
+        pixel = RGBA(float(x % 256) / 255, float(y % 256) / 255, float((x * y) % 256) / 255, (x + y) % 2 == 0 ? 1 : 0.5);
+    });
+
+    constexpr double tolerance = 1.5 / 255;
+    check("lanczos 640x480 to 160x120 vs reference", resampling_max_error(small, 160, 120, InterpolationType::LANCZOS), tolerance);
+    check("lanczos 640x480 to 480x360 vs reference", resampling_max_error(small, 480, 360, InterpolationType::LANCZOS), tolerance);
+    check("lanczos 640x480 to 960x720 vs reference", resampling_max_error(small, 960, 720, InterpolationType::LANCZOS), tolerance);
+    check("bicubic 640x480 to 160x120 vs reference", resampling_max_error(small, 160, 120, InterpolationType::BICUBIC), tolerance);
+    check("integer box 640x480 to 160x120 vs reference", resampling_max_error(small, 160, 120, InterpolationType::BOX), tolerance);
+}
+
+// cairo argb32 as handed out by the clipboard, converted to straight-alpha rgba
+void benchmark_unpremultiply()
+{
+    // not a multiple of 4, such that the scalar tail of the vectorized kernel runs as well
+    constexpr uint64_t n_pixels = 8 * 1024 * 1024 + 3;
+
+    auto in = std::vector<uint8_t>(n_pixels * 4);
+    for (uint64_t i = 0; i < n_pixels; ++i)
+    {
+        const uint32_t alpha = (i * 37) % 256;
+        const uint32_t r = std::min<uint32_t>(alpha, (i * 11) % 256);
+        const uint32_t g = std::min<uint32_t>(alpha, (i * 101) % 256);
+        const uint32_t b = std::min<uint32_t>(alpha, (i / 7) % 256);
+
+        // native-endian 32-bit word, alpha in the highest byte
+        const uint32_t pixel = (alpha << 24) | (r << 16) | (g << 8) | b;
+        std::memcpy(in.data() + 4 * i, &pixel, sizeof(uint32_t));
+    }
+
+    auto expected = std::vector<uint8_t>(n_pixels * 4);
+    auto baseline = benchmark([&](){
+        for (uint64_t i = 0; i < n_pixels; ++i)
+        {
+            uint32_t pixel;
+            std::memcpy(&pixel, in.data() + 4 * i, sizeof(uint32_t));
+
+            const uint8_t alpha = pixel >> 24;
+            const float scale = alpha == 0 ? 0.f : 255.f / float(alpha);
+            for (uint64_t c = 0; c < 3; ++c)
+                expected[4 * i + c] = std::min<long>(255, std::lrint(float((pixel >> (16 - 8 * c)) & 0xFF) * scale));
+
+            expected[4 * i + 3] = alpha;
+        }
+    }, 3);
+
+    auto actual = std::vector<uint8_t>(n_pixels * 4);
+    auto optimized = benchmark([&](){
+        detail::convert_row_from_argb32_premultiplied(in.data(), actual.data(), n_pixels);
+    }, 3);
+    report("unpremultiply argb32, 8M pixels", baseline, optimized);
+
+    double max_error = 0;
+    for (uint64_t i = 0; i < n_pixels * 4; ++i)
+        max_error = std::max<double>(max_error, std::abs(int(actual[i]) - int(expected[i])));
+
+    check("vectorized vs scalar unpremultiply", max_error, 0);
+}
+
+void benchmark_color_conversion()
+{
+    constexpr uint64_t n_colors = 8 * 1024 * 1024;
+
+    auto rgba = std::vector<RGBA>(n_colors);
+    for (uint64_t i = 0; i < n_colors; ++i)
+        rgba[i] = RGBA(float(i % 256) / 255, float((i / 256) % 256) / 255, float((i / 65536) % 128) / 127, 1);
+
+    // hue is circular, 0 and 1 are the same hue
+    auto hsva_error = [](const HSVA& a, const HSVA& b) -> double {
+        double hue = std::abs(a.h - b.h);
+        return std::max<double>({std::min(hue, 1 - hue), std::abs(a.s - b.s), std::abs(a.v - b.v), std::abs(a.a - b.a)});
+    };
+
+    auto rgba_error = [](const RGBA& a, const RGBA& b) -> double {
+        return std::max({std::abs(a.r - b.r), std::abs(a.g - b.g), std::abs(a.b - b.b), std::abs(a.a - b.a)});
+    };
+
+    auto hsva_expected = std::vector<HSVA>(n_colors);
+    auto to_hsva_baseline = benchmark([&](){
+        for (uint64_t i = 0; i < n_colors; ++i)
+            hsva_expected[i] = rgba_to_hsva(rgba[i]);
+    }, 3);
+    auto hsva = std::vector<HSVA>(n_colors);
+    auto to_hsva_optimized = benchmark([&](){
+        rgba_to_hsva(rgba.data(), hsva.data(), n_colors);
+    });
+    report("rgba to hsva, 8M colors", to_hsva_baseline, to_hsva_optimized);
+
+    double max_error = 0;
+    for (uint64_t i = 0; i < n_colors; ++i)
+        max_error = std::max(max_error, hsva_error(hsva[i], hsva_expected[i]));
+
+    check("vectorized vs scalar rgba to hsva", max_error, 1e-5);
+
+    auto rgba_expected = std::vector<RGBA>(n_colors);
+    auto to_rgba_baseline = benchmark([&](){
+        for (uint64_t i = 0; i < n_colors; ++i)
+            rgba_expected[i] = hsva_to_rgba(hsva[i]);
+    }, 3);
+    auto rgba_round_trip = std::vector<RGBA>(n_colors);
+    auto to_rgba_optimized = benchmark([&](){
+        hsva_to_rgba(hsva.data(), rgba_round_trip.data(), n_colors);
+    });
+    report("hsva to rgba, 8M colors", to_rgba_baseline, to_rgba_optimized);
+
+    max_error = 0;
+    for (uint64_t i = 0; i < n_colors; ++i)
+        max_error = std::max(max_error, rgba_error(rgba_round_trip[i], rgba_expected[i]));
+
+    check("vectorized vs scalar hsva to rgba", max_error, 1e-5);
+
+    // the round trip has to reproduce the input
+    max_error = 0;
+    for (uint64_t i = 0; i < n_colors; ++i)
+        max_error = std::max(max_error, rgba_error(rgba_round_trip[i], rgba[i]));
+
+    check("rgba to hsva to rgba round trip", max_error, 1e-5);
+
+    auto quantized = std::vector<RGBA>(n_colors);
+    auto quantize_baseline = benchmark([&](){
+        for (uint64_t i = 0; i < n_colors; ++i)
+            quantized[i] = quantize(rgba[i], 8);
+    }, 3);
+    auto quantize_optimized = benchmark([&](){
+        quantize(rgba.data(), quantized.data(), n_colors, 8);
+    });
+    report("quantize, 8M colors", quantize_baseline, quantize_optimized);
+}
+
+// dispatch as it was before handlers were cached: a temporary wrapper per emission, handler stored in a std::function
+static void on_value_changed_baseline(GtkAdjustment* native, std::function<void(Adjustment&)>* f)
+{
+    auto temp = Adjustment(native);
+    (*f)(temp);
+}
+
+void benchmark_signal_emission()
+{
+    constexpr uint64_t n_emissions = 1000000;
+    uint64_t n_calls = 0;
+
+    auto baseline_adjustment = Adjustment(0, 0, 1, 0.1);
+    auto baseline_handler = std::function<void(Adjustment&)>([&](Adjustment&){
+        n_calls += 1;
+    });
+    g_signal_connect(baseline_adjustment.operator GObject*(), "value-changed", G_CALLBACK(on_value_changed_baseline), &baseline_handler);
+
+    auto baseline = benchmark([&](){
+        for (uint64_t i = 0; i < n_emissions; ++i)
+            g_signal_emit_by_name(baseline_adjustment.operator GObject*(), "value-changed");
+    }, 3);
+
+    auto adjustment = Adjustment(0, 0, 1, 0.1);
+    adjustment.connect_signal_value_changed([&](Adjustment&){
+        n_calls += 1;
+    });
+
+    auto optimized = benchmark([&](){
+        for (uint64_t i = 0; i < n_emissions; ++i)
+            adjustment.emit_signal_value_changed();
+    }, 3);
+
+    report("emit signal, 1M emissions", baseline, optimized);
+    std::cout << std::left << std::setw(48) << "  emissions per second"
+              << std::right << std::setw(10) << std::fixed << std::setprecision(1) << n_emissions / (baseline / 1000) / 1e6 << " M/s"
+              << std::setw(10) << n_emissions / (optimized / 1000) / 1e6 << " M/s" << std::endl;
+}
+
+int main()
+{
+    std::cout << std::left << std::setw(48) << "benchmark" << std::right << std::setw(13) << "baseline" << std::setw(13) << "optimized" << std::setw(9) << "speedup" << std::endl;
+
+    #if MOUSETRAP_ENABLE_OPENGL_COMPONENT
+    benchmark_transform_positions();
+    #endif
+
+    benchmark_image_transforms();
+    benchmark_image_resampling();
+    benchmark_unpremultiply();
+    benchmark_color_conversion();
+    benchmark_signal_emission();
+
+    return all_checks_passed ? 0 : 1;
+}
@@ -0,0 +1,73 @@
+//
+// Copyright (c) Clemens Cords (mail@clemens-cords.com), created 10/18/26
+//
+
+// renders into a RenderTexture without a display and checks the downloaded pixels, exits with 77 (skipped) if no EGL device is available
+
+#include <mousetrap.hpp>
+
+#include <iostream>
+#include <cmath>
+
+using namespace mousetrap;
+
+static constexpr int SKIPPED = 77;
+
+int main()
+{
+    #if MOUSETRAP_ENABLE_OPENGL_COMPONENT and MOUSETRAP_ENABLE_HEADLESS_COMPONENT
+
+    if (not detail::initialize_opengl_headless())
+    {
+        std::cout << "[SKIPPED] unable to create a surfaceless EGL context" << std::endl;
+        return SKIPPED;
+    }
+
+    constexpr uint64_t width = 64;
+    constexpr uint64_t height = 32;
+
+    auto target = RenderTexture();
+    target.create(width, height);
+
+    // covers the left half of the target
+    auto shape = Shape::Rectangle({-1, 1}, {1, 2});
+    shape.set_color(RGBA(1, 0, 0, 1));
+    auto task = RenderTask(shape);
+
+    target.bind_as_render_target();
+    glClearColor(0, 0, 1, 1);
+    glClear(GL_COLOR_BUFFER_BIT);
+    task.render();
+    glFlush();
+    target.unbind_as_render_target();
+
+    auto image = target.download();
+    if (image.get_size().x != width or image.get_size().y != height)
+    {
+        std::cerr << "[FAILED] downloaded image is " << image.get_size().x << "x" << image.get_size().y << ", expected " << width << "x" << height << std::endl;
+        return 1;
+    }
+
+    auto equals = [](RGBA a, RGBA b) {
+        constexpr float eps = 1.f / 255;
+        return std::abs(a.r - b.r) <= eps and std::abs(a.g - b.g) <= eps and std::abs(a.b - b.b) <= eps and std::abs(a.a - b.a) <= eps;
+    };
+
+    auto inside = image.get_pixel(width / 4, height / 2);
+    auto outside = image.get_pixel(3 * width / 4, height / 2);
+    if (not equals(inside, RGBA(1, 0, 0, 1)) or not equals(outside, RGBA(0, 0, 1, 1)))
+    {
+        std::cerr << "[FAILED] unexpected pixels: "
+                  << "inside (" << inside.r << ", " << inside.g << ", " << inside.b << ", " << inside.a << "), "
+                  << "outside (" << outside.r << ", " << outside.g << ", " << outside.b << ", " << outside.a << ")" << std::endl;
+        return 1;
+    }
+
+    std::cout << "[OK] rendered and downloaded " << width << "x" << height << " without a display" << std::endl;
+    return 0;
+
+    #else
+        std::cout << "[SKIPPED] mousetrap was built without EGL" << std::endl;
+        return SKIPPED;
+    #endif
+}
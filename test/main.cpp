@@ -64,10 +64,9 @@ int main()
         static auto animation = Animation(area, seconds(3));
         animation.set_repeat_count(0);
         animation.on_tick([](Animation&, double value){
-            static auto current = 0;
-            shape.rotate(degrees(-1 * current), shape.get_centroid());
-            shape.rotate(degrees(value * 360), shape.get_centroid());
-            current = value * 360;
+            auto transform = GLTransform();
+            transform.rotate(degrees(value * 360), shape.get_centroid());
+            shape.set_model_transform(transform);
             area.queue_render();
         });
 